@@ -47,9 +47,12 @@
 
 #include <mars/utils/MutexLocker.h>
 #include <mars/utils/misc.h>
+#include <mars/utils/Trace.h>
 
 #include <cstdio>
 #include <cerrno>
+#include <ctime>
+#include <algorithm>
 
 
 
@@ -61,13 +64,157 @@ namespace mars {
     // Helper struct
     /// \cond HIDDEN_SYMBOLS
     struct DeferredCallback {
-      std::list<Receiver> receivers;
-      DataInfo info;
+      ReceiverListPtr receivers;
       DataPackage package;
-      const ReceiverInterface *producer;
+      bool timed; ///< measure the callbacks for the statistics
+      DataElement *element;
+      bool hasPackage; ///< package holds a copy of the front buffer
+    };
+
+    // decimated async update that waits for the period of its receiver
+    struct DecimatedUpdate {
+      DataElement *element;
+      Receiver receiver;
+    };
+
+    // Runs the due producers of one timer step. Each task is one element
+    // with all of its due producers in registration order.
+    class ProduceJob : public WorkerJob {
+    public:
+      DataBroker *dataBroker;
+      std::vector<TimedProducer> *producers;
+      std::vector<DeferredCallback> *results;
+      std::vector<std::vector<size_t> > groups;
+
+      void runTask(size_t index) {
+        std::vector<size_t>::const_iterator it;
+        for(it = groups[index].begin(); it != groups[index].end(); ++it) {
+          dataBroker->callProducer((*producers)[*it], &(*results)[*it]);
+        }
+      }
     };
     /// \endcond
 
+    // a timer step and an update period of one are one million
+    // nanoseconds, i.e. a millisecond for the MARS timers
+    static const int64_t TIMER_STEP_NS = 1000000;
+
+    // Orders the timer heaps so that the entry with the smallest
+    // nextTriggerTime is on top.
+    struct LaterTrigger {
+      template<typename T>
+      bool operator()(const T &a, const T &b) const {
+        return a.nextTriggerTime > b.nextTriggerTime;
+      }
+    };
+
+    struct EarlierSequence {
+      template<typename T>
+      bool operator()(const T &a, const T &b) const {
+        return a.sequence < b.sequence;
+      }
+    };
+
+    // Moves all entries that are due at time from the heap into due
+    // sorted by their registration order.
+    template<typename T>
+    static void takeDue(std::vector<T> *heap, int64_t time, std::vector<T> *due) {
+      while(!heap->empty() && heap->front().nextTriggerTime <= time) {
+        std::pop_heap(heap->begin(), heap->end(), LaterTrigger());
+        due->push_back(heap->back());
+        heap->pop_back();
+      }
+      std::sort(due->begin(), due->end(), EarlierSequence());
+    }
+
+    // Schedules the next trigger time of the due entries and puts them
+    // back into the heap.
+    template<typename T>
+    static void putBackDue(std::vector<T> *due, int64_t time, std::vector<T> *heap) {
+      typename std::vector<T>::iterator it;
+      for(it = due->begin(); it != due->end(); ++it) {
+        int64_t period = (int64_t)it->updatePeriod * TIMER_STEP_NS;
+        while(period > 0 && it->nextTriggerTime <= time) {
+          it->nextTriggerTime += period;
+        }
+        heap->push_back(*it);
+        std::push_heap(heap->begin(), heap->end(), LaterTrigger());
+      }
+    }
+
+    // maximal number of packages queued for an every sample receiver
+    static const size_t ASYNC_QUEUE_LIMIT = 1024;
+
+    static AsyncMailboxPtr createMailbox(AsyncReceiverMode mode,
+                                         double frequency) {
+      AsyncMailboxPtr mailbox(new AsyncMailbox);
+      mailbox->mode = mode;
+      if(mode == ASYNC_DECIMATE && frequency > 0.) {
+        mailbox->period = (long long)(1000000. / frequency);
+      }
+      return mailbox;
+    }
+
+    // whether anything reads the pushes of the element
+    static bool hasConsumers(const DataElement *element) {
+      return (element->numSyncReceivers.load() ||
+              element->numAsyncReceivers.load() ||
+              element->numConnections.load() ||
+              element->numTimedReceivers.load() ||
+              element->numTriggeredReceivers.load());
+    }
+
+    // counts the every sample receivers of an async receiver list
+    static int countSampleQueues(const ReceiverList &receivers) {
+      int count = 0;
+      ReceiverList::const_iterator it;
+      for(it = receivers.begin(); it != receivers.end(); ++it) {
+        if(it->mailbox && it->mailbox->mode == ASYNC_EVERY_SAMPLE) ++count;
+      }
+      return count;
+    }
+
+    // true if a sync receiver of the list needs its own copy of the package
+    static bool needsCopy(const ReceiverListPtr &receivers) {
+      if(!receivers) return false;
+      ReceiverList::const_iterator it;
+      for(it = receivers->begin(); it != receivers->end(); ++it) {
+        if(!it->readFrontBuffer) return true;
+      }
+      return false;
+    }
+
+    // rough number of bytes copied when the package is copied
+    static unsigned long long estimatePackageSize(const DataPackage &package) {
+      unsigned long long bytes = 0;
+      for(size_t i = 0; i < package.size(); ++i) {
+        bytes += sizeof(DataItem);
+        if(package[i].type == STRING_TYPE) {
+          bytes += package[i].s.size();
+        }
+      }
+      return bytes;
+    }
+
+    // value below which the given fraction of the histogram samples lies
+    // in microseconds, interpolated linearly within the bucket
+    static double getPercentile(const CallbackHistogram &histogram,
+                                double fraction) {
+      double rank = fraction * histogram.samples;
+      double count = 0.;
+      for(int i = 0; i < CallbackHistogram::NUM_BUCKETS; ++i) {
+        if(histogram.buckets[i] == 0) continue;
+        if(count + histogram.buckets[i] >= rank) {
+          double low = (i == 0) ? 0. : (double)(1LL << i);
+          double high = (double)(1LL << (i+1));
+          double t = low + (high-low)*(rank-count)/histogram.buckets[i];
+          return std::min(t, (double)histogram.maxTime)*0.001;
+        }
+        count += histogram.buckets[i];
+      }
+      return histogram.maxTime*0.001;
+    }
+
 
     // C-function to be called by pthreads to start the thread
     static void* createDataBrokerThread(void *theObject) {
@@ -92,11 +239,19 @@ namespace mars {
     DataBroker::DataBroker(lib_manager::LibManager *theManager) :
       DataBrokerInterface(theManager),
       mars::utils::Thread(),
+      updatedElements(NULL), threadSleeping(false), asyncThreadStarted(false),
+      asyncInterval(10000),
+      statsStartTime(0), statsPasses(0), statsCallbacks(0),
+      statsMaxQueueDepth(0), statsLatencySum(0.), statsMaxLatency(0.),
+      statisticsEnabled(false), statisticsInterval(16),
+      statisticsPublishTime(0),
       next_id(1), thread_running(false), stop_thread(false),
-      realtimeThreadRunning(false), startingRealtimeThread(false) {
+      realtimeThreadRunning(false), startingRealtimeThread(false),
+      producerPool(NULL) {
 
-      updatedElementsBackBuffer = new std::set<DataElement*>;
-      updatedElementsFrontBuffer = new std::set<DataElement*>;
+      for(unsigned long i = 0; i < ELEMENT_MAX_CHUNKS; ++i) {
+        elementChunks[i].store(NULL);
+      }
 
       DataElement *e;
       e = createDataElement("data_broker", "newStream", DATA_PACKAGE_READ_FLAG);
@@ -129,55 +284,72 @@ namespace mars {
       publishDataElement(debugElement);
       elementsLock.unlock();
 
-      createTimer("_REALTIME_");
+      DataElement *statsElement;
+      statsElement = createDataElement("data_broker", "asyncStats",
+                                       DATA_PACKAGE_READ_FLAG);
+      asyncStatsId = statsElement->info.dataId;
+      elementsLock.lockForWrite();
+      publishDataElement(statsElement);
+      elementsLock.unlock();
 
-      //pthread_create(&theThread, NULL, createDataBrokerThread, (void*)this);
-      //start();
+      statsElement = createDataElement("data_broker", "stats",
+                                       DATA_PACKAGE_READ_FLAG);
+      statisticsId = statsElement->info.dataId;
+      elementsLock.lockForWrite();
+      publishDataElement(statsElement);
+      elementsLock.unlock();
+
+      realtimeTimer = createTimer("_REALTIME_");
+
+      // the async thread is started with the first async receiver
+      // see startAsyncThread()
     }
 
     DataBroker::~DataBroker() {
       stopRealtimeThread = true;
+      wakeupMutex.lock();
       stop_thread = true;
-      if(wakeupMutex.tryLock() == MUTEX_ERROR_NO_ERROR) {
-        wakeupCondition.wakeOne();
-        wakeupMutex.unlock();
+      wakeupCondition.wakeAll();
+      wakeupMutex.unlock();
+      if(asyncThreadStarted) {
+        pthread_join(theThread, NULL);
       }
-      while(thread_running || realtimeThreadRunning) {
+      producerPoolLock.lockForWrite();
+      delete producerPool;
+      producerPool = NULL;
+      producerPoolLock.unlock();
+      while(realtimeThreadRunning) {
         msleep(10);
       }
-      std::map<unsigned long, DataElement*>::iterator elementIt;
       std::map<std::string, Timer>::iterator timerIt;
       std::map<std::string, Trigger>::iterator triggerIt;
       // TODO: This cleanup code is not really perfect threadingwise
       elementsLock.lockForWrite();
       timersLock.lockForWrite();
       triggersLock.lockForWrite();
-      updatedElementsLock.lock();
-      updatedElementsBackBuffer->clear();
-      updatedElementsFrontBuffer->clear();
-      delete updatedElementsBackBuffer;
-      delete updatedElementsFrontBuffer;
+      updatedElements.store(NULL);
       for(timerIt = timers.begin(); timerIt != timers.end(); ++timerIt) {
-        //destroyLock(&timerIt->second.lock);
+        delete timerIt->second.lock;
       }
       timers.clear();
       for(triggerIt = triggers.begin();
           triggerIt != triggers.end(); ++triggerIt) {
-        //destroyLock(&triggerIt->second.lock);
+        delete triggerIt->second.lock;
       }
       triggers.clear();
-      for(elementIt = elementsById.begin();
-          elementIt != elementsById.end(); ++elementIt) {
-        DataElement *element = elementIt->second;
-        //destroyLock(&element->receiverLock);
-        //destroyLock(&element->bufferLock);
+      for(unsigned long id = 1; id < next_id; ++id) {
+        DataElement *element = getElementById(id);
+        if(!element) continue;
+        delete element->receiverLock;
+        delete element->bufferLock;
         delete element->backBuffer;
         delete element->frontBuffer;
         delete element;
       }
-      elementsById.clear();
+      for(unsigned long i = 0; i < ELEMENT_MAX_CHUNKS; ++i) {
+        delete[] elementChunks[i].exchange(NULL);
+      }
       elementsByName.clear();
-      updatedElementsLock.unlock();
       triggersLock.unlock();
       timersLock.unlock();
       elementsLock.unlock();
@@ -186,7 +358,6 @@ namespace mars {
       //      destroyLock(&timersLock);
       //      destroyLock(&elementsLock);
       //      destroyLock(&idMutex);
-      //      destroyLock(&updatedElementsLock);
       //      destroyLock(&pendingRegistrationLock);
       //fprintf(stderr, "Delete data_broker\n");
     }
@@ -203,258 +374,360 @@ namespace mars {
     //  while((pthread_cond_destroy(cond) == -1) && (errno == EBUSY));
     //}
 
-    bool DataBroker::createTimer(const std::string &timerName) {
+    TimerHandle DataBroker::createTimer(const std::string &timerName) {
       std::map<std::string, Timer>::iterator timerIt;
-      bool ok = false;
-      bool advanceIterator = true;
       timersLock.lockForWrite();
       timerIt = timers.find(timerName);
-      if(timerIt == timers.end()) {
-        timers[timerName] = Timer();
-        timers[timerName].t = 0;
-        timers[timerName].receivers.clear();
-        timers[timerName.c_str()].lock = new mars::utils::ReadWriteLock();
-        ok = true;
-        std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
+      if(timerIt != timers.end()) {
+        timersLock.unlock();
+        return NULL;
+      }
+      Timer *timer = &timers[timerName];
+      timer->t = 0;
+      timer->nextSequence = 0;
+      timer->lock = new mars::utils::ReadWriteLock();
+      timer->timePackage.add("t", (long)0);
+      timer->timePackage.add("tf", 0.);
+      std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
 
-        DataElement *e = createDataElement("data_broker", "timers/" + timerName,
-                                           DATA_PACKAGE_READ_FLAG);
-        timers[timerName].timerElementId = e->info.dataId;
-        elementsLock.lockForWrite();
-        publishDataElement(e);
-        elementsLock.unlock();
+      DataElement *e = createDataElement("data_broker", "timers/" + timerName,
+                                         DATA_PACKAGE_READ_FLAG);
+      timer->timerElementId = e->info.dataId;
+      elementsLock.lockForWrite();
+      publishDataElement(e);
+      elementsLock.unlock();
 
-        // check for pending timer registrations
-        std::list<PendingTimedRegistration>::iterator pendingIt;
-        pendingRegistrationLock.lock();
-        for(pendingIt = pendingTimedRegistrations.begin();
-            pendingIt != pendingTimedRegistrations.end(); /* do nothing */) {
-          advanceIterator = true;
-          if(pendingIt->timerName == timerName) {
-            elementsLock.lockForRead();
-            elementIt = elementsByName.find(std::make_pair(pendingIt->groupName,
-                                                           pendingIt->dataName));
-            if(elementIt != elementsByName.end()) {
-              DataElement *element = elementIt->second;
-              TimedReceiver timedReceiver = {pendingIt->receiver, element,
-                                             pendingIt->updatePeriod,
-                                             timerIt->second.t,
-                                             pendingIt->callbackParam};
-              timerIt->second.receivers.locked_push_back(timedReceiver);
-              pendingIt = pendingTimedRegistrations.erase(pendingIt);
-              advanceIterator = false;
-            }
-            elementsLock.unlock();
-          }
-          if(advanceIterator) {
-            ++pendingIt;
+      // check for pending timer registrations
+      std::list<PendingTimedRegistration>::iterator pendingIt;
+      pendingRegistrationLock.lock();
+      for(pendingIt = pendingTimedRegistrations.begin();
+          pendingIt != pendingTimedRegistrations.end(); /* do nothing */) {
+        DataElement *element = NULL;
+        if(pendingIt->timerName == timerName) {
+          elementsLock.lockForRead();
+          elementIt = elementsByName.find(std::make_pair(pendingIt->groupName,
+                                                         pendingIt->dataName));
+          if(elementIt != elementsByName.end()) {
+            element = elementIt->second;
           }
+          elementsLock.unlock();
+        }
+        if(element) {
+          TimedReceiver timedReceiver = {pendingIt->receiver, element,
+                                         pendingIt->updatePeriod, 0,
+                                         pendingIt->callbackParam, 0};
+          addTimedReceiver(timer, timedReceiver);
+          pendingIt = pendingTimedRegistrations.erase(pendingIt);
+        } else {
+          ++pendingIt;
         }
+      }
 
-        // check for pending timed producers
-        std::list<PendingTimedProducer>::iterator pendingProducerIt;
-        for(pendingProducerIt = pendingTimedProducers.begin();
-            pendingProducerIt != pendingTimedProducers.end(); /* do nothing */) {
-          if(pendingProducerIt->timerName == timerName) {
-            elementsLock.lockForRead(); // ToDo: missing unlock
-            elementIt = elementsByName.find(std::make_pair(pendingProducerIt->groupName,
-                                                           pendingProducerIt->dataName));
-            DataElement *element;
-            if(elementIt != elementsByName.end()) {
-              element = elementIt->second;
-            } else {
-              element = createDataElement(pendingProducerIt->groupName,
-                                          pendingProducerIt->dataName,
-                                          DATA_PACKAGE_NO_FLAG);
-            }
-            TimedProducer timedProducer = {pendingProducerIt->producer, element,
-                                           pendingProducerIt->updatePeriod,
-                                           timerIt->second.t,
-                                           pendingProducerIt->callbackParam};
-            timerIt->second.producers.locked_push_back(timedProducer);
-            pendingProducerIt = pendingTimedProducers.erase(pendingProducerIt);
+      // check for pending timed producers
+      std::list<PendingTimedProducer>::iterator pendingProducerIt;
+      for(pendingProducerIt = pendingTimedProducers.begin();
+          pendingProducerIt != pendingTimedProducers.end(); /* do nothing */) {
+        if(pendingProducerIt->timerName == timerName) {
+          DataElement *element;
+          elementsLock.lockForWrite();
+          elementIt = elementsByName.find(std::make_pair(pendingProducerIt->groupName,
+                                                         pendingProducerIt->dataName));
+          if(elementIt != elementsByName.end()) {
+            element = elementIt->second;
           } else {
-            ++pendingProducerIt;
+            element = createDataElement(pendingProducerIt->groupName,
+                                        pendingProducerIt->dataName,
+                                        DATA_PACKAGE_NO_FLAG);
           }
+          elementsLock.unlock();
+          TimedProducer timedProducer = {pendingProducerIt->producer, element,
+                                         pendingProducerIt->updatePeriod, 0,
+                                         pendingProducerIt->callbackParam, 0,
+                                         pendingProducerIt->onlyWithReceivers};
+          addTimedProducer(timer, timedProducer);
+          pendingProducerIt = pendingTimedProducers.erase(pendingProducerIt);
+        } else {
+          ++pendingProducerIt;
         }
-
-        pendingRegistrationLock.unlock();
       }
 
+      pendingRegistrationLock.unlock();
       timersLock.unlock();
-      return ok;
+      return timer;
     }
 
-    bool DataBroker::stepTimer(const std::string &timerName, long step) {
-      std::map<std::string, Timer>::iterator timerIt, endIt;
-      std::list<DeferredCallback> deferredCallbacks;
-      std::set<DataItemConnection> activeConnections;
-      std::set<DataElement*> connectionActivatedElements;
-      DataItem currentItem;
-
-      //bool ok = false;
+    TimerHandle DataBroker::getTimer(const std::string &timerName) const {
+      std::map<std::string, Timer>::const_iterator timerIt;
+      TimerHandle timer = NULL;
       timersLock.lockForRead();
       timerIt = timers.find(timerName);
-      // The use of an iterator should be thread-safe.
-      // The timers.end() call might not be.
-      endIt = timers.end();
-      timersLock.unlock();
-      if(timerIt == endIt) {
-        return false;
+      if(timerIt != timers.end()) {
+        timer = const_cast<Timer*>(&timerIt->second);
       }
-      //ok = true;
-      timerIt->second.lock->lockForWrite();
-      timerIt->second.t += step;
-      // call all producers
-      DeferredCallback deferredCallback;
-      std::list<TimedProducer>::iterator producerIt;
-      for(producerIt = timerIt->second.producers.begin();
-          producerIt != timerIt->second.producers.end();
-          ++producerIt) {
-        if(producerIt->nextTriggerTime <= timerIt->second.t) {
-          while(producerIt->updatePeriod > 0 &&
-                producerIt->nextTriggerTime <= timerIt->second.t) {
-            producerIt->nextTriggerTime += producerIt->updatePeriod;
-          }
-          DataElement *element = producerIt->element;
-
-          deferredCallback.receivers.clear();
-
-          element->bufferLock->lockForWrite();
-          producerIt->producer->produceData(element->info,
-                                            element->backBuffer,
-                                            producerIt->callbackParam);
-          std::swap(element->backBuffer, element->frontBuffer);
-          element->receiverLock->lockForRead();
-          if(!element->syncReceivers.empty()) {
-            deferredCallback.package = *element->frontBuffer;
-            deferredCallback.info = element->info;
-            deferredCallback.producer = NULL;
-            deferredCallback.receivers = element->syncReceivers;
-          }
-          std::list<DataItemConnection>::iterator connectionIt;
-          for(connectionIt = element->connections.begin();
-              connectionIt != element->connections.end(); ++connectionIt) {
-            long fromIdx = connectionIt->fromDataItemIndex;
-            long toIdx = connectionIt->toDataItemIndex;
-            currentItem = (*connectionIt->fromElement->frontBuffer)[fromIdx];
-            currentItem.setName((*connectionIt->toElement->backBuffer)[toIdx].getName());
-            (*connectionIt->toElement->frontBuffer)[toIdx] = currentItem;
-            connectionActivatedElements.insert(connectionIt->toElement);
-          }
-          element->receiverLock->unlock();
-          element->bufferLock->unlock();
+      timersLock.unlock();
+      return timer;
+    }
 
-          updatedElementsLock.lock();
-          updatedElementsBackBuffer->insert(element);
-          updatedElementsLock.unlock();
+    void DataBroker::addTimedReceiver(Timer *timer, TimedReceiver receiver) {
+      timer->lock->lockForWrite();
+      receiver.nextTriggerTime = timer->t;
+      receiver.sequence = timer->nextSequence++;
+      timer->receivers.push_back(receiver);
+      ++receiver.element->numTimedReceivers;
+      std::push_heap(timer->receivers.begin(), timer->receivers.end(),
+                     LaterTrigger());
+      timer->lock->unlock();
+    }
 
-          // defer synchronous callbacks until we do not hold any locks anymore
-          if(!deferredCallback.receivers.empty())
-            deferredCallbacks.push_back(deferredCallback);
-        }
-      }
+    void DataBroker::addTimedProducer(Timer *timer, TimedProducer producer) {
+      timer->lock->lockForWrite();
+      producer.nextTriggerTime = timer->t;
+      producer.sequence = timer->nextSequence++;
+      timer->producers.push_back(producer);
+      std::push_heap(timer->producers.begin(), timer->producers.end(),
+                     LaterTrigger());
+      timer->lock->unlock();
+    }
 
-      // push time package
-      DataPackage p;
-      p.add("t", timerIt->second.t);
-      pushData(timerIt->second.timerElementId, p);
+    bool DataBroker::stepTimer(const std::string &timerName, long step) {
+      return stepTimer(getTimer(timerName), step);
+    }
 
-      // defer receivers
-      long time = timerIt->second.t;
-      std::list<TimedReceiver> deferredReceivers;
-      std::list<TimedReceiver>::iterator timedReceiverIt;
+    bool DataBroker::stepTimer(TimerHandle timer, long step) {
+      return stepTimerNs(timer, (int64_t)step * TIMER_STEP_NS);
+    }
 
-      for(timedReceiverIt = timerIt->second.receivers.begin();
-          timedReceiverIt != timerIt->second.receivers.end();
-          ++timedReceiverIt) {
-        if(timedReceiverIt->nextTriggerTime <= time) {
-          while(timedReceiverIt->updatePeriod > 0 &&
-                timedReceiverIt->nextTriggerTime <= time) {
-            timedReceiverIt->nextTriggerTime += timedReceiverIt->updatePeriod;
+    bool DataBroker::stepTimerNs(TimerHandle timer, int64_t stepNs) {
+      MARS_TRACE_SCOPE("DataBroker::stepTimer");
+      std::vector<DeferredCallback> deferredCallbacks;
+      std::vector<DeferredCallback>::iterator callbackIt;
+      std::vector<TimedProducer> dueProducers;
+      std::vector<TimedReceiver> dueReceivers;
+
+      if(!timer) {
+        return false;
+      }
+      timer->lock->lockForWrite();
+      timer->t += stepNs;
+      int64_t time = timer->t;
+
+      // Both lists are min-heaps on nextTriggerTime. Only the entries that
+      // are due are taken from the heap and are called in the order in
+      // which they were registered.
+      takeDue(&timer->producers, time, &dueProducers);
+      takeDue(&timer->receivers, time, &dueReceivers);
+
+      // call all producers, concurrently for different elements if there
+      // is a producer pool
+      deferredCallbacks.resize(dueProducers.size());
+      producerPoolLock.lockForRead();
+      if(producerPool && dueProducers.size() > 1) {
+        ProduceJob job;
+        std::map<DataElement*, size_t> groupIndex;
+        std::map<DataElement*, size_t>::iterator groupIt;
+        job.dataBroker = this;
+        job.producers = &dueProducers;
+        job.results = &deferredCallbacks;
+        for(size_t i = 0; i < dueProducers.size(); ++i) {
+          groupIt = groupIndex.find(dueProducers[i].element);
+          if(groupIt == groupIndex.end()) {
+            groupIt = groupIndex.insert(std::make_pair(dueProducers[i].element,
+                                                       job.groups.size())).first;
+            job.groups.push_back(std::vector<size_t>());
           }
-          deferredReceivers.push_back(*timedReceiverIt);
+          job.groups[groupIt->second].push_back(i);
+        }
+        producerPool->execute(&job, job.groups.size());
+      } else {
+        for(size_t i = 0; i < dueProducers.size(); ++i) {
+          callProducer(dueProducers[i], &deferredCallbacks[i]);
         }
       }
+      producerPoolLock.unlock();
+      putBackDue(&dueProducers, time, &timer->producers);
+
+      // push time package
+      timer->timePackage[0].set((long)(time / TIMER_STEP_NS));
+      timer->timePackage[1].set((double)time / TIMER_STEP_NS);
+      pushData(timer->timerElementId, timer->timePackage);
 
-      timerIt->second.lock->unlock();
+      putBackDue(&dueReceivers, time, &timer->receivers);
+      timer->lock->unlock();
 
-      // call all deferred receivers
-      for(timedReceiverIt = deferredReceivers.begin();
-          timedReceiverIt != deferredReceivers.end();
+      // call all due receivers
+      std::vector<TimedReceiver>::iterator timedReceiverIt;
+      for(timedReceiverIt = dueReceivers.begin();
+          timedReceiverIt != dueReceivers.end();
           ++timedReceiverIt) {
         DataElement *element = timedReceiverIt->element;
         element->bufferLock->lockForRead();
-        timedReceiverIt->receiver->receiveData(element->info,
-                                               *element->frontBuffer,
-                                               timedReceiverIt->callbackParam);
+        deliverData(timedReceiverIt->receiver, element->info,
+                    *element->frontBuffer, timedReceiverIt->callbackParam,
+                    RECEIVER_KIND_TIMED, sampleCallback());
         element->bufferLock->unlock();
       }
 
-      // connections
-      std::set<DataElement*>::iterator toElementIt;
-      fflush(stderr);
-      for(toElementIt = connectionActivatedElements.begin();
-          toElementIt != connectionActivatedElements.end(); ++toElementIt) {
-        DataElement *toElement = *toElementIt;
-        //      std::swap(toElement->frontBuffer, toElement->backBuffer);
-        pushData(toElement->info.dataId, *toElement->frontBuffer);
-      }
-      // call deferred sync callbacks
-      std::list<DeferredCallback>::iterator callbackIt;
-      std::list<Receiver>::iterator receiverIt;
+      // Call the sync receivers of the producers in registration order.
+      // Receivers that registered with readFrontBuffer read the front
+      // buffer under the shared lock, all others get the copy taken after
+      // the producer. Then push the connected elements.
+      ReceiverList::const_iterator receiverIt;
       for(callbackIt = deferredCallbacks.begin();
           callbackIt != deferredCallbacks.end();
           ++callbackIt) {
-        for(receiverIt = callbackIt->receivers.begin();
-            receiverIt != callbackIt->receivers.end();
-            ++receiverIt) {
-          receiverIt->receiver->receiveData(callbackIt->info,
-                                            callbackIt->package,
-                                            receiverIt->callbackParam);
+        DataElement *element = callbackIt->element;
+        if(callbackIt->receivers) {
+          for(receiverIt = callbackIt->receivers->begin();
+              receiverIt != callbackIt->receivers->end();
+              ++receiverIt) {
+            if(receiverIt->readFrontBuffer) {
+              element->bufferLock->lockForRead();
+              deliverData(receiverIt->receiver, element->info,
+                          *element->frontBuffer, receiverIt->callbackParam,
+                          RECEIVER_KIND_SYNC, callbackIt->timed);
+              element->bufferLock->unlock();
+            } else {
+              deliverData(receiverIt->receiver, element->info,
+                          callbackIt->package, receiverIt->callbackParam,
+                          RECEIVER_KIND_SYNC, callbackIt->timed);
+            }
+          }
+        }
+        if(callbackIt->hasPackage && element->numConnections.load()) {
+          pushConnections(element, callbackIt->package);
         }
       }
 
       return true;
     }
 
+    std::vector<std::string> DataBroker::getTimerNames() const {
+      std::vector<std::string> names;
+      std::map<std::string, Timer>::const_iterator timerIt;
+      timersLock.lockForRead();
+      for(timerIt = timers.begin(); timerIt != timers.end(); ++timerIt) {
+        names.push_back(timerIt->first);
+      }
+      timersLock.unlock();
+      return names;
+    }
+
+    int64_t DataBroker::getTimerTimeNs(TimerHandle timer) const {
+      if(!timer) {
+        return 0;
+      }
+      timer->lock->lockForRead();
+      int64_t time = timer->t;
+      timer->lock->unlock();
+      return time;
+    }
+
+    bool DataBroker::setTimerTimeNs(TimerHandle timer, int64_t timeNs) {
+      if(!timer) {
+        return false;
+      }
+      timer->lock->lockForWrite();
+      // shifting all trigger times by the same amount keeps the heaps valid
+      int64_t shift = timeNs - timer->t;
+      for(size_t i = 0; i < timer->producers.size(); ++i) {
+        timer->producers[i].nextTriggerTime += shift;
+      }
+      for(size_t i = 0; i < timer->receivers.size(); ++i) {
+        timer->receivers[i].nextTriggerTime += shift;
+      }
+      timer->t = timeNs;
+      timer->timePackage[0].set((long)(timeNs / TIMER_STEP_NS));
+      timer->timePackage[1].set((double)timeNs / TIMER_STEP_NS);
+      timer->lock->unlock();
+      return true;
+    }
+
+    void DataBroker::callProducer(const TimedProducer &producer,
+                                  DeferredCallback *deferred) {
+      DataElement *element = producer.element;
+      deferred->element = element;
+      deferred->hasPackage = false;
+      // the producer asked not to be called while nobody sees the data
+      if(producer.onlyWithReceivers && !hasConsumers(element)) {
+        deferred->timed = false;
+        return;
+      }
+      deferred->timed = countPush(element);
+
+      element->bufferLock->lockForWrite();
+      producer.producer->produceData(element->info, element->backBuffer,
+                                     producer.callbackParam);
+      std::swap(element->backBuffer, element->frontBuffer);
+      element->lastProducer = NULL;
+      if(element->numSyncReceivers.load()) {
+        deferred->receivers = std::atomic_load(&element->syncReceivers);
+      }
+      // the connections are pushed without lock and need a copy like
+      // all sync receivers that don't read the front buffer
+      if(element->numConnections.load() || needsCopy(deferred->receivers)) {
+        deferred->package = *element->frontBuffer;
+        deferred->hasPackage = true;
+        if(deferred->timed) {
+          countCopy(element, deferred->package);
+        }
+      }
+      if(element->numSampleQueues.load()) {
+        queueSamples(element, *element->frontBuffer, NULL);
+      }
+      element->bufferLock->unlock();
+
+      if(element->numAsyncReceivers.load()) {
+        markUpdated(element);
+      }
+    }
+
+    void DataBroker::setProducerThreads(int numThreads) {
+      WorkerPool *pool = NULL;
+      if(numThreads > 0) {
+        pool = new WorkerPool(numThreads);
+      }
+      producerPoolLock.lockForWrite();
+      std::swap(pool, producerPool);
+      producerPoolLock.unlock();
+      delete pool;
+    }
+
     bool DataBroker::registerTimedReceiver(ReceiverInterface *receiver,
                                            const std::string &groupName,
                                            const std::string &dataName,
                                            const std::string &timerName,
                                            int updatePeriod,
                                            int callbackParam) {
-      std::map<std::string, Timer>::iterator timerIt, endIt;
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
+      DataElement *element = NULL;
       bool ok = false;
 
-      timersLock.lockForRead();
-      timerIt = timers.find(timerName);
-      endIt = timers.end();
-      timersLock.unlock();
-      if(timerIt != endIt) {
+      Timer *timer = getTimer(timerName);
+      if(timer) {
         elementsLock.lockForRead();
         elementIt = elementsByName.find(std::make_pair(groupName, dataName));
         if(elementIt != elementsByName.end()) {
-          DataElement *element = elementIt->second;
-          TimedReceiver timedReceiver = {receiver, element, updatePeriod,
-                                         timerIt->second.t, callbackParam};
-          timerIt->second.receivers.locked_push_back(timedReceiver);
-          ok = true;
-          if(timerName == "_REALTIME_") {
-            lockRealtimeMutex();
-            stopRealtimeThread = false;
-            if(!startingRealtimeThread) {
-              startingRealtimeThread = true;
-              if(!realtimeThreadRunning) {
-                pthread_create(&realtimeThread, NULL, createRealtimeThread,
-                               (void*)this);
-              }
+          element = elementIt->second;
+        }
+        elementsLock.unlock();
+      }
+      if(element) {
+        TimedReceiver timedReceiver = {receiver, element, updatePeriod, 0,
+                                       callbackParam, 0};
+        addTimedReceiver(timer, timedReceiver);
+        ok = true;
+        if(timerName == "_REALTIME_") {
+          lockRealtimeMutex();
+          stopRealtimeThread = false;
+          if(!startingRealtimeThread) {
+            startingRealtimeThread = true;
+            if(!realtimeThreadRunning) {
+              pthread_create(&realtimeThread, NULL, createRealtimeThread,
+                             (void*)this);
             }
-            unlockRealtimeMutex();
           }
+          unlockRealtimeMutex();
         }
-        elementsLock.unlock();
       }
       // if there was a problem add to pending receivers
       if(!ok) {
@@ -474,36 +747,33 @@ namespace mars {
                                              const std::string &groupName,
                                              const std::string &dataName,
                                              const std::string &timerName) {
-      std::map<std::string, Timer>::iterator timerIt, endIt;
-      std::list<TimedReceiver>::iterator receiverIt;
+      std::vector<TimedReceiver>::iterator receiverIt;
       bool ok = false;
-      timersLock.lockForRead();
-      timerIt = timers.find(timerName);
-      endIt = timers.end();
-      timersLock.unlock();
-      if(timerIt != endIt) {
-        timerIt->second.lock->lockForWrite();
-        for(receiverIt = timerIt->second.receivers.begin();
-            receiverIt != timerIt->second.receivers.end(); /* do nothing */){
-          if(receiverIt->receiver == receiver) {
-            if(matchPattern(groupName, receiverIt->element->info.groupName) &&
-               matchPattern(dataName, receiverIt->element->info.dataName)) {
-              receiverIt = timerIt->second.receivers.erase(receiverIt);
-              ok = true;
-            }
-            else {
-              ++receiverIt;
-            }
+      Timer *timer = getTimer(timerName);
+      if(timer) {
+        timer->lock->lockForWrite();
+        for(receiverIt = timer->receivers.begin();
+            receiverIt != timer->receivers.end(); /* do nothing */){
+          if(receiverIt->receiver == receiver &&
+             matchPattern(groupName, receiverIt->element->info.groupName) &&
+             matchPattern(dataName, receiverIt->element->info.dataName)) {
+            --receiverIt->element->numTimedReceivers;
+            receiverIt = timer->receivers.erase(receiverIt);
+            ok = true;
           } else {
             ++receiverIt;
           }
         }
+        if(ok) {
+          std::make_heap(timer->receivers.begin(), timer->receivers.end(),
+                         LaterTrigger());
+        }
         if(timerName == "_REALTIME_" &&
-           timerIt->second.receivers.empty() &&
-           timerIt->second.producers.empty()) {
+           timer->receivers.empty() &&
+           timer->producers.empty()) {
           stopRealtimeThread = true;
         }
-        timerIt->second.lock->unlock();
+        timer->lock->unlock();
       }
       // remove receiver from pendingTimedRegistration list
       std::list<PendingTimedRegistration>::iterator pendingIt;
@@ -528,16 +798,13 @@ namespace mars {
                                            const std::string &dataName,
                                            const std::string &timerName,
                                            int updatePeriod,
-                                           int callbackParam) {
-      std::map<std::string, Timer>::iterator timerIt, endIt;
+                                           int callbackParam,
+                                           bool onlyWithReceivers) {
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
       bool ok = false;
-      timersLock.lockForRead();
-      timerIt = timers.find(timerName);
-      endIt = timers.end();
-      timersLock.unlock();
-      if(timerIt != endIt) {
-        elementsLock.lockForRead();
+      Timer *timer = getTimer(timerName);
+      if(timer) {
+        elementsLock.lockForWrite();
         elementIt = elementsByName.find(std::make_pair(groupName, dataName));
         DataElement *element = NULL;
         if(elementIt == elementsByName.end()) {
@@ -545,10 +812,10 @@ namespace mars {
         } else {
           element = elementIt->second;
         }
-        TimedProducer timedProducer = {producer, element, updatePeriod,
-                                       timerIt->second.t, callbackParam};
-        timerIt->second.producers.locked_push_back(timedProducer);
         elementsLock.unlock();
+        TimedProducer timedProducer = {producer, element, updatePeriod, 0,
+                                       callbackParam, 0, onlyWithReceivers};
+        addTimedProducer(timer, timedProducer);
         ok = true;
         if(timerName == "_REALTIME_") {
           stopRealtimeThread = false;
@@ -568,6 +835,7 @@ namespace mars {
         tmp.timerName = timerName.c_str();
         tmp.updatePeriod = updatePeriod;
         tmp.callbackParam = callbackParam;
+        tmp.onlyWithReceivers = onlyWithReceivers;
         pendingTimedProducers.locked_push_back(tmp);
       }
       return ok;
@@ -577,31 +845,31 @@ namespace mars {
                                              const std::string &groupName,
                                              const std::string &dataName,
                                              const std::string &timerName) {
-      std::map<std::string, Timer>::iterator timerIt, endIt;
-      std::list<TimedProducer>::iterator producerIt;
+      std::vector<TimedProducer>::iterator producerIt;
       bool ok = false;
-      timersLock.lockForRead();
-      timerIt = timers.find(timerName);
-      endIt = timers.end();
-      timersLock.unlock();
-      if(timerIt != endIt) {
-        timerIt->second.lock->lockForWrite();
-        for(producerIt = timerIt->second.producers.begin();
-            producerIt != timerIt->second.producers.end(); /* do nothing */) {
+      Timer *timer = getTimer(timerName);
+      if(timer) {
+        timer->lock->lockForWrite();
+        for(producerIt = timer->producers.begin();
+            producerIt != timer->producers.end(); /* do nothing */) {
           if(producerIt->producer == producer) {
             // todo: match group and data name
-            producerIt = timerIt->second.producers.erase(producerIt);
+            producerIt = timer->producers.erase(producerIt);
             ok = true;
           } else {
             ++producerIt;
           }
         }
+        if(ok) {
+          std::make_heap(timer->producers.begin(), timer->producers.end(),
+                         LaterTrigger());
+        }
         if(timerName == "_REALTIME_" &&
-           timerIt->second.receivers.empty() &&
-           timerIt->second.producers.empty()) {
+           timer->receivers.empty() &&
+           timer->producers.empty()) {
           stopRealtimeThread = true;
         }
-        timerIt->second.lock->unlock();
+        timer->lock->unlock();
       }
       // remove producer from pendingTimedProducers list
       std::list<PendingTimedProducer>::iterator pendingIt;
@@ -621,68 +889,84 @@ namespace mars {
     }
 
 
-    bool DataBroker::createTrigger(const std::string &triggerName) {
+    TriggerHandle DataBroker::createTrigger(const std::string &triggerName) {
       std::map<std::string, Trigger>::iterator triggerIt;
-      bool ok = false;
       triggersLock.lockForWrite();
       triggerIt = triggers.find(triggerName);
-      if(triggerIt == triggers.end()) {
-        triggers[triggerName] = Trigger();
-        triggers[triggerName].receivers.clear();
-        triggers[triggerName].lock = new ReadWriteLock;
-        ok = true;
+      if(triggerIt != triggers.end()) {
+        triggersLock.unlock();
+        return NULL;
       }
-      // check for pending timer registrations
+      Trigger *trigger = &triggers[triggerName];
+      trigger->lock = new ReadWriteLock;
+
+      // check for pending trigger registrations
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
       std::list<PendingTriggeredRegistration>::iterator pendingIt;
       pendingRegistrationLock.lock();
       for(pendingIt = pendingTriggeredRegistrations.begin();
           pendingIt != pendingTriggeredRegistrations.end(); /* do nothing */) {
-        if(pendingIt->triggerName == triggerName){
+        DataElement *element = NULL;
+        if(pendingIt->triggerName == triggerName) {
           elementsLock.lockForRead();
           elementIt = elementsByName.find(std::make_pair(pendingIt->groupName,
                                                          pendingIt->dataName));
           if(elementIt != elementsByName.end()) {
-            TriggeredReceiver triggeredReceiver = { pendingIt->receiver,
-                                                    elementIt->second,
-                                                    pendingIt->callbackParam };
-            triggerIt->second.receivers.locked_push_back(triggeredReceiver);
-            pendingIt = pendingTriggeredRegistrations.erase(pendingIt);
-          } else {
-            ++pendingIt;
+            element = elementIt->second;
           }
           elementsLock.unlock();
         }
+        if(element) {
+          TriggeredReceiver triggeredReceiver = { pendingIt->receiver,
+                                                  element,
+                                                  pendingIt->callbackParam };
+          trigger->receivers.push_back(triggeredReceiver);
+          ++element->numTriggeredReceivers;
+          pendingIt = pendingTriggeredRegistrations.erase(pendingIt);
+        } else {
+          ++pendingIt;
+        }
       }
       pendingRegistrationLock.unlock();
       triggersLock.unlock();
-      return ok;
+      return trigger;
     }
 
-    bool DataBroker::trigger(const std::string &triggerName) {
-      std::map<std::string, Trigger>::iterator triggerIt, endIt;
-      std::list<TriggeredReceiver>::iterator receiverIt;
-      bool ok = false;
+    TriggerHandle DataBroker::getTrigger(const std::string &triggerName) const {
+      std::map<std::string, Trigger>::const_iterator triggerIt;
+      TriggerHandle trigger = NULL;
       triggersLock.lockForRead();
       triggerIt = triggers.find(triggerName);
-      endIt = triggers.end();
+      if(triggerIt != triggers.end()) {
+        trigger = const_cast<Trigger*>(&triggerIt->second);
+      }
       triggersLock.unlock();
-      if(triggerIt != endIt) {
-        triggerIt->second.lock->lockForRead();
-        for(receiverIt = triggerIt->second.receivers.begin();
-            receiverIt != triggerIt->second.receivers.end();
-            ++receiverIt) {
-          DataElement *element = receiverIt->element;
-          element->bufferLock->lockForRead();
-          receiverIt->receiver->receiveData(element->info,
-                                            *element->frontBuffer,
-                                            receiverIt->callbackParam);
-          element->bufferLock->unlock();
-        }
-        triggerIt->second.lock->unlock();
-        ok = true;
+      return trigger;
+    }
+
+    bool DataBroker::trigger(const std::string &triggerName) {
+      return trigger(getTrigger(triggerName));
+    }
+
+    bool DataBroker::trigger(TriggerHandle trigger) {
+      MARS_TRACE_SCOPE("DataBroker::trigger");
+      std::vector<TriggeredReceiver>::iterator receiverIt;
+      if(!trigger) {
+        return false;
       }
-      return ok;
+      trigger->lock->lockForRead();
+      for(receiverIt = trigger->receivers.begin();
+          receiverIt != trigger->receivers.end();
+          ++receiverIt) {
+        DataElement *element = receiverIt->element;
+        element->bufferLock->lockForRead();
+        deliverData(receiverIt->receiver, element->info,
+                    *element->frontBuffer, receiverIt->callbackParam,
+                    RECEIVER_KIND_TRIGGERED, sampleCallback());
+        element->bufferLock->unlock();
+      }
+      trigger->lock->unlock();
+      return true;
     }
 
     bool DataBroker::registerTriggeredReceiver(ReceiverInterface *receiver,
@@ -690,20 +974,19 @@ namespace mars {
                                                const std::string &dataName,
                                                const std::string &triggerName,
                                                int callbackParam) {
-      std::map<std::string, Trigger>::iterator triggerIt, endIt;
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
       bool ok = false;
-      triggersLock.lockForRead();
-      triggerIt = triggers.find(triggerName);
-      endIt = triggers.end();
-      triggersLock.unlock();
-      if(triggerIt != endIt) {
+      Trigger *trigger = getTrigger(triggerName);
+      if(trigger) {
         elementsLock.lockForRead();
         elementIt = elementsByName.find(std::make_pair(groupName, dataName));
         if(elementIt != elementsByName.end()) {
           TriggeredReceiver triggeredReceiver = { receiver, elementIt->second,
                                                   callbackParam };
-          triggerIt->second.receivers.locked_push_back(triggeredReceiver);
+          trigger->lock->lockForWrite();
+          trigger->receivers.push_back(triggeredReceiver);
+          trigger->lock->unlock();
+          ++elementIt->second->numTriggeredReceivers;
           ok = true;
         }
         elementsLock.unlock();
@@ -715,30 +998,27 @@ namespace mars {
                                                  const std::string &groupName,
                                                  const std::string &dataName,
                                                  const std::string &triggerName) {
-      std::map<std::string, Trigger>::iterator triggerIt, endIt;
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
-      std::list<TriggeredReceiver>::iterator receiverIt;
+      std::vector<TriggeredReceiver>::iterator receiverIt;
       bool ok = false;
-      triggersLock.lockForRead();
-      triggerIt = triggers.find(triggerName);
-      endIt = triggers.end();
-      triggersLock.unlock();
-      if(triggerIt != endIt) {
+      Trigger *trigger = getTrigger(triggerName);
+      if(trigger) {
         elementsLock.lockForRead();
         elementIt = elementsByName.find(std::make_pair(groupName, dataName));
         if(elementIt != elementsByName.end()) {
-          triggerIt->second.lock->lockForWrite();
-          for(receiverIt = triggerIt->second.receivers.begin();
-              receiverIt != triggerIt->second.receivers.end(); /* do nothing */) {
+          trigger->lock->lockForWrite();
+          for(receiverIt = trigger->receivers.begin();
+              receiverIt != trigger->receivers.end(); /* do nothing */) {
             if((receiverIt->receiver == receiver) &&
                (receiverIt->element == elementIt->second)) {
-              receiverIt = triggerIt->second.receivers.erase(receiverIt);
+              --receiverIt->element->numTriggeredReceivers;
+              receiverIt = trigger->receivers.erase(receiverIt);
               ok = true;
             } else {
               ++receiverIt;
             }
           }
-          triggerIt->second.lock->unlock();
+          trigger->lock->unlock();
         }
         elementsLock.unlock();
       }
@@ -764,20 +1044,22 @@ namespace mars {
     bool DataBroker::registerSyncReceiver(ReceiverInterface *receiver,
                                           const std::string &groupName,
                                           const std::string &dataName,
-                                          int callbackParam) {
+                                          int callbackParam,
+                                          bool readFrontBuffer) {
       std::vector<DataElement*> elements;
       bool wildcards = hasWildcards(groupName) || hasWildcards(dataName);
       elementsLock.lockForRead();
       getElementsByName(groupName, dataName, &elements);
       for(std::vector<DataElement*>::iterator elementIt = elements.begin();
           elementIt != elements.end(); ++elementIt){
-        DataElement *element = *elementIt;
-        Receiver r = { receiver, callbackParam };
-        element->syncReceivers.locked_push_back(r);
+        Receiver r = { receiver, callbackParam, AsyncMailboxPtr(),
+                       readFrontBuffer };
+        addReceiver(*elementIt, true, r);
       }
       if(wildcards || elements.empty()) {
         PendingRegistration tmp = { receiver, groupName.c_str(),
-                                    dataName.c_str(), callbackParam };
+                                    dataName.c_str(), callbackParam,
+                                    ASYNC_LATEST_ONLY, 0., readFrontBuffer };
         pendingSyncRegistrations.locked_push_back(tmp);
       }
       elementsLock.unlock();
@@ -788,25 +1070,13 @@ namespace mars {
                                             const std::string &groupName,
                                             const std::string &dataName) {
       std::vector<DataElement*> elements;
-      std::list<Receiver>::iterator receiverIt;
       std::list<PendingRegistration>::iterator pendingRegistrationIt;
       elementsLock.lockForRead();
       getElementsByName(groupName, dataName, &elements);
       int cnt = 0;
       for(std::vector<DataElement*>::iterator elementIt = elements.begin();
           elementIt != elements.end(); ++elementIt) {
-        DataElement *element = *elementIt;
-        element->receiverLock->lockForWrite();
-        for(receiverIt = element->syncReceivers.begin();
-            receiverIt != element->syncReceivers.end(); /* do nothing */) {
-          if(receiverIt->receiver == receiver) {
-            receiverIt = element->syncReceivers.erase(receiverIt);
-            ++cnt;
-          } else {
-            ++receiverIt;
-          }
-        }
-        element->receiverLock->unlock();
+        cnt += removeReceiver(*elementIt, true, receiver);
       }
       // remove from pending list
       pendingRegistrationLock.lock();
@@ -829,22 +1099,34 @@ namespace mars {
                                            const std::string &groupName,
                                            const std::string &dataName,
                                            int callbackParam) {
+      return registerAsyncReceiver(receiver, groupName, dataName,
+                                   callbackParam, ASYNC_LATEST_ONLY);
+    }
+
+    bool DataBroker::registerAsyncReceiver(ReceiverInterface *receiver,
+                                           const std::string &groupName,
+                                           const std::string &dataName,
+                                           int callbackParam,
+                                           AsyncReceiverMode mode,
+                                           double frequency) {
       std::vector<DataElement*> elements;
       bool wildcards = hasWildcards(groupName) || hasWildcards(dataName);
       elementsLock.lockForRead();
       getElementsByName(groupName, dataName, &elements);
       for(std::vector<DataElement*>::iterator elementIt = elements.begin();
           elementIt != elements.end(); ++elementIt){
-        DataElement *element = *elementIt;
-        Receiver r = { receiver, callbackParam };
-        element->asyncReceivers.locked_push_back(r);
+        Receiver r = { receiver, callbackParam,
+                       createMailbox(mode, frequency) };
+        addReceiver(*elementIt, false, r);
       }
       if(wildcards || elements.empty()) {
         PendingRegistration tmp = { receiver, groupName.c_str(),
-                                    dataName.c_str(), callbackParam };
+                                    dataName.c_str(), callbackParam,
+                                    mode, frequency };
         pendingAsyncRegistrations.locked_push_back(tmp);
       }
       elementsLock.unlock();
+      startAsyncThread();
       return (wildcards || !elements.empty());
     }
 
@@ -852,25 +1134,13 @@ namespace mars {
                                              const std::string &groupName,
                                              const std::string &dataName) {
       std::vector<DataElement*> elements;
-      std::list<Receiver>::iterator receiverIt;
       std::list<PendingRegistration>::iterator pendingRegistrationIt;
       elementsLock.lockForRead();
       getElementsByName(groupName, dataName, &elements);
       int cnt = 0;
       for(std::vector<DataElement*>::iterator elementIt = elements.begin();
           elementIt != elements.end(); ++elementIt) {
-        DataElement *element = *elementIt;
-        element->receiverLock->lockForWrite();
-        for(receiverIt = element->asyncReceivers.begin();
-            receiverIt != element->asyncReceivers.end(); /* do nothing */) {
-          if(receiverIt->receiver == receiver) {
-            receiverIt = element->asyncReceivers.erase(receiverIt);
-            ++cnt;
-          } else {
-            ++receiverIt;
-          }
-        }
-        element->receiverLock->unlock();
+        cnt += removeReceiver(*elementIt, false, receiver);
       }
       // remove from pending list
       pendingAsyncRegistrations.lock();
@@ -916,69 +1186,346 @@ namespace mars {
     unsigned long DataBroker::pushData(unsigned long id,
                                        const DataPackage &dataPackage,
                                        const ReceiverInterface *producer) {
-      std::list<Receiver>::iterator syncReceiverIt;
-      std::map<unsigned long, DataElement*>::iterator elementIt;
-      std::set<DataElement*> connectionActivatedElements;
-      std::list<Receiver> syncReceivers;
-      DataInfo info;
-      DataElement *element = NULL;
-      elementsLock.lockForRead();
-      elementIt = elementsById.find(id);
-      if(elementIt == elementsById.end()) {
+      DataElement *element = getElementById(id);
+      if(!element) {
         // ERROR: id not found!
-        elementsLock.unlock();
         return 0;
-      } else {
-        element = elementIt->second;
-        *element->backBuffer = dataPackage;
-        element->bufferLock->lockForWrite();
-        std::swap(element->backBuffer, element->frontBuffer);
-        element->lastProducer = producer;
-        element->bufferLock->unlock();
+      }
+      bool timed = countPush(element);
+      if(timed) {
+        countCopy(element, dataPackage);
+      }
+      *element->backBuffer = dataPackage;
+      element->bufferLock->lockForWrite();
+      std::swap(element->backBuffer, element->frontBuffer);
+      element->lastProducer = producer;
+      element->bufferLock->unlock();
 
-        updatedElementsLock.lock();
-        updatedElementsBackBuffer->insert(element);
-        updatedElementsLock.unlock();
-
-        element->receiverLock->lockForRead();
-        // defer synchronous callbacks until we do not hold any locks anymore
-        syncReceivers = element->syncReceivers;
-        info = element->info;
-        element->receiverLock->unlock();
-        for(std::list<DataItemConnection>::iterator connectionIt = element->connections.begin(); connectionIt != element->connections.end(); ++connectionIt) {
-          long fromIdx = connectionIt->fromDataItemIndex;
-          long toIdx = connectionIt->toDataItemIndex;
-          DataItem currentItem;
-          currentItem = (*connectionIt->fromElement->frontBuffer)[fromIdx];
-          currentItem.setName((*connectionIt->toElement->frontBuffer)[toIdx].getName());
-          (*connectionIt->toElement->frontBuffer)[toIdx] = currentItem;
-          connectionActivatedElements.insert(connectionIt->toElement);
-        }
+      distributeData(element, dataPackage, producer, timed);
+
+      if(timed) {
+        publishStatistics(getTimeNs()/1000);
+      }
+      return id;
+    }
+
+    void DataBroker::distributeData(DataElement *element,
+                                    const DataPackage &package,
+                                    const ReceiverInterface *producer,
+                                    bool timed) {
+      if(element->numSampleQueues.load()) {
+        queueSamples(element, package, producer);
+      }
+      if(element->numAsyncReceivers.load()) {
+        markUpdated(element);
       }
-      elementsLock.unlock();
 
       // do the synchronous callbacks
-      for(syncReceiverIt = syncReceivers.begin();
-          syncReceiverIt != syncReceivers.end();
-          ++syncReceiverIt) {
-        if(syncReceiverIt->receiver != producer)
-          syncReceiverIt->receiver->receiveData(info, dataPackage,
-                                                syncReceiverIt->callbackParam);
+      if(element->numSyncReceivers.load()) {
+        ReceiverListPtr syncReceivers = std::atomic_load(&element->syncReceivers);
+        ReceiverList::const_iterator syncReceiverIt;
+        for(syncReceiverIt = syncReceivers->begin();
+            syncReceiverIt != syncReceivers->end();
+            ++syncReceiverIt) {
+          if(syncReceiverIt->receiver != producer)
+            deliverData(syncReceiverIt->receiver, element->info, package,
+                        syncReceiverIt->callbackParam, RECEIVER_KIND_SYNC,
+                        timed);
+        }
       }
 
-      for(std::set<DataElement*>::iterator toElementIt = connectionActivatedElements.begin(); toElementIt != connectionActivatedElements.end(); ++toElementIt) {
-        DataElement *toElement = *toElementIt;
-        pushData(toElement->info.dataId, *toElement->frontBuffer);
+      if(element->numConnections.load()) {
+        pushConnections(element, package);
       }
+    }
 
-      // The main thread only releases the wakeupMutex when it goes to sleep.
-      // So if we can lock it, we wake up the main thread so it can process the
-      // data we just pushed. Otherwise it is still running and will process it.
-      if(wakeupMutex.tryLock() == MUTEX_ERROR_NO_ERROR) {
-        wakeupCondition.wakeOne();
+    void DataBroker::queueSamples(DataElement *element,
+                                  const DataPackage &package,
+                                  const ReceiverInterface *producer) {
+      ReceiverListPtr receivers = std::atomic_load(&element->asyncReceivers);
+      ReceiverList::const_iterator it;
+      for(it = receivers->begin(); it != receivers->end(); ++it) {
+        AsyncMailbox *mailbox = it->mailbox.get();
+        if(!mailbox || mailbox->mode != ASYNC_EVERY_SAMPLE ||
+           it->receiver == producer) {
+          continue;
+        }
+        // never block the producer, drop the oldest sample instead
+        mailbox->queueMutex.lock();
+        if(mailbox->queue.size() >= ASYNC_QUEUE_LIMIT) {
+          mailbox->queue.pop_front();
+          ++mailbox->dropped;
+        }
+        mailbox->queue.push_back(package);
+        mailbox->queueMutex.unlock();
+      }
+    }
+
+    void DataBroker::pushConnections(DataElement *element,
+                                     const DataPackage &package) {
+      CopyPlanPtr plan = std::atomic_load(&element->copyPlan);
+      if(!plan) {
+        return;
+      }
+      CopyPlan::const_iterator targetIt;
+      std::vector<ItemCopy>::const_iterator itemIt;
+      for(targetIt = plan->begin(); targetIt != plan->end(); ++targetIt) {
+        DataElement *toElement = targetIt->element;
+        DataPackage snapshot;
+        bool timed = countPush(toElement);
+
+        // Build the new package of the target in its back buffer, so that
+        // all connected items of this target are updated by one push.
+        toElement->bufferLock->lockForWrite();
+        DataPackage *toPackage = toElement->backBuffer;
+        *toPackage = *toElement->frontBuffer;
+        for(itemIt = targetIt->items.begin();
+            itemIt != targetIt->items.end(); ++itemIt) {
+          if(itemIt->fromIndex < (long)package.size() &&
+             itemIt->toIndex < (long)toPackage->size()) {
+            (*toPackage)[itemIt->toIndex].copyValue(package[itemIt->fromIndex]);
+          }
+        }
+        std::swap(toElement->backBuffer, toElement->frontBuffer);
+        toElement->lastProducer = NULL;
+        // the sync receivers are called without lock and need their own copy
+        if(toElement->numSyncReceivers.load() ||
+           toElement->numConnections.load() ||
+           toElement->numSampleQueues.load()) {
+          snapshot = *toElement->frontBuffer;
+        }
+        if(timed) {
+          countCopy(toElement, *toElement->frontBuffer);
+        }
+        toElement->bufferLock->unlock();
+
+        distributeData(toElement, snapshot, NULL, timed);
+      }
+    }
+
+    bool DataBroker::countPush(DataElement *element) {
+      if(!statisticsEnabled.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      unsigned long count = element->pushCount.fetch_add(1, std::memory_order_relaxed);
+      return (count % statisticsInterval.load() == 0);
+    }
+
+    void DataBroker::markUpdated(DataElement *element) {
+      // only the first update since the last run() pass queues the element
+      if(element->updatePending.exchange(true)) {
+        return;
+      }
+      element->updateTime = getTimeNs()/1000;
+      DataElement *head = updatedElements.load();
+      do {
+        element->nextUpdated = head;
+      } while(!updatedElements.compare_exchange_weak(head, element));
+
+      // Only the transition from an empty to a non empty queue has to wake
+      // up the main thread. It checks the queue under the wakeupMutex before
+      // it goes to sleep, so we cannot miss it.
+      if(head == NULL) {
+        wakeupMutex.lock();
+        if(threadSleeping) {
+          wakeupCondition.wakeOne();
+        }
         wakeupMutex.unlock();
       }
-      return id;
+    }
+
+    void DataBroker::startAsyncThread() {
+      wakeupMutex.lock();
+      if(!asyncThreadStarted && !stop_thread) {
+        asyncThreadStarted = true;
+        pthread_create(&theThread, NULL, createDataBrokerThread, (void*)this);
+      }
+      wakeupMutex.unlock();
+    }
+
+    void DataBroker::setAsyncInterval(double milliseconds) {
+      asyncInterval.store(milliseconds > 0. ? (long long)(milliseconds*1000.)
+                          : 0);
+    }
+
+    void DataBroker::setStatisticsEnabled(bool enabled,
+                                          unsigned int sampleInterval) {
+      if(!enabled) {
+        statisticsEnabled.store(false);
+        return;
+      }
+      statsMutex.lock();
+      callbackHistograms.clear();
+      unsigned long idCount = getIdCount();
+      for(unsigned long id = 1; id < idCount; ++id) {
+        DataElement *element = getElementById(id);
+        if(!element) continue;
+        element->pushCount.store(0);
+        element->bytesCopied.store(0);
+        element->lastPushCount = 0;
+        element->lastBytesCopied = 0;
+        element->pushRate = element->bytesPerSecond = 0.;
+      }
+      statisticsInterval.store(sampleInterval > 0 ? sampleInterval : 1);
+      statisticsPublishTime.store(getTimeNs()/1000);
+      statisticsEnabled.store(true);
+      statsMutex.unlock();
+    }
+
+    std::vector<DataElementStatistics> DataBroker::getStatistics() const {
+      std::vector<DataElementStatistics> statistics;
+      std::map<CallbackKey, CallbackHistogram>::const_iterator histogramIt;
+      unsigned long idCount = getIdCount();
+
+      statsMutex.lock();
+      histogramIt = callbackHistograms.begin();
+      for(unsigned long id = 1; id < idCount; ++id) {
+        DataElement *element = getElementById(id);
+        if(!element) continue;
+        DataElementStatistics elementStats;
+        elementStats.info = element->info;
+        elementStats.pushCount = element->pushCount.load();
+        elementStats.pushRate = element->pushRate;
+        elementStats.bytesCopied = element->bytesCopied.load();
+        elementStats.bytesPerSecond = element->bytesPerSecond;
+        elementStats.numSyncReceivers = element->numSyncReceivers.load();
+        elementStats.numAsyncReceivers = element->numAsyncReceivers.load();
+        elementStats.numTimedReceivers = element->numTimedReceivers.load();
+        elementStats.numTriggeredReceivers = element->numTriggeredReceivers.load();
+        // the histograms are sorted by dataId
+        while(histogramIt != callbackHistograms.end() &&
+              histogramIt->first.dataId < id) {
+          ++histogramIt;
+        }
+        for(; histogramIt != callbackHistograms.end() &&
+              histogramIt->first.dataId == id; ++histogramIt) {
+          ReceiverStatistics receiverStats;
+          receiverStats.receiver = histogramIt->first.receiver;
+          receiverStats.kind = histogramIt->first.kind;
+          receiverStats.samples = histogramIt->second.samples;
+          receiverStats.p50 = getPercentile(histogramIt->second, 0.5);
+          receiverStats.p99 = getPercentile(histogramIt->second, 0.99);
+          receiverStats.max = histogramIt->second.maxTime*0.001;
+          elementStats.receivers.push_back(receiverStats);
+        }
+        if(elementStats.pushCount == 0 &&
+           elementStats.numSyncReceivers == 0 &&
+           elementStats.numAsyncReceivers == 0 &&
+           elementStats.numTimedReceivers == 0 &&
+           elementStats.numTriggeredReceivers == 0) {
+          continue;
+        }
+        statistics.push_back(elementStats);
+      }
+      statsMutex.unlock();
+      return statistics;
+    }
+
+    unsigned long DataBroker::getIdCount() const {
+      MutexLocker locker(&idMutex);
+      return next_id;
+    }
+
+    bool DataBroker::sampleCallback() const {
+      if(!statisticsEnabled.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      // xorshift seeded with the address of the thread local state
+      static thread_local unsigned int state = 0;
+      if(state == 0) {
+        state = (unsigned int)(size_t)&state | 1;
+      }
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return (state % statisticsInterval.load() == 0);
+    }
+
+    void DataBroker::countCopy(DataElement *element,
+                               const DataPackage &package) {
+      // only every statisticsInterval-th copy is sized
+      element->bytesCopied.fetch_add(estimatePackageSize(package) *
+                                     statisticsInterval.load(),
+                                     std::memory_order_relaxed);
+    }
+
+    void DataBroker::deliverData(ReceiverInterface *receiver,
+                                 const DataInfo &info,
+                                 const DataPackage &package,
+                                 int callbackParam, ReceiverKind kind,
+                                 bool timed) {
+      if(!timed) {
+        receiver->receiveData(info, package, callbackParam);
+        return;
+      }
+      long long start = getTimeNs();
+      receiver->receiveData(info, package, callbackParam);
+      long long duration = getTimeDiffNs(start);
+
+      int bucket = 0;
+      while(bucket < CallbackHistogram::NUM_BUCKETS-1 &&
+            (duration >> (bucket+1)) > 0) {
+        ++bucket;
+      }
+      CallbackKey key = {info.dataId, receiver, kind};
+      statsMutex.lock();
+      CallbackHistogram &histogram = callbackHistograms[key];
+      ++histogram.buckets[bucket];
+      ++histogram.samples;
+      if(duration > histogram.maxTime) {
+        histogram.maxTime = duration;
+      }
+      statsMutex.unlock();
+    }
+
+    void DataBroker::publishStatistics(long long now) {
+      long long last = statisticsPublishTime.load();
+      if(now - last < 1000000) {
+        return;
+      }
+      // only one thread publishes, this also stops the recursion via the
+      // pushData() below
+      if(!statisticsPublishTime.compare_exchange_strong(last, now)) {
+        return;
+      }
+      double seconds = (now - last)*0.000001;
+      unsigned long idCount = getIdCount();
+      DataPackage package;
+      std::map<CallbackKey, CallbackHistogram>::const_iterator histogramIt;
+
+      statsMutex.lock();
+      for(unsigned long id = 1; id < idCount; ++id) {
+        DataElement *element = getElementById(id);
+        if(!element || id == statisticsId) continue;
+        unsigned long pushCount = element->pushCount.load();
+        unsigned long long bytesCopied = element->bytesCopied.load();
+        element->pushRate = (pushCount - element->lastPushCount) / seconds;
+        element->bytesPerSecond = ((bytesCopied - element->lastBytesCopied) /
+                                   seconds);
+        element->lastPushCount = pushCount;
+        element->lastBytesCopied = bytesCopied;
+        if(pushCount == 0) continue;
+        std::string prefix = element->info.groupName + "/" +
+          element->info.dataName + "/";
+        package.add(prefix + "pushRate", element->pushRate);
+        package.add(prefix + "bytesPerSecond", element->bytesPerSecond);
+        package.add(prefix + "receivers",
+                    (int)(element->numSyncReceivers.load() +
+                          element->numAsyncReceivers.load() +
+                          element->numTimedReceivers.load() +
+                          element->numTriggeredReceivers.load()));
+        // slowest receiver of the stream
+        double p99 = 0.;
+        CallbackKey key = {id, NULL, RECEIVER_KIND_SYNC};
+        for(histogramIt = callbackHistograms.lower_bound(key);
+            histogramIt != callbackHistograms.end() &&
+              histogramIt->first.dataId == id; ++histogramIt) {
+          p99 = std::max(p99, getPercentile(histogramIt->second, 0.99));
+        }
+        package.add(prefix + "callbackP99", p99);
+      }
+      statsMutex.unlock();
+      pushData(statisticsId, package);
     }
 
     void DataBroker::pushMessage(MessageType messageType,
@@ -1039,82 +1586,205 @@ namespace mars {
       long dt;
       while(!stopRealtimeThread) {
         dt = getTimeDiff(t);
-        stepTimer("_REALTIME_", dt);
+        stepTimer(realtimeTimer, dt);
         t += dt;
         msleep(10);
       }
     }
 
     void DataBroker::run() {
-      std::set<DataElement*>::iterator updatedElementsIt;
-      std::list<Receiver>::iterator receiverIt;
-      std::list<DeferredCallback> deferredCallbacks;
-      std::list<DeferredCallback>::iterator callbackIt;
+      ReceiverList::const_iterator receiverIt;
+      std::vector<DataElement*> updated;
+      std::vector<DataElement*>::reverse_iterator updatedIt;
+      std::vector<DecimatedUpdate> waiting, stillWaiting;
+      std::vector<DecimatedUpdate>::iterator waitingIt;
+      std::deque<DataPackage> samples;
+      std::deque<DataPackage>::iterator sampleIt;
+      DataPackage package;
+      const ReceiverInterface *producer;
+      long long lastPass = 0, now, nextDue = 0;
 
-      wakeupMutex.lock();
+      MARS_TRACE_THREAD_NAME("data_broker");
       while(!stop_thread) {
-        elementsLock.lockForRead();
-        updatedElementsLock.lock();
-        std::swap(updatedElementsBackBuffer, updatedElementsFrontBuffer);
-        updatedElementsLock.unlock();
-
-        for(updatedElementsIt = updatedElementsFrontBuffer->begin();
-            updatedElementsIt != updatedElementsFrontBuffer->end();
-            ++updatedElementsIt) {
-          DataElement *element = *updatedElementsIt;
+        // Keep the minimum interval between two passes. Everything pushed
+        // in the meantime is batched into the next pass.
+        now = getTimeNs()/1000;
+        long long waitTime = lastPass + asyncInterval.load() - now;
+        if(waitTime > 0) {
+          usleep(waitTime);
+          now = getTimeNs()/1000;
+        }
+        lastPass = now;
+        MARS_TRACE_SCOPE("DataBroker::dispatch");
+
+        // take all queued elements at once
+        updated.clear();
+        for(DataElement *element = updatedElements.exchange(NULL);
+            element; ) {
+          DataElement *next = element->nextUpdated;
+          updated.push_back(element);
+          element = next;
+        }
 
-          element->bufferLock->lockForRead();
-          element->receiverLock->lockForRead();
-          // defer callbacks until we do not hold any lock anymore
-          if(!element->asyncReceivers.empty()) {
-            DeferredCallback deferred;
-            deferred.receivers = element->asyncReceivers;
-            deferred.info = element->info;
-            deferred.package = *element->frontBuffer;
-            deferred.producer = element->lastProducer;
-            deferredCallbacks.push_back(deferred);
+        // the queue is a stack so walk it backwards to keep the push order
+        for(updatedIt = updated.rbegin(); updatedIt != updated.rend();
+            ++updatedIt) {
+          DataElement *element = *updatedIt;
+          long long queuedTime = element->updateTime;
+          // reset the flag before reading the buffer. A push after this
+          // point queues the element again and is delivered next pass.
+          element->updatePending.store(false);
+
+          ReceiverListPtr receivers = std::atomic_load(&element->asyncReceivers);
+          if(!receivers || receivers->empty()) {
+            continue;
+          }
+          double latency = (getTimeNs()/1000 - queuedTime)*0.001;
+          statsLatencySum += latency;
+          if(latency > statsMaxLatency) statsMaxLatency = latency;
+          ++statsCallbacks;
+
+          // The package is copied at most once per element and pass and
+          // only if a receiver wants the latest value now.
+          bool copied = false;
+          bool timed = sampleCallback();
+          for(receiverIt = receivers->begin(); receiverIt != receivers->end();
+              ++receiverIt) {
+            AsyncMailbox *mailbox = receiverIt->mailbox.get();
+            if(mailbox->mode == ASYNC_EVERY_SAMPLE) {
+              mailbox->queueMutex.lock();
+              samples.swap(mailbox->queue);
+              mailbox->queueMutex.unlock();
+              for(sampleIt = samples.begin(); sampleIt != samples.end();
+                  ++sampleIt) {
+                deliverData(receiverIt->receiver, element->info, *sampleIt,
+                            receiverIt->callbackParam, RECEIVER_KIND_ASYNC,
+                            timed);
+              }
+              samples.clear();
+              continue;
+            }
+            if(mailbox->mode == ASYNC_DECIMATE &&
+               now - mailbox->lastDelivery < mailbox->period) {
+              // deliver the latest value once the period has passed
+              if(!mailbox->waiting) {
+                DecimatedUpdate update = {element, *receiverIt};
+                mailbox->waiting = true;
+                waiting.push_back(update);
+              }
+              continue;
+            }
+            if(!copied) {
+              element->bufferLock->lockForRead();
+              package = *element->frontBuffer;
+              producer = element->lastProducer;
+              element->bufferLock->unlock();
+              if(timed) {
+                countCopy(element, package);
+              }
+              copied = true;
+            }
+            mailbox->lastDelivery = now;
+            if(receiverIt->receiver != producer)
+              deliverData(receiverIt->receiver, element->info, package,
+                          receiverIt->callbackParam, RECEIVER_KIND_ASYNC,
+                          timed);
           }
-          element->receiverLock->unlock();
-          element->bufferLock->unlock();
         }
-        updatedElementsFrontBuffer->clear();
-        elementsLock.unlock();
 
-        // make the callbacks
-        //pushError("DataBroker::deferredCallbacks %d", deferredCallbacks.size());
-        for(callbackIt = deferredCallbacks.begin();
-            callbackIt != deferredCallbacks.end(); ++callbackIt) {
-          for(receiverIt = callbackIt->receivers.begin();
-              receiverIt != callbackIt->receivers.end();
+        // decimated updates whose period has passed
+        stillWaiting.clear();
+        nextDue = 0;
+        for(waitingIt = waiting.begin(); waitingIt != waiting.end();
+            ++waitingIt) {
+          AsyncMailbox *mailbox = waitingIt->receiver.mailbox.get();
+          long long due = mailbox->lastDelivery + mailbox->period;
+          if(due > now) {
+            if(nextDue == 0 || due < nextDue) nextDue = due;
+            stillWaiting.push_back(*waitingIt);
+            continue;
+          }
+          mailbox->waiting = false;
+          // skip receivers that were unregistered in the meantime
+          DataElement *element = waitingIt->element;
+          ReceiverListPtr receivers = std::atomic_load(&element->asyncReceivers);
+          for(receiverIt = receivers->begin(); receiverIt != receivers->end();
               ++receiverIt) {
-            if(receiverIt->receiver != callbackIt->producer)
-              receiverIt->receiver->receiveData(callbackIt->info,
-                                                callbackIt->package,
-                                                receiverIt->callbackParam);
+            if(receiverIt->mailbox.get() == mailbox) break;
+          }
+          if(receiverIt == receivers->end()) {
+            continue;
           }
+          element->bufferLock->lockForRead();
+          package = *element->frontBuffer;
+          producer = element->lastProducer;
+          element->bufferLock->unlock();
+          mailbox->lastDelivery = now;
+          if(receiverIt->receiver != producer)
+            deliverData(receiverIt->receiver, element->info, package,
+                        receiverIt->callbackParam, RECEIVER_KIND_ASYNC,
+                        sampleCallback());
         }
-        deferredCallbacks.clear();
+        waiting.swap(stillWaiting);
 
-        // If there is no data to process go to sleep. pushData() will wake us up.
-        updatedElementsLock.lock();
-        bool bufferIsEmpty = updatedElementsBackBuffer->empty();
-        updatedElementsLock.unlock();
-        if(bufferIsEmpty) {
-          wakeupCondition.wait(&wakeupMutex);
+        ++statsPasses;
+        if(updated.size() > statsMaxQueueDepth) {
+          statsMaxQueueDepth = updated.size();
         }
-        msleep(10);
+        publishAsyncStats(now);
+        if(statisticsEnabled.load(std::memory_order_relaxed)) {
+          publishStatistics(now);
+        }
+
+        // If there is no data to process go to sleep. markUpdated() will
+        // wake us up. Waiting decimated updates limit the sleep.
+        wakeupMutex.lock();
+        while(!stop_thread && updatedElements.load() == NULL) {
+          threadSleeping = true;
+          if(waiting.empty()) {
+            wakeupCondition.wait(&wakeupMutex);
+            threadSleeping = false;
+          } else {
+            long long ms = (nextDue - getTimeNs()/1000)/1000 + 1;
+            wakeupCondition.wait(&wakeupMutex, ms > 0 ? (unsigned long)ms : 1);
+            threadSleeping = false;
+            break;
+          }
+        }
+        wakeupMutex.unlock();
       }
-      wakeupMutex.unlock();
+    }
+
+    void DataBroker::publishAsyncStats(long long now) {
+      if(statsStartTime == 0) {
+        statsStartTime = now;
+      }
+      if(now - statsStartTime < 1000000) {
+        return;
+      }
+      DataPackage package;
+      double seconds = (now - statsStartTime)*0.000001;
+      package.add("passes", (long)statsPasses);
+      package.add("callbacksPerSecond", statsCallbacks / seconds);
+      package.add("maxQueueDepth", (long)statsMaxQueueDepth);
+      package.add("avgLatency", (statsCallbacks ?
+                                 statsLatencySum / statsCallbacks : 0.));
+      package.add("maxLatency", statsMaxLatency);
+      statsStartTime = now;
+      statsPasses = statsCallbacks = statsMaxQueueDepth = 0;
+      statsLatencySum = statsMaxLatency = 0.;
+      pushData(asyncStatsId, package);
     }
 
 
     const std::vector<DataInfo> DataBroker::getDataList(PackageFlag flags) const {
       std::vector<DataInfo> dataList;
-      std::map<unsigned long, DataElement*>::const_iterator it;
       elementsLock.lockForRead();
-      for(it = elementsById.begin(); it != elementsById.end(); ++it) {
-        if(flags == DATA_PACKAGE_NO_FLAG || flags & it->second->info.flags) {
-          dataList.push_back(it->second->info);
+      for(unsigned long id = 1; id < next_id; ++id) {
+        DataElement *element = getElementById(id);
+        if(element && (flags == DATA_PACKAGE_NO_FLAG ||
+                       flags & element->info.flags)) {
+          dataList.push_back(element->info);
         }
       }
       elementsLock.unlock();
@@ -1124,19 +1794,20 @@ namespace mars {
 
     const DataPackage DataBroker::getDataPackage(unsigned long id) const {
       DataPackage dataPackage;
-      std::map<unsigned long, DataElement*>::const_iterator elementIt;
-      elementsLock.lockForRead();
-      elementIt = elementsById.find(id);
-      if(elementIt != elementsById.end()) {
-        DataElement *element = elementIt->second;
+      DataElement *element = getElementById(id);
+      if(element) {
         element->bufferLock->lockForRead();
-        dataPackage = *elementIt->second->frontBuffer;
+        dataPackage = *element->frontBuffer;
         element->bufferLock->unlock();
       }
-      elementsLock.unlock();
       return dataPackage;
     }
 
+    bool DataBroker::hasReceivers(unsigned long dataId) const {
+      DataElement *element = getElementById(dataId);
+      return element && hasConsumers(element);
+    }
+
     unsigned long DataBroker::getDataID(const std::string &groupName,
                                         const std::string &dataName) const {
       std::map<std::pair<std::string, std::string>, DataElement*>::const_iterator elementIt;
@@ -1183,11 +1854,147 @@ namespace mars {
       element->receiverLock = new ReadWriteLock;
       elementsByName[std::make_pair(groupName.c_str(),
                                     dataName.c_str())] = element;
-      elementsById[element->info.dataId] = element;
       updatePendingRegistrations(element);
+      insertElementById(element);
       return element;
     }
 
+    DataElement* DataBroker::getElementById(unsigned long id) const {
+      unsigned long chunk = id >> ELEMENT_CHUNK_BITS;
+      if(chunk >= ELEMENT_MAX_CHUNKS) {
+        return NULL;
+      }
+      std::atomic<DataElement*> *elements = elementChunks[chunk].load();
+      if(!elements) {
+        return NULL;
+      }
+      return elements[id & (ELEMENT_CHUNK_SIZE-1)].load();
+    }
+
+    void DataBroker::insertElementById(DataElement *element) {
+      unsigned long id = element->info.dataId;
+      unsigned long chunk = id >> ELEMENT_CHUNK_BITS;
+      if(chunk >= ELEMENT_MAX_CHUNKS) {
+        fprintf(stderr, "DataBroker: too many data elements!\n");
+        return;
+      }
+      std::atomic<DataElement*> *elements = elementChunks[chunk].load();
+      if(!elements) {
+        std::atomic<DataElement*> *newChunk;
+        newChunk = new std::atomic<DataElement*>[ELEMENT_CHUNK_SIZE];
+        for(unsigned long i = 0; i < ELEMENT_CHUNK_SIZE; ++i) {
+          newChunk[i].store(NULL);
+        }
+        if(elementChunks[chunk].compare_exchange_strong(elements, newChunk)) {
+          elements = newChunk;
+        } else {
+          // someone else was faster
+          delete[] newChunk;
+        }
+      }
+      // publishing the pointer makes the fully initialized element visible
+      elements[id & (ELEMENT_CHUNK_SIZE-1)].store(element);
+    }
+
+    void DataBroker::addReceiver(DataElement *element, bool sync,
+                                 const Receiver &receiver) {
+      ReceiverListPtr *list = (sync ? &element->syncReceivers
+                               : &element->asyncReceivers);
+      std::atomic<int> *count = (sync ? &element->numSyncReceivers
+                                 : &element->numAsyncReceivers);
+      element->receiverLock->lockForWrite();
+      ReceiverList *newList = new ReceiverList;
+      if(*list) {
+        *newList = **list;
+      }
+      newList->push_back(receiver);
+      std::atomic_store(list, ReceiverListPtr(newList));
+      count->store((int)newList->size());
+      if(!sync) {
+        element->numSampleQueues.store(countSampleQueues(*newList));
+      }
+      element->receiverLock->unlock();
+    }
+
+    int DataBroker::removeReceiver(DataElement *element, bool sync,
+                                   const ReceiverInterface *receiver) {
+      ReceiverListPtr *list = (sync ? &element->syncReceivers
+                               : &element->asyncReceivers);
+      std::atomic<int> *count = (sync ? &element->numSyncReceivers
+                                 : &element->numAsyncReceivers);
+      int cnt = 0;
+      element->receiverLock->lockForWrite();
+      if(*list) {
+        ReceiverList *newList = new ReceiverList;
+        ReceiverList::const_iterator it;
+        for(it = (*list)->begin(); it != (*list)->end(); ++it) {
+          if(it->receiver == receiver) {
+            ++cnt;
+          } else {
+            newList->push_back(*it);
+          }
+        }
+        count->store((int)newList->size());
+        if(!sync) {
+          element->numSampleQueues.store(countSampleQueues(*newList));
+        }
+        std::atomic_store(list, ReceiverListPtr(newList));
+      }
+      element->receiverLock->unlock();
+      return cnt;
+    }
+
+    void DataBroker::addConnection(DataElement *element,
+                                   const DataItemConnection &connection) {
+      element->receiverLock->lockForWrite();
+      ConnectionList *newList = new ConnectionList;
+      if(element->connections) {
+        *newList = *element->connections;
+      }
+      newList->push_back(connection);
+      setConnections(element, newList);
+      element->receiverLock->unlock();
+    }
+
+    void DataBroker::removeConnection(DataElement *element, size_t index) {
+      element->receiverLock->lockForWrite();
+      if(element->connections && index < element->connections->size()) {
+        ConnectionList *newList = new ConnectionList(*element->connections);
+        newList->erase(newList->begin() + index);
+        setConnections(element, newList);
+      }
+      element->receiverLock->unlock();
+    }
+
+    void DataBroker::setConnections(DataElement *element,
+                                    ConnectionList *connections) {
+      // compile the copy plan grouped by target in connection order
+      CopyPlan *plan = new CopyPlan;
+      ConnectionList::const_iterator connectionIt;
+      for(connectionIt = connections->begin();
+          connectionIt != connections->end(); ++connectionIt) {
+        if(connectionIt->fromDataItemIndex < 0 ||
+           connectionIt->toDataItemIndex < 0) {
+          continue;
+        }
+        CopyPlan::iterator targetIt;
+        for(targetIt = plan->begin(); targetIt != plan->end(); ++targetIt) {
+          if(targetIt->element == connectionIt->toElement) break;
+        }
+        if(targetIt == plan->end()) {
+          CopyTarget target;
+          target.element = connectionIt->toElement;
+          targetIt = plan->insert(plan->end(), target);
+        }
+        ItemCopy itemCopy = {connectionIt->fromDataItemIndex,
+                             connectionIt->toDataItemIndex};
+        targetIt->items.push_back(itemCopy);
+      }
+      std::atomic_store(&element->copyPlan, CopyPlanPtr(plan));
+      std::atomic_store(&element->connections, ConnectionListPtr(connections));
+      element->numConnections.store((int)connections->size());
+    }
+
     void DataBroker::publishDataElement(const DataElement *element)
     {
       // Inform receivers about new Stream.
@@ -1220,8 +2027,10 @@ namespace mars {
           registrationIt != pendingAsyncRegistrations.end(); ) {
         if(matchPattern(registrationIt->groupName, newGroupName) &&
            matchPattern(registrationIt->dataName, newDataName)) {
-          Receiver r = {registrationIt->receiver, registrationIt->callbackParam};
-          newElement->asyncReceivers.push_back(r);
+          Receiver r = {registrationIt->receiver, registrationIt->callbackParam,
+                        createMailbox(registrationIt->mode,
+                                      registrationIt->frequency)};
+          addReceiver(newElement, false, r);
           // if the registration has wildcards keep it in the pending list...
           if(hasWildcards(registrationIt->groupName) ||
              hasWildcards(registrationIt->dataName)) {
@@ -1240,8 +2049,9 @@ namespace mars {
           registrationIt != pendingSyncRegistrations.end(); ) {
         if(matchPattern(registrationIt->groupName, newGroupName) &&
            matchPattern(registrationIt->dataName, newDataName)) {
-          Receiver r = {registrationIt->receiver, registrationIt->callbackParam};
-          newElement->syncReceivers.push_back(r);
+          Receiver r = {registrationIt->receiver, registrationIt->callbackParam,
+                        AsyncMailboxPtr(), registrationIt->readFrontBuffer};
+          addReceiver(newElement, true, r);
           // if the registration has wildcards keep it in the pending list...
           if(hasWildcards(registrationIt->groupName) ||
              hasWildcards(registrationIt->dataName)) {
@@ -1266,9 +2076,8 @@ namespace mars {
             TimedReceiver r = { timedRegistrationIt->receiver,
                                 newElement,
                                 timedRegistrationIt->updatePeriod,
-                                timerIt->second.t,
-                                timedRegistrationIt->callbackParam };
-            timerIt->second.receivers.push_back(r);
+                                0, timedRegistrationIt->callbackParam, 0 };
+            addTimedReceiver(&timerIt->second, r);
             // if the registration has wildcards keep it in the pending list...
             if(!hasWildcards(timedRegistrationIt->groupName) &&
                !hasWildcards(timedRegistrationIt->dataName)) {
@@ -1295,7 +2104,9 @@ namespace mars {
             TriggeredReceiver r = { triggeredRegistrationIt->receiver,
                                     newElement,
                                     triggeredRegistrationIt->callbackParam };
+            triggerIt->second.lock->lockForWrite();
             triggerIt->second.receivers.push_back(r);
+            triggerIt->second.lock->unlock();
             // if the registration has no wildcards remove
             // it from the pending list
             if(!hasWildcards(triggeredRegistrationIt->groupName) &&
@@ -1376,7 +2187,7 @@ namespace mars {
         connection.toDataItemIndex = element->frontBuffer->getIndexByName(toItemName);
       }
 
-      connection.fromElement->connections.push_back(connection);
+      addConnection(connection.fromElement, connection);
     }
 
     void DataBroker::disconnectDataItems(const std::string &fromGroupName,
@@ -1386,7 +2197,8 @@ namespace mars {
                                          const std::string &toDataName,
                                          const std::string &toItemName) {
       std::map<std::pair<std::string, std::string>, DataElement*>::iterator elementIt;
-      std::list<DataItemConnection>::iterator jt;
+      ConnectionList::const_iterator jt;
+      ConnectionListPtr connections;
       // TODO: should we special case wildcards?
       DataElement *element;
 
@@ -1401,8 +2213,11 @@ namespace mars {
           return;
         }
         element = elementIt->second;
-        for(jt=element->connections.begin();
-            jt!=element->connections.end(); ++jt) {
+        connections = std::atomic_load(&element->connections);
+        if(!connections) {
+          return;
+        }
+        for(jt=connections->begin(); jt!=connections->end(); ++jt) {
           jt->toElement->bufferLock->lockForWrite();
           if(jt->toDataItemIndex >= (int)jt->toElement->frontBuffer->size()) {
             pushError("DataBroker::disconnectDataItems : connection index does not match!");
@@ -1412,7 +2227,7 @@ namespace mars {
                jt->toElement->info.dataName == toDataName &&
                (*jt->toElement->frontBuffer)[jt->toDataItemIndex].getName() == toItemName) {
               jt->toElement->bufferLock->unlock();
-              element->connections.erase(jt);
+              removeConnection(element, jt - connections->begin());
               break;
             }
           }
@@ -1424,13 +2239,16 @@ namespace mars {
     void DataBroker::disconnectDataItems(const std::string &toGroupName,
                                          const std::string &toDataName,
                                          const std::string &toItemName) {
-      std::map<unsigned long, DataElement*>::iterator it;
-      std::list<DataItemConnection>::iterator jt;
+      ConnectionList::const_iterator jt;
+      ConnectionListPtr connections;
 
       elementsLock.lockForWrite();
-      for(it=elementsById.begin(); it!=elementsById.end(); ++it) {
-        for(jt=it->second->connections.begin();
-            jt!=it->second->connections.end(); ++jt) {
+      for(unsigned long id = 1; id < next_id; ++id) {
+        DataElement *element = getElementById(id);
+        if(!element) continue;
+        connections = std::atomic_load(&element->connections);
+        if(!connections) continue;
+        for(jt=connections->begin(); jt!=connections->end(); ++jt) {
           jt->toElement->bufferLock->lockForWrite();
           if(jt->toDataItemIndex >= (int)jt->toElement->frontBuffer->size()) {
             pushError("DataBroker::disconnectDataItems : connection index does not match!");
@@ -1440,8 +2258,7 @@ namespace mars {
                jt->toElement->info.dataName == toDataName &&
                (*jt->toElement->frontBuffer)[jt->toDataItemIndex].getName() == toItemName) {
               jt->toElement->bufferLock->unlock();
-              it->second->connections.erase(jt);
-              //jt = it->second->connections.begin();
+              removeConnection(element, jt - connections->begin());
               break;
             }
           }
@@ -35,12 +35,16 @@
 #include <mars/utils/Mutex.h>
 #include <mars/utils/ReadWriteLock.h>
 #include <mars/utils/WaitCondition.h>
+#include <mars/utils/WorkerPool.h>
 
 #include <string>
 #include <vector>
 #include <list>
 #include <map>
 #include <set>
+#include <deque>
+#include <memory>
+#include <atomic>
 
 #include <pthread.h>
 
@@ -50,7 +54,9 @@ namespace mars {
 
     class ReceiverInterface;
     class ProducerInterface;
+    class ProduceJob;
     struct DataElement;
+    struct DeferredCallback;
 
     inline bool hasWildcards(const std::string &str) {
       return (str.find("*") != str.npos);
@@ -62,6 +68,9 @@ namespace mars {
       std::string groupName;
       std::string dataName;
       int callbackParam;
+      AsyncReceiverMode mode; ///< only for async registrations
+      double frequency;
+      bool readFrontBuffer; ///< only for sync registrations
     };
 
     struct PendingTimedProducer {
@@ -71,6 +80,7 @@ namespace mars {
       std::string timerName;
       int updatePeriod;
       int callbackParam;
+      bool onlyWithReceivers;
     };
 
     struct PendingTimedRegistration {
@@ -94,24 +104,33 @@ namespace mars {
       ReceiverInterface *receiver;
       DataElement *element;
       int updatePeriod;
-      long nextTriggerTime;
+      int64_t nextTriggerTime; ///< in ns
       int callbackParam;
+      unsigned long sequence; ///< registration order within the timer
     };
 
     struct TimedProducer {
       ProducerInterface *producer;
       DataElement *element;
       int updatePeriod;
-      long nextTriggerTime;
+      int64_t nextTriggerTime; ///< in ns
       int callbackParam;
+      unsigned long sequence; ///< registration order within the timer
+      bool onlyWithReceivers;
     };
 
+    /**
+     * The producers and receivers are kept as min-heaps on their
+     * nextTriggerTime so that stepping a timer only visits the due entries.
+     */
     struct Timer {
-      long t;
-      LockableContainer<std::list<TimedProducer> > producers;
-      LockableContainer<std::list<TimedReceiver> > receivers;
+      int64_t t; ///< in ns
+      std::vector<TimedProducer> producers;
+      std::vector<TimedReceiver> receivers;
+      unsigned long nextSequence;
       mars::utils::ReadWriteLock *lock;
       unsigned long timerElementId;
+      DataPackage timePackage;
     };
 
     struct TriggeredReceiver {
@@ -121,26 +140,131 @@ namespace mars {
     };
 
     struct Trigger {
-      LockableContainer<std::list<TriggeredReceiver> > receivers;
+      std::vector<TriggeredReceiver> receivers;
       mars::utils::ReadWriteLock *lock;
     };
 
+    /**
+     * State of one asynchronous registration for one element. Latest only
+     * receivers use the front buffer of the element as their single slot.
+     * Every sample receivers get a bounded queue that is filled by the
+     * producers and drained by the async thread.
+     */
+    struct AsyncMailbox {
+      AsyncMailbox() : mode(ASYNC_LATEST_ONLY), period(0), lastDelivery(0),
+                       waiting(false), dropped(0) {}
+      AsyncReceiverMode mode;
+      long long period; ///< minimal time between two deliveries in us
+      long long lastDelivery; ///< only used by the async thread
+      bool waiting; ///< a decimated update waits for its period to pass
+      mars::utils::Mutex queueMutex;
+      std::deque<DataPackage> queue;
+      unsigned long dropped;
+    };
+    typedef std::shared_ptr<AsyncMailbox> AsyncMailboxPtr;
+
     struct Receiver {
       ReceiverInterface *receiver;
       int callbackParam;
+      AsyncMailboxPtr mailbox; ///< only set for async receivers
+      /// sync receiver that reads the front buffer of timed producers
+      bool readFrontBuffer;
     };
 
+    /**
+     * Receiver and connection lists are never modified in place.
+     * (Un)registering builds a new list and swaps the shared pointer, so the
+     * push path only has to grab the current snapshot and can iterate it
+     * without holding any lock.
+     */
+    typedef std::vector<Receiver> ReceiverList;
+    typedef std::shared_ptr<const ReceiverList> ReceiverListPtr;
+    typedef std::vector<DataItemConnection> ConnectionList;
+    typedef std::shared_ptr<const ConnectionList> ConnectionListPtr;
+
+    /**
+     * The connections of an element are compiled into a copy plan that
+     * groups the item copies by target element. A push then copies all
+     * connected items of a target at once and pushes each target only once.
+     */
+    struct ItemCopy {
+      long fromIndex, toIndex;
+    };
+
+    struct CopyTarget {
+      DataElement *element;
+      std::vector<ItemCopy> items;
+    };
+
+    typedef std::vector<CopyTarget> CopyPlan;
+    typedef std::shared_ptr<const CopyPlan> CopyPlanPtr;
+
     struct DataElement {
+      DataElement() : backBuffer(NULL), frontBuffer(NULL),
+                      bufferLock(NULL), receiverLock(NULL),
+                      lastProducer(NULL), numSyncReceivers(0),
+                      numAsyncReceivers(0), numConnections(0),
+                      numTimedReceivers(0), numTriggeredReceivers(0),
+                      numSampleQueues(0),
+                      updatePending(false), nextUpdated(NULL),
+                      updateTime(0), pushCount(0), bytesCopied(0),
+                      lastPushCount(0), lastBytesCopied(0),
+                      pushRate(0.), bytesPerSecond(0.) {}
       DataInfo info;
-      //    bool updated;
       DataPackage *backBuffer;
       DataPackage *frontBuffer;
-      LockableContainer<std::list<Receiver> > syncReceivers;
-      LockableContainer<std::list<Receiver> > asyncReceivers;
+      ReceiverListPtr syncReceivers;
+      ReceiverListPtr asyncReceivers;
+      ConnectionListPtr connections;
+      CopyPlanPtr copyPlan; ///< compiled from connections
       mars::utils::ReadWriteLock *bufferLock;
+      /// serializes writers of the receiver and connection snapshots
       mars::utils::ReadWriteLock *receiverLock;
       const ReceiverInterface *lastProducer;
-      std::list<DataItemConnection> connections;
+      // sizes of the current snapshots for the lock free fast path
+      std::atomic<int> numSyncReceivers;
+      std::atomic<int> numAsyncReceivers;
+      std::atomic<int> numConnections;
+      std::atomic<int> numTimedReceivers;
+      std::atomic<int> numTriggeredReceivers;
+      /// async receivers in ASYNC_EVERY_SAMPLE mode
+      std::atomic<int> numSampleQueues;
+      // dirty flag and link for the updated elements queue
+      std::atomic<bool> updatePending;
+      DataElement *nextUpdated;
+      long long updateTime; ///< time in us when the element was queued
+      // statistics, only counted while they are enabled
+      std::atomic<unsigned long> pushCount;
+      std::atomic<unsigned long long> bytesCopied;
+      // rates of the last second, guarded by the statsMutex
+      unsigned long lastPushCount;
+      unsigned long long lastBytesCopied;
+      double pushRate, bytesPerSecond;
+    };
+
+    /**
+     * Callback times are collected in power of two buckets of nanoseconds
+     * which is precise enough for p50/p99 and has a fixed size.
+     */
+    struct CallbackHistogram {
+      static const int NUM_BUCKETS = 40;
+      CallbackHistogram() : samples(0), maxTime(0) {
+        for(int i = 0; i < NUM_BUCKETS; ++i) buckets[i] = 0;
+      }
+      unsigned long buckets[NUM_BUCKETS];
+      unsigned long samples;
+      long long maxTime; ///< in ns
+    };
+
+    struct CallbackKey {
+      unsigned long dataId;
+      const ReceiverInterface *receiver;
+      ReceiverKind kind;
+      bool operator<(const CallbackKey &other) const {
+        if(dataId != other.dataId) return dataId < other.dataId;
+        if(receiver != other.receiver) return receiver < other.receiver;
+        return kind < other.kind;
+      }
     };
     /// \endcond
 
@@ -154,12 +278,18 @@ namespace mars {
       DataBroker(lib_manager::LibManager *theManager);
       virtual ~DataBroker();
 
-      bool createTimer(const std::string &timerName);
+      TimerHandle createTimer(const std::string &timerName);
+      TimerHandle getTimer(const std::string &timerName) const;
       /**
        * @return true if the timer was stepped.
        *         false if no timer with the given name exists.
        */
       bool stepTimer(const std::string &timerName, long step=1);
+      bool stepTimer(TimerHandle timer, long step=1);
+      bool stepTimerNs(TimerHandle timer, int64_t stepNs);
+      std::vector<std::string> getTimerNames() const;
+      int64_t getTimerTimeNs(TimerHandle timer) const;
+      bool setTimerTimeNs(TimerHandle timer, int64_t timeNs);
       bool registerTimedReceiver(ReceiverInterface *receiver,
                                  const std::string &groupName,
                                  const std::string &dataName,
@@ -175,14 +305,17 @@ namespace mars {
                                  const std::string &dataName,
                                  const std::string &timerName,
                                  int updatePeriod,
-                                 int callbackParam=0);
+                                 int callbackParam=0,
+                                 bool onlyWithReceivers=false);
       bool unregisterTimedProducer(ProducerInterface *producer,
                                    const std::string &groupName,
                                    const std::string &dataName,
                                    const std::string &timerName);
 
-      bool createTrigger(const std::string &triggerName);
+      TriggerHandle createTrigger(const std::string &triggerName);
+      TriggerHandle getTrigger(const std::string &triggerName) const;
       bool trigger(const std::string &triggerName);
+      bool trigger(TriggerHandle trigger);
       bool registerTriggeredReceiver(ReceiverInterface *receiver,
                                      const std::string &groupName,
                                      const std::string &dataName,
@@ -196,7 +329,8 @@ namespace mars {
       bool registerSyncReceiver(ReceiverInterface *receiver,
                                 const std::string &groupName,
                                 const std::string &dataName,
-                                int callbackParam=0);
+                                int callbackParam=0,
+                                bool readFrontBuffer=false);
       bool unregisterSyncReceiver(ReceiverInterface *receiver,
                                   const std::string &groupName,
                                   const std::string &dataName);
@@ -205,6 +339,12 @@ namespace mars {
                                  const std::string &groupName,
                                  const std::string &dataName,
                                  int callbackParam=0);
+      bool registerAsyncReceiver(ReceiverInterface *receiver,
+                                 const std::string &groupName,
+                                 const std::string &dataName,
+                                 int callbackParam,
+                                 AsyncReceiverMode mode,
+                                 double frequency=0.);
       bool unregisterAsyncReceiver(ReceiverInterface *receiver,
                                    const std::string &groupName,
                                    const std::string &dataName);
@@ -224,9 +364,16 @@ namespace mars {
       const DataInfo getDataInfo(const std::string &groupName,
                                  const std::string &dataName) const;
       const DataPackage getDataPackage(unsigned long id) const;
+      bool hasReceivers(unsigned long dataId) const;
 
       const std::vector<DataInfo> getDataList(PackageFlag flag) const;
 
+      void setAsyncInterval(double milliseconds);
+      void setProducerThreads(int numThreads);
+
+      void setStatisticsEnabled(bool enabled, unsigned int sampleInterval=16);
+      std::vector<DataElementStatistics> getStatistics() const;
+
     
       void connectDataItems(const std::string &fromGroupName,
                             const std::string &fromDataName,
@@ -281,6 +428,57 @@ namespace mars {
       //void destroyLock(pthread_cond_t *cond);
       DataElement *getElement(const std::string &groupName,
                               const std::string &dataName) const;
+      DataElement *getElementById(unsigned long id) const;
+      void insertElementById(DataElement *element);
+
+      void addReceiver(DataElement *element, bool sync,
+                       const Receiver &receiver);
+      int removeReceiver(DataElement *element, bool sync,
+                         const ReceiverInterface *receiver);
+      void addConnection(DataElement *element,
+                         const DataItemConnection &connection);
+      void removeConnection(DataElement *element, size_t index);
+      void setConnections(DataElement *element, ConnectionList *connections);
+
+      /**
+       * Delivers a DataPackage that is already in the frontBuffer of the
+       * element to the async and sync receivers and the connected elements.
+       */
+      void distributeData(DataElement *element, const DataPackage &package,
+                          const ReceiverInterface *producer, bool timed);
+      /// copies the package into the queues of the every sample receivers
+      void queueSamples(DataElement *element, const DataPackage &package,
+                        const ReceiverInterface *producer);
+      /// applies the copy plan of element and pushes the connected elements
+      void pushConnections(DataElement *element, const DataPackage &package);
+      /// counts a push for the statistics, returns whether it is measured
+      bool countPush(DataElement *element);
+
+      /**
+       * Queues the element for the asynchronous receivers. Each element is
+       * at most once in the queue which is guarded by its updatePending flag.
+       */
+      void markUpdated(DataElement *element);
+      void addTimedReceiver(Timer *timer, TimedReceiver receiver);
+      void addTimedProducer(Timer *timer, TimedProducer producer);
+      /// runs one due producer and notes what has to be delivered later
+      void callProducer(const TimedProducer &producer,
+                        DeferredCallback *deferred);
+      void startAsyncThread();
+      void publishAsyncStats(long long now);
+
+      /**
+       * Decides whether the current callback is timed. Each thread draws
+       * from its own random sequence, so no receiver is systematically
+       * skipped by the sampling.
+       */
+      bool sampleCallback() const;
+      void countCopy(DataElement *element, const DataPackage &package);
+      void deliverData(ReceiverInterface *receiver, const DataInfo &info,
+                       const DataPackage &package, int callbackParam,
+                       ReceiverKind kind, bool timed);
+      unsigned long getIdCount() const;
+      void publishStatistics(long long now);
 
       /**
        * Get all DataElements that match groupName and dataName.
@@ -291,13 +489,31 @@ namespace mars {
                              const std::string &dataName,
                              std::vector<DataElement*> *elements) const;
 
-      std::set<DataElement*> *updatedElementsBackBuffer;
-      std::set<DataElement*> *updatedElementsFrontBuffer;
+      // lock free multi-producer queue of elements with pending async
+      // callbacks. Producers push onto the head, run() takes the whole list.
+      std::atomic<DataElement*> updatedElements;
+      bool threadSleeping;
+      bool asyncThreadStarted;
+      std::atomic<long long> asyncInterval; ///< in us
+
+      // statistics of the async thread published on asyncStats
+      unsigned long asyncStatsId;
+      long long statsStartTime;
+      unsigned long statsPasses, statsCallbacks, statsMaxQueueDepth;
+      double statsLatencySum, statsMaxLatency;
+
+      // per stream statistics, see setStatisticsEnabled()
+      std::atomic<bool> statisticsEnabled;
+      std::atomic<unsigned int> statisticsInterval;
+      std::atomic<long long> statisticsPublishTime; ///< in us
+      unsigned long statisticsId;
+      std::map<CallbackKey, CallbackHistogram> callbackHistograms;
+      mutable mars::utils::Mutex statsMutex;
 
       unsigned long next_id;
       pthread_t theThread;
       pthread_t realtimeThread;
-      mars::utils::Mutex idMutex;
+      mutable mars::utils::Mutex idMutex;
       mars::utils::Mutex realtimeMutex;
       bool thread_running, stop_thread;
       bool realtimeThreadRunning, stopRealtimeThread;
@@ -308,20 +524,30 @@ namespace mars {
       LockableContainer<std::list<PendingTimedProducer> > pendingTimedProducers;
       LockableContainer<std::list<PendingTimedRegistration> > pendingTimedRegistrations;
       std::list<PendingTriggeredRegistration> pendingTriggeredRegistrations;
-      std::map<unsigned long, DataElement*> elementsById;
+      // elements indexed by their dataId in fixed size chunks, so that
+      // lookups never need a lock and pointers stay valid while growing
+      static const unsigned long ELEMENT_CHUNK_BITS = 8;
+      static const unsigned long ELEMENT_CHUNK_SIZE = 1 << ELEMENT_CHUNK_BITS;
+      static const unsigned long ELEMENT_MAX_CHUNKS = 4096;
+      std::atomic<std::atomic<DataElement*>*> elementChunks[ELEMENT_MAX_CHUNKS];
       std::map<std::string, Trigger> triggers;
       std::map<std::pair<std::string, std::string>, DataElement*> elementsByName;
       mutable mars::utils::ReadWriteLock elementsLock;
-      mars::utils::ReadWriteLock timersLock;
-      mars::utils::ReadWriteLock triggersLock;
-      mars::utils::Mutex updatedElementsLock;
+      mutable mars::utils::ReadWriteLock timersLock;
+      mutable mars::utils::ReadWriteLock triggersLock;
       mars::utils::Mutex pendingRegistrationLock;
 
       mars::utils::WaitCondition wakeupCondition;
       mars::utils::Mutex wakeupMutex;
       std::map<std::string, Timer> timers;
+      TimerHandle realtimeTimer;
       unsigned long newStreamId;
       unsigned long pushMessageIds[__DB_MESSAGE_TYPE_COUNT];
+      /// runs the timed producers concurrently, NULL runs them serially
+      mars::utils::WorkerPool *producerPool;
+      mars::utils::ReadWriteLock producerPoolLock;
+
+      friend class ProduceJob;
     }; // end of class definition DataBroker
 
   } // end of namespace data_broker
@@ -76,10 +76,12 @@
 
 #include "DataPackage.h"
 #include "DataInfo.h"
+#include "DataStatistics.h"
 
 #include <lib_manager/LibInterface.hpp>
 
 #include <cstdarg>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -90,6 +92,23 @@ namespace mars {
 
     class ReceiverInterface;
     class ProducerInterface;
+    struct Timer;
+    struct Trigger;
+
+    /**
+     * \brief opaque handle of a timer returned by
+     *        \ref DataBrokerInterface::createTimer "createTimer"
+     *
+     * A handle stays valid for the lifetime of the DataBroker. Stepping a
+     * timer by its handle avoids the name lookup.
+     */
+    typedef Timer* TimerHandle;
+
+    /**
+     * \brief opaque handle of a trigger returned by
+     *        \ref DataBrokerInterface::createTrigger "createTrigger"
+     */
+    typedef Trigger* TriggerHandle;
 
     enum MessageType {
       DB_MESSAGE_TYPE_FATAL,
@@ -101,6 +120,22 @@ namespace mars {
       __DB_MESSAGE_TYPE_COUNT
     };
 
+    /**
+     * \brief delivery modes of asynchronous receivers
+     * \see DataBrokerInterface::registerAsyncReceiver
+     */
+    enum AsyncReceiverMode {
+      /** \brief only the latest DataPackage of a stream is delivered (default)
+       */
+      ASYNC_LATEST_ONLY,
+      /** \brief every pushed DataPackage is queued and delivered */
+      ASYNC_EVERY_SAMPLE,
+      /** \brief the latest DataPackage is delivered with at most the given
+       *         frequency
+       */
+      ASYNC_DECIMATE
+    };
+
     /** \brief The interface every DataBroker should implement. */
     class DataBrokerInterface : public lib_manager::LibInterface {
 
@@ -123,12 +158,19 @@ namespace mars {
       /**
        * \brief creates a new timer with the given name
        * \param timerName the name of the new timer
-       * \returns \c false if a timer with the given name already exists. 
-       *          \c true otherwise.
+       * \returns The handle of the timer, or \c NULL if a timer with the
+       *          given name already exists. Use \ref getTimer to get the
+       *          handle of an existing timer.
        * \see stepTimer, registerTimedReceiver, unregisterTimedReceiver, 
        *      ReceiverInterface
        */
-      virtual bool createTimer(const std::string &timerName) = 0;
+      virtual TimerHandle createTimer(const std::string &timerName) = 0;
+
+      /**
+       * \brief returns the handle of the timer \a timerName or \c NULL if
+       *        no such timer exists.
+       */
+      virtual TimerHandle getTimer(const std::string &timerName) const = 0;
 
       /**
        * \brief advances the timer timerName by step
@@ -151,6 +193,56 @@ namespace mars {
        */
       virtual bool stepTimer(const std::string &timerName, long step=1) = 0;
 
+      /**
+       * \brief advances the timer by step
+       * \param timer The handle returned by \ref createTimer.
+       * \param step The amount by which the timer should be stepped.
+       * \return \c true if the timer was stepped.
+       *         \c false if \a timer is \c NULL.
+       *
+       * Same as \ref stepTimer(const std::string&, long) without the lookup
+       * of the timer by its name. Producers and receivers that are due in
+       * the same step are called in the order of their registration.
+       */
+      virtual bool stepTimer(TimerHandle timer, long step=1) = 0;
+
+      /**
+       * \brief advances the timer by a fraction of a step
+       * \param timer The handle returned by \ref createTimer.
+       * \param stepNs The amount in millionths of a step. For the timers of
+       *               MARS, which count milliseconds, this is nanoseconds.
+       * \return \c true if the timer was stepped.
+       *         \c false if \a timer is \c NULL.
+       *
+       * Timers keep their time in these fractions, so steps below one
+       * do not get lost. Update periods are still given in whole steps,
+       * see registerTimedReceiver().
+       * The time package of the timer contains the time in whole steps
+       * as "t" and including the fraction as double "tf".
+       */
+      virtual bool stepTimerNs(TimerHandle timer, int64_t stepNs) = 0;
+
+      /** \brief returns the names of all timers */
+      virtual std::vector<std::string> getTimerNames() const = 0;
+
+      /**
+       * \brief returns the time of the timer in millionths of a step or 0
+       *        if \a timer is \c NULL.
+       */
+      virtual int64_t getTimerTimeNs(TimerHandle timer) const = 0;
+
+      /**
+       * \brief sets the time of the timer without calling anyone
+       * \param timer The handle returned by \ref createTimer.
+       * \param timeNs The new time in millionths of a step.
+       * \return \c false if \a timer is \c NULL.
+       *
+       * The time until the next call of every registered producer and
+       * receiver is kept. This is used to restore a timer from a
+       * checkpoint.
+       */
+      virtual bool setTimerTimeNs(TimerHandle timer, int64_t timeNs) = 0;
+
       /**
        * \brief registers a receiver for a group/data with a timer
        * \param receiver The ReceiverInterface that should be called back.
@@ -164,6 +256,14 @@ namespace mars {
        *                     callbacks. If you pass 0 the \a receiver will be 
        *                     called back every time the timer is 
        *                     \ref stepTimer "stepped".
+       *
+       * The period is a deliberate limitation to whole steps, i.e. whole
+       * milliseconds for the timers of MARS, like the "rate" of the sensor
+       * configurations. The due times are kept in nanoseconds, so with
+       * \ref stepTimerNs "sub-step" stepping a period of one or more steps
+       * is met exactly, e.g. every fourth call for 0.25 ms. Periods that
+       * are not whole steps, e.g. 0.5 ms, can't be expressed; use 0 to be
+       * called on every stepTimerNs() instead.
        * \param callbackParam An optional \c int that will be passed back to 
        *                      the \a receiver in 
        *                      \ref ReceiverInterface::receiveData "receiveData".
@@ -211,14 +311,25 @@ namespace mars {
                                            const std::string &timerName) = 0;
 
       /**
-       * \todo 
+       * \brief registers a producer that is asked for new data every
+       *        \a updatePeriod steps of the timer
+       *
+       * The \a updatePeriod is given in whole steps like for
+       * registerTimedReceiver(), which describes the limitation for
+       * sub-step stepping.
+       *
+       * If \a onlyWithReceivers is set, the producer is not called while
+       * the data element has no receivers or connected items, see
+       * hasReceivers(). Readers that only poll getDataPackage get the
+       * data of the last call then.
        */
       virtual bool registerTimedProducer(ProducerInterface *producer,
                                          const std::string &groupName,
                                          const std::string &dataName,
                                          const std::string &timerName,
                                          int updatePeriod,
-                                         int callbackParam=0) = 0;
+                                         int callbackParam=0,
+                                         bool onlyWithReceivers=false) = 0;
 
       /**
        * \todo
@@ -232,12 +343,19 @@ namespace mars {
       /**
        * \brief create a new trigger with the given name
        * \param triggerName the name of the new trigger
-       * \returns \c false if a trigger with the given name already exists. 
-       *          \c true otherwise.
+       * \returns The handle of the trigger, or \c NULL if a trigger with
+       *          the given name already exists. Use \ref getTrigger to get
+       *          the handle of an existing trigger.
        * \see trigger, registerTriggeredReceiver, unregisterTriggeredReceiver, 
        *      ReceiverInterface
        */
-      virtual bool createTrigger(const std::string &triggerName) = 0;
+      virtual TriggerHandle createTrigger(const std::string &triggerName) = 0;
+
+      /**
+       * \brief returns the handle of the trigger \a triggerName or \c NULL
+       *        if no such trigger exists.
+       */
+      virtual TriggerHandle getTrigger(const std::string &triggerName) const = 0;
 
 
       /**
@@ -256,6 +374,14 @@ namespace mars {
        */
       virtual bool trigger(const std::string &triggerName) = 0;
 
+      /**
+       * \brief triggers the trigger with the given handle
+       * \param trigger The handle returned by \ref createTrigger.
+       * \return \c true if the trigger was triggered.
+       *         \c false if \a trigger is \c NULL.
+       */
+      virtual bool trigger(TriggerHandle trigger) = 0;
+
       /**
        * \brief registers a receiver for a group/data with a trigger
        * \param receiver The ReceiverInterface that should be called back.
@@ -328,6 +454,13 @@ namespace mars {
        *                      \ref ReceiverInterface::receiveData "receiveData".
        *                      This can be used by the \a receiver to distinguish
        *                      callbacks from different registrations.
+       * \param readFrontBuffer If \c true the \a receiver is called with
+       *                        the front buffer of streams of timed
+       *                        producers under its shared lock instead of
+       *                        a copy of the DataPackage. Such a receiver
+       *                        must neither push into the same stream nor
+       *                        call getDataPackage() for it from the
+       *                        callback.
        * \return \c true if the registration was successful.
        *         \c false if no DataPackage with the given \a groupName and 
        *         \a dataName exists. This doesn't necessarily indicate an error.
@@ -350,7 +483,8 @@ namespace mars {
       virtual bool registerSyncReceiver(ReceiverInterface *receiver,
                                         const std::string &groupName,
                                         const std::string &dataName,
-                                        int callbackParam=0) = 0;
+                                        int callbackParam=0,
+                                        bool readFrontBuffer=false) = 0;
 
       /**
        * \brief unregister a receiver from receiving callbacks for certain 
@@ -412,6 +546,38 @@ namespace mars {
                                          const std::string &dataName,
                                          int callbackParam=0) = 0;
 
+      /**
+       * \brief register a receiver to receive asynchronous callbacks in the
+       *        given mode
+       * \param mode
+       *   - \ref ASYNC_LATEST_ONLY "ASYNC_LATEST_ONLY": like
+       *     registerAsyncReceiver(ReceiverInterface*, const std::string&, const std::string&, int).
+       *     The stream itself is the single slot of the receiver. Pushes
+       *     between two deliveries only overwrite it.
+       *   - \ref ASYNC_EVERY_SAMPLE "ASYNC_EVERY_SAMPLE": every pushed
+       *     DataPackage is copied into a queue of the receiver and delivered
+       *     in order. If the receiver falls behind by more than 1024
+       *     packages the oldest ones are dropped, so a slow receiver never
+       *     slows down the producer.
+       *   - \ref ASYNC_DECIMATE "ASYNC_DECIMATE": like latest only but the
+       *     receiver is called at most \a frequency times per second. An
+       *     update within that period is delivered when the period has
+       *     passed.
+       * \param frequency The maximal callback frequency in Hz for
+       *                  \ref ASYNC_DECIMATE "ASYNC_DECIMATE".
+       *
+       * The other parameters are the same as in
+       * registerAsyncReceiver(ReceiverInterface*, const std::string&, const std::string&, int).
+       * The mode is kept per stream, so a wildcard registration decimates
+       * every matching stream on its own.
+       */
+      virtual bool registerAsyncReceiver(ReceiverInterface *receiver,
+                                         const std::string &groupName,
+                                         const std::string &dataName,
+                                         int callbackParam,
+                                         AsyncReceiverMode mode,
+                                         double frequency=0.) = 0;
+
       /**
        * \brief unregister a receiver from receiving callbacks for certain 
        *        group/data
@@ -524,6 +690,15 @@ namespace mars {
        * \return A copy of the DataPackage with the given \a dataId.
        */
       virtual const DataPackage getDataPackage(unsigned long dataId) const = 0;
+
+      /**
+       * \brief tells a producer whether its data is used
+       * \param dataId The unique DataInfo::dataId of the DataPackage.
+       * \return \c true if the DataPackage has sync, async, timed or
+       *         triggered receivers or connected items. This is cheap
+       *         enough to be called every step.
+       */
+      virtual bool hasReceivers(unsigned long dataId) const = 0;
     
       /**
        * \brief get a list of all DataInfo items currently in the DataBroker
@@ -532,6 +707,70 @@ namespace mars {
        */
       virtual const std::vector<DataInfo> getDataList(PackageFlag flag=DATA_PACKAGE_NO_FLAG) const = 0;
 
+      /**
+       * \brief sets the minimum time between two delivery passes for
+       *        the asynchronous receivers
+       * \param milliseconds The asynchronous thread wakes up as soon as data
+       *                     is pushed, but not earlier than \a milliseconds
+       *                     after its last pass. Pushes within this interval
+       *                     are batched and only the latest DataPackage of
+       *                     each stream is delivered. \c 0 delivers without
+       *                     any delay. The default is 10 ms.
+       *
+       * The achieved queue depth and delivery latency are published on the
+       * stream "data_broker"/"asyncStats" once per second.
+       * \see registerAsyncReceiver
+       */
+      virtual void setAsyncInterval(double milliseconds) = 0;
+
+      /**
+       * \brief sets the number of worker threads that run the timed
+       *        producers of a timer step
+       * \param numThreads \c 0 (the default) calls all producers serially
+       *                   in the thread that steps the timer.
+       *
+       * Ordering guarantees of stepTimer():
+       *  - All due producers have finished before the timer time is pushed
+       *    and before any timed receiver, sync receiver, or connection of
+       *    this step is called.
+       *  - Producers of the same stream are called one after another in
+       *    registration order. With worker threads the producers of
+       *    different streams run concurrently and in any order, so a
+       *    ProducerInterface::produceData must only touch its own state.
+       *  - Sync receivers of the produced streams are called in the
+       *    thread that steps the timer in registration order of the
+       *    producers. They get a copy of the DataPackage taken right after
+       *    its producer, unless they were registered with
+       *    \a readFrontBuffer.
+       */
+      virtual void setProducerThreads(int numThreads) = 0;
+
+      /**
+       * \brief enables or disables the per stream statistics
+       * \param enabled While disabled the only overhead on the push path is
+       *                a single atomic load.
+       * \param sampleInterval Only every \a sampleInterval-th push of a
+       *                       stream and every \a sampleInterval-th callback
+       *                       of a receiver is timed and sized. The counts
+       *                       are extrapolated from these samples.
+       *
+       * While enabled the statistics are published once per second on the
+       * stream "data_broker"/"stats".
+       * \see getStatistics
+       */
+      virtual void setStatisticsEnabled(bool enabled,
+                                        unsigned int sampleInterval=16) = 0;
+
+      /**
+       * \brief returns a snapshot of the statistics of all streams that
+       *        were pushed or have receivers
+       *
+       * The returned values are collected since the last call of
+       * setStatisticsEnabled(true). The rates refer to the last completed
+       * second.
+       */
+      virtual std::vector<DataElementStatistics> getStatistics() const = 0;
+
       virtual void connectDataItems(const std::string &fromGroupName,
                                     const std::string &fromDataName,
                                     const std::string &fromItemName,
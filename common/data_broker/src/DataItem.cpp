@@ -50,6 +50,19 @@ namespace mars {
       return *this;
     }
 
+    void DataItem::copyValue(const DataItem &other) {
+      if(this == &other) {
+        return;
+      }
+      if (other.type == STRING_TYPE) {
+        this->s = other.s.c_str();
+      } else {
+        this->l = other.l;
+        this->d = other.d;
+      }
+      this->type = other.type;
+    }
+
     ////////////////////////////////////
     // Getter Methods
     ////////////////////////////////////
@@ -81,6 +81,12 @@ namespace mars {
       std::string getName() const;
       void setName(const std::string &newName);
 
+      /**
+       * \brief copies the type and value of \a other but keeps the name
+       *        of this DataItem
+       */
+      void copyValue(const DataItem &other);
+
       /**
        * \brief tries to retrieve the value from this DataItem
        * \param val A pointer to a variable where the value can be written to.
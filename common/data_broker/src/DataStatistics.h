@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DATASTATISTICS_H
+#define DATASTATISTICS_H
+
+#ifdef _PRINT_HEADER_
+  #warning "DataStatistics.h"
+#endif
+
+#include "DataInfo.h"
+
+#include <string>
+#include <vector>
+
+namespace mars {
+
+  namespace data_broker {
+
+    class ReceiverInterface;
+
+    /**
+     * \brief the way a receiver is registered at a DataBroker stream
+     */
+    enum ReceiverKind {
+      RECEIVER_KIND_SYNC,
+      RECEIVER_KIND_ASYNC,
+      RECEIVER_KIND_TIMED,
+      RECEIVER_KIND_TRIGGERED
+    };
+
+    /** \brief callback timing of one receiver of a stream */
+    struct ReceiverStatistics {
+      const ReceiverInterface *receiver;
+      ReceiverKind kind;
+      /** \brief number of timed callbacks since the statistics were enabled
+       */
+      unsigned long samples;
+      double p50; ///< median callback time in microseconds
+      double p99; ///< 99th percentile of the callback time in microseconds
+      double max; ///< longest sampled callback time in microseconds
+    };
+
+    /** \brief activity of a single DataBroker stream */
+    struct DataElementStatistics {
+      DataInfo info;
+      /** \brief pushes since the statistics were enabled */
+      unsigned long pushCount;
+      /** \brief pushes per second measured over the last second */
+      double pushRate;
+      /** \brief estimated bytes of DataPackages copied by the DataBroker
+       *         since the statistics were enabled
+       */
+      unsigned long long bytesCopied;
+      /** \brief estimated copied bytes per second over the last second */
+      double bytesPerSecond;
+      int numSyncReceivers;
+      int numAsyncReceivers;
+      int numTimedReceivers;
+      int numTriggeredReceivers;
+      std::vector<ReceiverStatistics> receivers;
+    };
+
+  } // end of namespace data_broker
+
+} // end of namespace mars
+
+#endif // DATASTATISTICS_H
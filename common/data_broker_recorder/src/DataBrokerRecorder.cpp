@@ -0,0 +1,255 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DataBrokerRecorder.h"
+
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    using namespace mars::data_broker;
+
+    DataBrokerRecorder::DataBrokerRecorder(lib_manager::LibManager *theManager)
+      : lib_manager::LibInterface(theManager), dataBroker(NULL), cfg(NULL),
+        replayer(NULL), recordBuffer(&buffers[0]), numStreams(0),
+        startTime(0), recording(false), writerRunning(false) {
+
+      dataBroker = theManager->getLibraryAs<DataBrokerInterface>("data_broker");
+      if(!dataBroker) {
+        fprintf(stderr, "DataBrokerRecorder: could not get DataBroker!\n");
+      }
+      replayer = new DataBrokerReplayer(dataBroker);
+
+      cfgRecord.bValue = false;
+      cfgRecordFile.sValue = "databroker.rec";
+      cfgChunkSize.iValue = 4;
+      cfgFlushInterval.iValue = 20;
+      cfgReplay.bValue = false;
+      cfgReplaySpeed.dValue = 1.0;
+      cfgReplayLoop.bValue = false;
+
+      cfg = theManager->getLibraryAs<cfg_manager::CFGManagerInterface>("cfg_manager");
+      if(cfg) {
+        cfgRecordFile = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                 "record file",
+                                                 cfgRecordFile.sValue, this);
+        cfgChunkSize = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                "chunk size MB",
+                                                cfgChunkSize.iValue, this);
+        cfgFlushInterval = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                    "flush interval ms",
+                                                    cfgFlushInterval.iValue,
+                                                    this);
+        cfgReplayFile = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                 "replay file",
+                                                 std::string(""), this);
+        cfgReplaySpeed = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                  "replay speed",
+                                                  cfgReplaySpeed.dValue, this);
+        cfgReplayLoop = cfg->getOrCreateProperty("DataBrokerRecorder",
+                                                 "replay loop",
+                                                 cfgReplayLoop.bValue, this);
+        cfgRecord = cfg->getOrCreateProperty("DataBrokerRecorder", "record",
+                                             false, this);
+        cfgReplay = cfg->getOrCreateProperty("DataBrokerRecorder", "replay",
+                                             false, this);
+        if(cfgRecord.bValue) {
+          startRecording(cfgRecordFile.sValue);
+        }
+        if(cfgReplay.bValue) {
+          startReplay(cfgReplayFile.sValue, cfgReplaySpeed.dValue,
+                      cfgReplayLoop.bValue);
+        }
+      }
+    }
+
+    DataBrokerRecorder::~DataBrokerRecorder() {
+      stopRecording();
+      stopReplay();
+      delete replayer;
+      if(cfg) {
+        cfg->unregisterFromParam(cfgRecord.paramId, this);
+        cfg->unregisterFromParam(cfgRecordFile.paramId, this);
+        cfg->unregisterFromParam(cfgChunkSize.paramId, this);
+        cfg->unregisterFromParam(cfgFlushInterval.paramId, this);
+        cfg->unregisterFromParam(cfgReplay.paramId, this);
+        cfg->unregisterFromParam(cfgReplayFile.paramId, this);
+        cfg->unregisterFromParam(cfgReplaySpeed.paramId, this);
+        cfg->unregisterFromParam(cfgReplayLoop.paramId, this);
+        libManager->releaseLibrary("cfg_manager");
+      }
+      if(dataBroker) libManager->releaseLibrary("data_broker");
+    }
+
+    bool DataBrokerRecorder::startRecording(const std::string &filename) {
+      if(!dataBroker) return false;
+      stopRecording();
+      if(!writer.open(filename, (size_t)cfgChunkSize.iValue << 20)) {
+        return false;
+      }
+      bufferMutex.lock();
+      streams.clear();
+      numStreams = 0;
+      buffers[0].clear();
+      buffers[1].clear();
+      recordBuffer = &buffers[0];
+      startTime = utils::getTimeNs();
+      recording = true;
+      bufferMutex.unlock();
+      writerRunning = true;
+      start();
+      dataBroker->registerSyncReceiver(this, "*", "*");
+      fprintf(stderr, "DataBrokerRecorder: recording to \"%s\"\n",
+              filename.c_str());
+      return true;
+    }
+
+    void DataBrokerRecorder::stopRecording() {
+      if(!writerRunning) return;
+      dataBroker->unregisterSyncReceiver(this, "*", "*");
+      bufferMutex.lock();
+      recording = false;
+      bufferMutex.unlock();
+      // the writer thread flushes the remaining records and closes the file
+      wait();
+      writerRunning = false;
+    }
+
+    bool DataBrokerRecorder::isRecording() const {
+      utils::MutexLocker locker(&bufferMutex);
+      return recording;
+    }
+
+    bool DataBrokerRecorder::startReplay(const std::string &filename,
+                                         double speed, bool loop) {
+      return replayer->play(filename, speed, loop);
+    }
+
+    void DataBrokerRecorder::stopReplay() {
+      replayer->stop();
+    }
+
+    void DataBrokerRecorder::receiveData(const DataInfo &info,
+                                         const DataPackage &package,
+                                         int callbackParam) {
+      int64_t time = utils::getTimeNs();
+      utils::MutexLocker locker(&bufferMutex);
+      if(!recording) return;
+      time -= startTime;
+
+      if(info.dataId >= streams.size()) {
+        StreamState unknown;
+        unknown.index = STREAM_UNKNOWN;
+        streams.resize(info.dataId + 1, unknown);
+      }
+      StreamState &stream = streams[info.dataId];
+      if(stream.index == STREAM_IGNORED) return;
+      if(stream.index == STREAM_UNKNOWN) {
+        if(info.groupName == "data_broker") {
+          stream.index = STREAM_IGNORED;
+          return;
+        }
+        stream.index = numStreams++;
+      }
+      // write the schema once and whenever the layout of the stream changes
+      if(stream.types.empty() || !hasLayout(package, stream.types)) {
+        stream.types.resize(package.size());
+        for(size_t i = 0; i < package.size(); ++i) {
+          stream.types[i] = package[i].type;
+        }
+        encodeSchema(stream.index, time, info, package, recordBuffer);
+      }
+      encodeSample(stream.index, time, package, recordBuffer);
+      (void)callbackParam;
+    }
+
+    void DataBrokerRecorder::run() {
+      std::vector<char> *fullBuffer;
+      bool done;
+
+      do {
+        bufferMutex.lock();
+        fullBuffer = recordBuffer;
+        recordBuffer = (recordBuffer == &buffers[0]) ? &buffers[1] : &buffers[0];
+        done = !recording;
+        bufferMutex.unlock();
+
+        if(!fullBuffer->empty()) {
+          writer.append(&(*fullBuffer)[0], fullBuffer->size());
+          // keeps the capacity for the next swap
+          fullBuffer->clear();
+        }
+        if(!done) {
+          utils::msleep(cfgFlushInterval.iValue);
+        }
+      } while(!done);
+      writer.close();
+    }
+
+    void DataBrokerRecorder::cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property) {
+
+      if(_property.paramId == cfgRecordFile.paramId) {
+        cfgRecordFile.sValue = _property.sValue;
+      }
+      else if(_property.paramId == cfgChunkSize.paramId) {
+        cfgChunkSize.iValue = _property.iValue;
+      }
+      else if(_property.paramId == cfgFlushInterval.paramId) {
+        cfgFlushInterval.iValue = _property.iValue;
+      }
+      else if(_property.paramId == cfgRecord.paramId) {
+        cfgRecord.bValue = _property.bValue;
+        if(cfgRecord.bValue) {
+          startRecording(cfgRecordFile.sValue);
+        } else {
+          stopRecording();
+        }
+      }
+      else if(_property.paramId == cfgReplayFile.paramId) {
+        cfgReplayFile.sValue = _property.sValue;
+      }
+      else if(_property.paramId == cfgReplaySpeed.paramId) {
+        cfgReplaySpeed.dValue = _property.dValue;
+        replayer->setSpeed(cfgReplaySpeed.dValue);
+      }
+      else if(_property.paramId == cfgReplayLoop.paramId) {
+        cfgReplayLoop.bValue = _property.bValue;
+        replayer->setLoop(cfgReplayLoop.bValue);
+      }
+      else if(_property.paramId == cfgReplay.paramId) {
+        cfgReplay.bValue = _property.bValue;
+        if(cfgReplay.bValue) {
+          startReplay(cfgReplayFile.sValue, cfgReplaySpeed.dValue,
+                      cfgReplayLoop.bValue);
+        } else {
+          stopReplay();
+        }
+      }
+    }
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+DESTROY_LIB(mars::data_broker_recorder::DataBrokerRecorder);
+CREATE_LIB(mars::data_broker_recorder::DataBrokerRecorder);
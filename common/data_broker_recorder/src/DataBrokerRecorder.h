@@ -0,0 +1,132 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file DataBrokerRecorder.h
+ * \brief Records all DataBroker streams into a binary log file and
+ *        replays such files.
+ */
+
+#ifndef DATA_BROKER_RECORDER_H
+#define DATA_BROKER_RECORDER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "DataBrokerRecorder.h"
+#endif
+
+#include "RecordWriter.h"
+#include "RecordCodec.h"
+#include "DataBrokerReplayer.h"
+
+#include <lib_manager/LibInterface.hpp>
+#include <mars/data_broker/DataBrokerInterface.h>
+#include <mars/data_broker/ReceiverInterface.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/cfg_manager/CFGClient.h>
+#include <mars/utils/Thread.h>
+#include <mars/utils/Mutex.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    /**
+     * \brief Records every DataBroker stream at every push.
+     *
+     * The recorder registers itself as synchronous receiver for all streams.
+     * The callback only encodes the package into an in-memory buffer. A
+     * writer thread periodically swaps the buffer and appends its records
+     * to the log file, so the producing thread never waits for the disk.
+     * Streams of the group "data_broker" are not recorded.
+     *
+     * The recording and the replay are controlled by the properties of the
+     * cfg group "DataBrokerRecorder" or by the methods of this class.
+     */
+    class DataBrokerRecorder : public lib_manager::LibInterface,
+                               public data_broker::ReceiverInterface,
+                               public cfg_manager::CFGClient,
+                               public utils::Thread {
+    public:
+      DataBrokerRecorder(lib_manager::LibManager *theManager);
+      ~DataBrokerRecorder();
+
+      // LibInterface methods
+      int getLibVersion() const
+      { return 1; }
+      const std::string getLibName() const
+      { return std::string("data_broker_recorder"); }
+      CREATE_MODULE_INFO();
+
+      bool startRecording(const std::string &filename);
+      void stopRecording();
+      bool isRecording() const;
+
+      /** \see DataBrokerReplayer::play */
+      bool startReplay(const std::string &filename, double speed=1.0,
+                       bool loop=false);
+      void stopReplay();
+
+      // DataBroker ReceiverInterface
+      virtual void receiveData(const data_broker::DataInfo &info,
+                               const data_broker::DataPackage &package,
+                               int callbackParam);
+
+      // CFGClient
+      virtual void cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property);
+
+    protected:
+      /// the writer thread
+      void run();
+
+    private:
+      enum { STREAM_UNKNOWN = -1, STREAM_IGNORED = -2 };
+
+      struct StreamState {
+        long index;
+        std::vector<data_broker::DataType> types;
+      };
+
+      data_broker::DataBrokerInterface *dataBroker;
+      cfg_manager::CFGManagerInterface *cfg;
+      DataBrokerReplayer *replayer;
+      RecordWriter writer;
+
+      mutable utils::Mutex bufferMutex;
+      std::vector<char> buffers[2];
+      std::vector<char> *recordBuffer;
+      std::vector<StreamState> streams; ///< indexed by the DataBroker id
+      uint32_t numStreams;
+      int64_t startTime;
+      bool recording;
+      bool writerRunning;
+
+      cfg_manager::cfgPropertyStruct cfgRecord, cfgRecordFile, cfgChunkSize;
+      cfg_manager::cfgPropertyStruct cfgFlushInterval;
+      cfg_manager::cfgPropertyStruct cfgReplay, cfgReplayFile;
+      cfg_manager::cfgPropertyStruct cfgReplaySpeed, cfgReplayLoop;
+
+    }; // end of class DataBrokerRecorder
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_RECORDER_H
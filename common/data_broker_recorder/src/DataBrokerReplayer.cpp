@@ -0,0 +1,193 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DataBrokerReplayer.h"
+
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <ctime>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    using namespace mars::data_broker;
+
+    // longest time the replay thread sleeps before it checks for stop
+    static const int64_t MAX_SLEEP_NS = 100000000LL;
+
+    static bool sameLayout(const DataPackage &a, const DataPackage &b) {
+      if(a.size() != b.size()) return false;
+      for(size_t i = 0; i < a.size(); ++i) {
+        if(a[i].type != b[i].type || a[i].getName() != b[i].getName()) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    DataBrokerReplayer::DataBrokerReplayer(DataBrokerInterface *dataBroker) :
+      dataBroker(dataBroker), speed(1.0), loop(false), speedChanged(false),
+      threadStarted(false), stopReplay(false) {
+    }
+
+    DataBrokerReplayer::~DataBrokerReplayer() {
+      stop();
+    }
+
+    bool DataBrokerReplayer::play(const std::string &filename, double speed_,
+                                  bool loop_) {
+      stop();
+      if(!dataBroker || !reader.open(filename)) {
+        return false;
+      }
+      streams.clear();
+      speed = speed_;
+      loop = loop_;
+      speedChanged = false;
+      stopReplay = false;
+      threadStarted = true;
+      start();
+      return true;
+    }
+
+    void DataBrokerReplayer::stop() {
+      stopReplay = true;
+      // the thread also has to be joined if it reached the end of the file
+      if(threadStarted) {
+        wait();
+        threadStarted = false;
+      }
+      reader.close();
+    }
+
+    void DataBrokerReplayer::setSpeed(double speed_) {
+      utils::MutexLocker locker(&settingsMutex);
+      speed = speed_;
+      speedChanged = true;
+    }
+
+    void DataBrokerReplayer::setLoop(bool loop_) {
+      utils::MutexLocker locker(&settingsMutex);
+      loop = loop_;
+    }
+
+    void DataBrokerReplayer::handleSchema(uint32_t stream,
+                                          const char *payload,
+                                          uint32_t size) {
+      StreamSchema schema;
+      if(!decodeSchema(payload, size, &schema)) {
+        fprintf(stderr, "DataBrokerReplayer: invalid schema of stream %u\n",
+                stream);
+        return;
+      }
+      if(stream >= streams.size()) {
+        Stream empty;
+        empty.dataId = 0;
+        empty.valid = false;
+        streams.resize(stream + 1, empty);
+      }
+      Stream &s = streams[stream];
+      bool sameName = (s.valid &&
+                       s.schema.groupName == schema.groupName &&
+                       s.schema.dataName == schema.dataName);
+      // every chunk repeats the schemas of all known streams
+      if(sameName && sameLayout(s.schema.package, schema.package)) {
+        return;
+      }
+      s.schema = schema;
+      s.valid = true;
+      if(!sameName) {
+        s.dataId = 0;
+      }
+    }
+
+    void DataBrokerReplayer::run() {
+      RecordHeader header;
+      const char *payload;
+      int64_t wallStart = 0, recordStart = 0;
+      bool synced = false;
+      double currentSpeed;
+      bool currentLoop;
+
+      while(!stopReplay) {
+        if(!reader.next(&header, &payload)) {
+          settingsMutex.lock();
+          currentLoop = loop;
+          settingsMutex.unlock();
+          if(!currentLoop) break;
+          reader.rewind();
+          synced = false;
+          continue;
+        }
+
+        if(header.stream & RECORD_SCHEMA_FLAG) {
+          handleSchema(header.stream & ~RECORD_SCHEMA_FLAG, payload,
+                       header.size);
+          continue;
+        }
+        if(header.stream >= streams.size() || !streams[header.stream].valid) {
+          continue;
+        }
+        Stream &s = streams[header.stream];
+
+        settingsMutex.lock();
+        if(speedChanged) {
+          synced = false;
+          speedChanged = false;
+        }
+        currentSpeed = speed;
+        settingsMutex.unlock();
+
+        if(currentSpeed > 0) {
+          if(!synced) {
+            wallStart = utils::getTimeNs();
+            recordStart = header.time;
+            synced = true;
+          }
+          int64_t target = wallStart + (int64_t)((header.time - recordStart) /
+                                                 currentSpeed);
+          int64_t sleepTime;
+          while(!stopReplay &&
+                (sleepTime = target - utils::getTimeNs()) > 0) {
+            if(sleepTime > MAX_SLEEP_NS) sleepTime = MAX_SLEEP_NS;
+            timespec ts = {(time_t)(sleepTime / 1000000000LL),
+                           (long)(sleepTime % 1000000000LL)};
+            nanosleep(&ts, NULL);
+          }
+        }
+
+        if(!decodeSample(payload, header.size, &s.schema.package)) {
+          continue;
+        }
+        if(s.dataId) {
+          dataBroker->pushData(s.dataId, s.schema.package);
+        } else {
+          s.dataId = dataBroker->pushData(s.schema.groupName,
+                                          s.schema.dataName,
+                                          s.schema.package, NULL,
+                                          s.schema.flags);
+        }
+      }
+    }
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
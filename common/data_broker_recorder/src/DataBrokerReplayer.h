@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file DataBrokerReplayer.h
+ * \brief Pushes the streams of a log file back into a DataBroker.
+ */
+
+#ifndef DATA_BROKER_REPLAYER_H
+#define DATA_BROKER_REPLAYER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "DataBrokerReplayer.h"
+#endif
+
+#include "RecordReader.h"
+#include "RecordCodec.h"
+
+#include <mars/data_broker/DataBrokerInterface.h>
+#include <mars/utils/Thread.h>
+#include <mars/utils/Mutex.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    /**
+     * \brief Replays a log file in its own thread.
+     *
+     * Every recorded stream is pushed under its original group and data
+     * name. Thus any receiver, e.g. the visualization of viz::Viz, gets the
+     * data without a running physics simulation.
+     */
+    class DataBrokerReplayer : public utils::Thread {
+    public:
+      DataBrokerReplayer(data_broker::DataBrokerInterface *dataBroker);
+      ~DataBrokerReplayer();
+
+      /**
+       * \brief opens \a filename and starts the replay thread.
+       * \param speed The replay speed relative to the recording.
+       *              A speed of zero or less replays as fast as possible.
+       * \param loop If \c true the replay restarts at the end of the file.
+       */
+      bool play(const std::string &filename, double speed, bool loop);
+
+      /** \brief stops the replay and waits for the thread to finish */
+      void stop();
+
+      /** \brief changes the replay speed of a running replay */
+      void setSpeed(double speed);
+      void setLoop(bool loop);
+
+    protected:
+      void run();
+
+    private:
+      struct Stream {
+        StreamSchema schema;
+        unsigned long dataId;
+        bool valid;
+      };
+
+      void handleSchema(uint32_t stream, const char *payload, uint32_t size);
+
+      data_broker::DataBrokerInterface *dataBroker;
+      RecordReader reader;
+      std::vector<Stream> streams;
+      utils::Mutex settingsMutex;
+      double speed;
+      bool loop;
+      bool speedChanged;
+      bool threadStarted;
+      volatile bool stopReplay;
+
+    }; // end of class DataBrokerReplayer
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_REPLAYER_H
@@ -0,0 +1,226 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RecordCodec.h"
+
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    using namespace mars::data_broker;
+
+    /// \cond HIDDEN_SYMBOLS
+    namespace {
+
+      template<typename T>
+      inline void put(std::vector<char> *out, const T &value) {
+        size_t pos = out->size();
+        out->resize(pos + sizeof(T));
+        memcpy(&(*out)[pos], &value, sizeof(T));
+      }
+
+      inline void putString(std::vector<char> *out, const std::string &s) {
+        put(out, (uint32_t)s.size());
+        out->insert(out->end(), s.begin(), s.end());
+      }
+
+      inline size_t beginRecord(std::vector<char> *out, uint32_t stream,
+                                int64_t time) {
+        RecordHeader header = {stream, 0, time};
+        size_t pos = out->size();
+        put(out, header);
+        return pos;
+      }
+
+      inline void endRecord(std::vector<char> *out, size_t pos) {
+        uint32_t size = out->size() - pos - sizeof(RecordHeader);
+        memcpy(&(*out)[pos] + offsetof(RecordHeader, size),
+               &size, sizeof(size));
+      }
+
+      class Cursor {
+      public:
+        Cursor(const char *data, uint32_t size) : p(data), end(data+size) {}
+
+        template<typename T>
+        inline bool get(T *value) {
+          if(end - p < (long)sizeof(T)) return false;
+          memcpy(value, p, sizeof(T));
+          p += sizeof(T);
+          return true;
+        }
+
+        inline bool getString(std::string *s) {
+          uint32_t size;
+          if(!get(&size) || (uint32_t)(end - p) < size) return false;
+          s->assign(p, size);
+          p += size;
+          return true;
+        }
+
+      private:
+        const char *p, *end;
+      };
+
+      void encodeValue(const DataItem &item, std::vector<char> *out) {
+        switch(item.type) {
+        case INT_TYPE: put(out, (int32_t)item.i); break;
+        case UINT_TYPE: put(out, (uint32_t)item.ui); break;
+        case LONG_TYPE: put(out, (int64_t)item.l); break;
+        case ULONG_TYPE: put(out, (uint64_t)item.ul); break;
+        case FLOAT_TYPE: put(out, item.f); break;
+        case DOUBLE_TYPE: put(out, item.d); break;
+        case BOOL_TYPE: put(out, (uint8_t)item.b); break;
+        case STRING_TYPE: putString(out, item.s); break;
+        case UNDEFINED_TYPE: break;
+        }
+      }
+
+      bool decodeValue(Cursor *cursor, DataItem *item) {
+        int32_t i; uint32_t ui; int64_t l; uint64_t ul; uint8_t b;
+        switch(item->type) {
+        case INT_TYPE:
+          if(!cursor->get(&i)) return false;
+          item->i = i;
+          return true;
+        case UINT_TYPE:
+          if(!cursor->get(&ui)) return false;
+          item->ui = ui;
+          return true;
+        case LONG_TYPE:
+          if(!cursor->get(&l)) return false;
+          item->l = l;
+          return true;
+        case ULONG_TYPE:
+          if(!cursor->get(&ul)) return false;
+          item->ul = ul;
+          return true;
+        case FLOAT_TYPE: return cursor->get(&item->f);
+        case DOUBLE_TYPE: return cursor->get(&item->d);
+        case BOOL_TYPE:
+          if(!cursor->get(&b)) return false;
+          item->b = b;
+          return true;
+        case STRING_TYPE: return cursor->getString(&item->s);
+        case UNDEFINED_TYPE: return true;
+        }
+        return false;
+      }
+
+      void addItem(DataPackage *package, const std::string &name,
+                   DataType type) {
+        switch(type) {
+        case INT_TYPE: package->add(name, (int)0); break;
+        case UINT_TYPE: package->add(name, (unsigned int)0); break;
+        case LONG_TYPE: package->add(name, (long)0); break;
+        case ULONG_TYPE: package->add(name, (unsigned long)0); break;
+        case FLOAT_TYPE: package->add(name, (float)0); break;
+        case DOUBLE_TYPE: package->add(name, (double)0); break;
+        case BOOL_TYPE: package->add(name, false); break;
+        case STRING_TYPE: package->add(name, std::string()); break;
+        case UNDEFINED_TYPE: {
+          DataItem item;
+          item.setName(name);
+          package->add(item);
+          break;
+        }
+        }
+      }
+
+    } // end of anonymous namespace
+    /// \endcond
+
+    int64_t getWallTime() {
+      timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      return (int64_t)ts.tv_sec*1000000000LL + ts.tv_nsec;
+    }
+
+    void encodeSchema(uint32_t stream, int64_t time,
+                      const DataInfo &info, const DataPackage &package,
+                      std::vector<char> *out) {
+      size_t pos = beginRecord(out, stream | RECORD_SCHEMA_FLAG, time);
+      putString(out, info.groupName);
+      putString(out, info.dataName);
+      put(out, (uint32_t)info.flags);
+      put(out, (uint32_t)package.size());
+      for(size_t i = 0; i < package.size(); ++i) {
+        put(out, (uint8_t)package[i].type);
+        putString(out, package[i].getName());
+      }
+      endRecord(out, pos);
+    }
+
+    void encodeSample(uint32_t stream, int64_t time,
+                      const DataPackage &package, std::vector<char> *out) {
+      size_t pos = beginRecord(out, stream, time);
+      for(size_t i = 0; i < package.size(); ++i) {
+        encodeValue(package[i], out);
+      }
+      endRecord(out, pos);
+    }
+
+    bool hasLayout(const DataPackage &package,
+                   const std::vector<DataType> &types) {
+      if(package.size() != types.size()) return false;
+      for(size_t i = 0; i < types.size(); ++i) {
+        if(package[i].type != types[i]) return false;
+      }
+      return true;
+    }
+
+    bool decodeSchema(const char *payload, uint32_t size,
+                      StreamSchema *schema) {
+      Cursor cursor(payload, size);
+      uint32_t flags, numItems;
+      if(!cursor.getString(&schema->groupName) ||
+         !cursor.getString(&schema->dataName) ||
+         !cursor.get(&flags) || !cursor.get(&numItems)) {
+        return false;
+      }
+      schema->flags = (PackageFlag)flags;
+      schema->package.clear();
+      for(uint32_t i = 0; i < numItems; ++i) {
+        uint8_t type;
+        std::string name;
+        if(!cursor.get(&type) || !cursor.getString(&name)) {
+          return false;
+        }
+        addItem(&schema->package, name, (DataType)type);
+      }
+      return true;
+    }
+
+    bool decodeSample(const char *payload, uint32_t size,
+                      DataPackage *package) {
+      Cursor cursor(payload, size);
+      for(size_t i = 0; i < package->size(); ++i) {
+        if(!decodeValue(&cursor, &(*package)[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file RecordCodec.h
+ * \brief Encoding of DataPackages into schema and sample records.
+ */
+
+#ifndef DATA_BROKER_RECORDER_RECORD_CODEC_H
+#define DATA_BROKER_RECORDER_RECORD_CODEC_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RecordCodec.h"
+#endif
+
+#include "RecordFormat.h"
+
+#include <mars/data_broker/DataInfo.h>
+#include <mars/data_broker/DataPackage.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    /**
+     * \brief The decoded schema of a recorded stream.
+     *
+     * \a package holds the items with their names and types. Decoding a
+     * sample only sets the values of these items.
+     */
+    struct StreamSchema {
+      std::string groupName;
+      std::string dataName;
+      data_broker::PackageFlag flags;
+      data_broker::DataPackage package;
+    };
+
+    /** \brief wall clock time in nanoseconds since the epoch */
+    int64_t getWallTime();
+
+    /**
+     * \brief appends a complete schema record for \a package to \a out
+     */
+    void encodeSchema(uint32_t stream, int64_t time,
+                      const data_broker::DataInfo &info,
+                      const data_broker::DataPackage &package,
+                      std::vector<char> *out);
+
+    /**
+     * \brief appends a complete sample record for \a package to \a out
+     */
+    void encodeSample(uint32_t stream, int64_t time,
+                      const data_broker::DataPackage &package,
+                      std::vector<char> *out);
+
+    /**
+     * \brief returns \c true if \a package has the item types in \a types.
+     */
+    bool hasLayout(const data_broker::DataPackage &package,
+                   const std::vector<data_broker::DataType> &types);
+
+    bool decodeSchema(const char *payload, uint32_t size,
+                      StreamSchema *schema);
+
+    /**
+     * \brief sets the values of the items in \a package from \a payload
+     * \return \c false if the payload does not match the package layout.
+     */
+    bool decodeSample(const char *payload, uint32_t size,
+                      data_broker::DataPackage *package);
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_RECORDER_RECORD_CODEC_H
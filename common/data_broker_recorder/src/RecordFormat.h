@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file RecordFormat.h
+ * \brief On-disk layout of the binary DataBroker log files.
+ *
+ * A log file starts with a FileHeader on its own page. It is followed by
+ * page aligned chunks. Each chunk starts with a ChunkHeader and contains
+ * a sequence of records. Every record starts with a RecordHeader.
+ *
+ * A schema record describes a stream once: the group and data name, the
+ * package flags and the names and types of its items. Sample records only
+ * contain the item values in the order of the last schema of the stream.
+ * When a stream changes its layout a new schema record is written.
+ *
+ * When the recording is stopped an index with one IndexEntry per chunk is
+ * appended and its offset is stored in the FileHeader. Files that were not
+ * closed properly have an indexOffset of zero and are read by walking
+ * the chunk headers.
+ *
+ * All values are stored in host byte order.
+ */
+
+#ifndef DATA_BROKER_RECORDER_RECORD_FORMAT_H
+#define DATA_BROKER_RECORDER_RECORD_FORMAT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RecordFormat.h"
+#endif
+
+#include <stdint.h>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    const char RECORD_FILE_MAGIC[8] = {'M', 'D', 'B', 'R', 'E', 'C', 0, 0};
+    const uint32_t RECORD_FILE_VERSION = 1;
+    const uint32_t RECORD_CHUNK_MAGIC = 0x4b4e4843; // "CHNK"
+
+    /// set in RecordHeader::stream for schema records
+    const uint32_t RECORD_SCHEMA_FLAG = 0x80000000u;
+
+    struct FileHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t pageSize;
+      uint64_t indexOffset; ///< zero if the recording was not closed
+      uint64_t indexCount;
+      int64_t startTime;    ///< wall clock time in ns since the epoch
+    };
+
+    struct ChunkHeader {
+      uint32_t magic;
+      uint32_t numRecords;
+      uint64_t size;        ///< bytes of records following the header
+      int64_t firstTime;
+      int64_t lastTime;
+    };
+
+    struct IndexEntry {
+      uint64_t offset;      ///< file offset of the ChunkHeader
+      int64_t firstTime;
+      int64_t lastTime;
+    };
+
+    struct RecordHeader {
+      uint32_t stream;      ///< stream index, see RECORD_SCHEMA_FLAG
+      uint32_t size;        ///< bytes of payload following the header
+      int64_t time;         ///< ns since the start of the recording
+    };
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_RECORDER_RECORD_FORMAT_H
@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RecordReader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    RecordReader::RecordReader() : fd(-1), data(NULL), fileSize(0),
+                                   currentChunk(0), position(0),
+                                   chunkEnd(0) {
+    }
+
+    RecordReader::~RecordReader() {
+      close();
+    }
+
+    bool RecordReader::open(const std::string &filename) {
+      struct stat fileStat;
+      FileHeader fileHeader;
+
+      close();
+      fd = ::open(filename.c_str(), O_RDONLY);
+      if(fd == -1 || fstat(fd, &fileStat) != 0) {
+        fprintf(stderr, "RecordReader: could not open \"%s\": %s\n",
+                filename.c_str(), strerror(errno));
+        close();
+        return false;
+      }
+      fileSize = fileStat.st_size;
+      if(fileSize < sizeof(FileHeader)) {
+        fprintf(stderr, "RecordReader: \"%s\" is too small\n",
+                filename.c_str());
+        close();
+        return false;
+      }
+      void *mapping = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+      if(mapping == MAP_FAILED) {
+        fprintf(stderr, "RecordReader: could not map \"%s\": %s\n",
+                filename.c_str(), strerror(errno));
+        close();
+        return false;
+      }
+      data = (const char*)mapping;
+      memcpy(&fileHeader, data, sizeof(fileHeader));
+      if(memcmp(fileHeader.magic, RECORD_FILE_MAGIC,
+                sizeof(fileHeader.magic)) != 0 ||
+         fileHeader.version != RECORD_FILE_VERSION ||
+         fileHeader.pageSize == 0) {
+        fprintf(stderr, "RecordReader: \"%s\" is not a DataBroker record\n",
+                filename.c_str());
+        close();
+        return false;
+      }
+      buildIndex(fileHeader);
+      seekChunk(0);
+      return true;
+    }
+
+    void RecordReader::close() {
+      if(data) {
+        munmap((void*)data, fileSize);
+        data = NULL;
+      }
+      if(fd != -1) {
+        ::close(fd);
+        fd = -1;
+      }
+      fileSize = 0;
+      index.clear();
+      currentChunk = 0;
+      position = chunkEnd = 0;
+    }
+
+    int64_t RecordReader::getStartTime() const {
+      FileHeader fileHeader;
+      if(!data) return 0;
+      memcpy(&fileHeader, data, sizeof(fileHeader));
+      return fileHeader.startTime;
+    }
+
+    void RecordReader::buildIndex(const FileHeader &fileHeader) {
+      index.clear();
+      if(fileHeader.indexOffset &&
+         fileHeader.indexOffset <= fileSize &&
+         fileHeader.indexCount <= ((fileSize - fileHeader.indexOffset) /
+                                   sizeof(IndexEntry))) {
+        index.resize(fileHeader.indexCount);
+        if(!index.empty()) {
+          memcpy(&index[0], data + fileHeader.indexOffset,
+                 index.size() * sizeof(IndexEntry));
+        }
+        return;
+      }
+
+      // the recording was not closed: walk the chunks
+      uint64_t pageSize = fileHeader.pageSize;
+      uint64_t offset = pageSize;
+      while(offset + sizeof(ChunkHeader) <= fileSize) {
+        ChunkHeader chunkHeader;
+        memcpy(&chunkHeader, data + offset, sizeof(chunkHeader));
+        if(chunkHeader.magic != RECORD_CHUNK_MAGIC) break;
+        IndexEntry entry = {offset, chunkHeader.firstTime,
+                            chunkHeader.lastTime};
+        index.push_back(entry);
+        offset += sizeof(ChunkHeader) + chunkHeader.size;
+        offset = (offset + pageSize - 1) / pageSize * pageSize;
+      }
+    }
+
+    void RecordReader::seekChunk(size_t chunk) {
+      currentChunk = chunk;
+      position = chunkEnd = 0;
+      if(chunk >= index.size()) return;
+      ChunkHeader chunkHeader;
+      uint64_t offset = index[chunk].offset;
+      if(offset + sizeof(ChunkHeader) > fileSize) return;
+      memcpy(&chunkHeader, data + offset, sizeof(chunkHeader));
+      position = offset + sizeof(ChunkHeader);
+      chunkEnd = position + chunkHeader.size;
+      if(chunkEnd > fileSize) chunkEnd = fileSize;
+    }
+
+    void RecordReader::seek(int64_t time) {
+      size_t chunk;
+      for(chunk = 0; chunk < index.size(); ++chunk) {
+        if(index[chunk].lastTime >= time) break;
+      }
+      seekChunk(chunk);
+    }
+
+    bool RecordReader::next(RecordHeader *header, const char **payload) {
+      while(currentChunk < index.size()) {
+        if(position + sizeof(RecordHeader) <= chunkEnd) {
+          memcpy(header, data + position, sizeof(RecordHeader));
+          uint64_t payloadPosition = position + sizeof(RecordHeader);
+          if(payloadPosition + header->size <= chunkEnd) {
+            *payload = data + payloadPosition;
+            position = payloadPosition + header->size;
+            return true;
+          }
+          fprintf(stderr, "RecordReader: corrupt chunk %lu\n",
+                  (unsigned long)currentChunk);
+        }
+        seekChunk(currentChunk + 1);
+      }
+      return false;
+    }
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file RecordReader.h
+ * \brief Reads the records of a memory mapped log file.
+ */
+
+#ifndef DATA_BROKER_RECORDER_RECORD_READER_H
+#define DATA_BROKER_RECORDER_RECORD_READER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RecordReader.h"
+#endif
+
+#include "RecordFormat.h"
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    class RecordReader {
+    public:
+      RecordReader();
+      ~RecordReader();
+
+      /**
+       * \brief maps \a filename into memory and loads the chunk index.
+       *
+       * If the file was not closed properly the index is rebuilt by
+       * walking the chunk headers.
+       */
+      bool open(const std::string &filename);
+      void close();
+
+      bool isOpen() const
+      { return data != NULL; }
+
+      /** \brief wall clock time of the start of the recording in ns */
+      int64_t getStartTime() const;
+
+      const std::vector<IndexEntry>& getIndex() const
+      { return index; }
+
+      /**
+       * \brief moves to the first chunk that contains samples recorded at
+       *        or after \a time.
+       *
+       * Every chunk starts with the schemas of all streams known when the
+       * chunk was written. Thus reading can continue from any chunk.
+       */
+      void seek(int64_t time);
+
+      void rewind()
+      { seekChunk(0); }
+
+      /**
+       * \brief returns the next record.
+       * \param header Receives the header of the record.
+       * \param payload Points into the mapped file. It stays valid until
+       *                the reader is closed.
+       * \return \c false at the end of the file.
+       */
+      bool next(RecordHeader *header, const char **payload);
+
+    private:
+      void buildIndex(const FileHeader &fileHeader);
+      void seekChunk(size_t chunk);
+
+      int fd;
+      const char *data;
+      size_t fileSize;
+      std::vector<IndexEntry> index;
+      size_t currentChunk;
+      uint64_t position, chunkEnd;
+
+    }; // end of class RecordReader
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_RECORDER_RECORD_READER_H
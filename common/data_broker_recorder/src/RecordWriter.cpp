@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RecordWriter.h"
+#include "RecordCodec.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    static uint64_t alignTo(uint64_t value, uint64_t alignment) {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    RecordWriter::RecordWriter() : fd(-1), chunkSize(0), fileEnd(0),
+                                   chunkOffset(0), chunkCapacity(0),
+                                   chunk(NULL) {
+      pageSize = sysconf(_SC_PAGESIZE);
+    }
+
+    RecordWriter::~RecordWriter() {
+      close();
+    }
+
+    bool RecordWriter::open(const std::string &filename, size_t chunkSize_) {
+      close();
+      fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if(fd == -1) {
+        fprintf(stderr, "RecordWriter: could not open \"%s\": %s\n",
+                filename.c_str(), strerror(errno));
+        return false;
+      }
+      FileHeader header;
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, RECORD_FILE_MAGIC, sizeof(header.magic));
+      header.version = RECORD_FILE_VERSION;
+      header.pageSize = pageSize;
+      header.startTime = getWallTime();
+      if(pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        fprintf(stderr, "RecordWriter: could not write \"%s\": %s\n",
+                filename.c_str(), strerror(errno));
+        ::close(fd);
+        fd = -1;
+        return false;
+      }
+      // the header occupies the first page
+      fileEnd = pageSize;
+      chunkSize = alignTo(chunkSize_ > pageSize ? chunkSize_ : pageSize,
+                          pageSize);
+      index.clear();
+      schemas.clear();
+      return true;
+    }
+
+    bool RecordWriter::append(const char *records, size_t size) {
+      const char *p = records;
+      const char *end = records + size;
+
+      if(fd == -1) return false;
+
+      while((size_t)(end - p) >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        memcpy(&header, p, sizeof(header));
+        size_t recordSize = sizeof(RecordHeader) + header.size;
+        if((size_t)(end - p) < recordSize) {
+          fprintf(stderr, "RecordWriter: truncated record\n");
+          return false;
+        }
+        bool isSchema = header.stream & RECORD_SCHEMA_FLAG;
+        if(isSchema) {
+          schemas[header.stream].assign(p, p + recordSize);
+        }
+        ChunkHeader *chunkHeader = (ChunkHeader*)chunk;
+        if(!chunk || (sizeof(ChunkHeader) + chunkHeader->size + recordSize >
+                      chunkCapacity)) {
+          finishChunk();
+          // a new chunk starts with all known schemas including this one
+          if(!startChunk(recordSize)) return false;
+          if(isSchema) {
+            p += recordSize;
+            continue;
+          }
+        }
+        appendRecord(header, p);
+        p += recordSize;
+      }
+      return true;
+    }
+
+    void RecordWriter::appendRecord(const RecordHeader &header,
+                                    const char *record) {
+      ChunkHeader *chunkHeader = (ChunkHeader*)chunk;
+      size_t recordSize = sizeof(RecordHeader) + header.size;
+      memcpy(chunk + sizeof(ChunkHeader) + chunkHeader->size,
+             record, recordSize);
+      if(!(header.stream & RECORD_SCHEMA_FLAG)) {
+        if(header.time < chunkHeader->firstTime) {
+          chunkHeader->firstTime = header.time;
+        }
+        if(header.time > chunkHeader->lastTime) {
+          chunkHeader->lastTime = header.time;
+        }
+      }
+      // update the size last so that a reader of an unclosed file never
+      // sees a partial record
+      ++chunkHeader->numRecords;
+      chunkHeader->size += recordSize;
+    }
+
+    bool RecordWriter::startChunk(size_t minSize) {
+      size_t needed = sizeof(ChunkHeader) + minSize;
+      std::map<uint32_t, std::vector<char> >::iterator it;
+      for(it = schemas.begin(); it != schemas.end(); ++it) {
+        needed += it->second.size();
+      }
+      chunkCapacity = chunkSize;
+      if(needed > chunkCapacity) {
+        chunkCapacity = alignTo(needed, pageSize);
+      }
+      chunkOffset = fileEnd;
+      if(ftruncate(fd, chunkOffset + chunkCapacity) != 0) {
+        fprintf(stderr, "RecordWriter: could not grow file: %s\n",
+                strerror(errno));
+        return false;
+      }
+      void *mapping = mmap(NULL, chunkCapacity, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, chunkOffset);
+      if(mapping == MAP_FAILED) {
+        fprintf(stderr, "RecordWriter: could not map chunk: %s\n",
+                strerror(errno));
+        return false;
+      }
+      chunk = (char*)mapping;
+      ChunkHeader chunkHeader = {RECORD_CHUNK_MAGIC, 0, 0,
+                                 INT64_MAX, INT64_MIN};
+      memcpy(chunk, &chunkHeader, sizeof(chunkHeader));
+      fileEnd = chunkOffset + chunkCapacity;
+
+      for(it = schemas.begin(); it != schemas.end(); ++it) {
+        RecordHeader header;
+        memcpy(&header, &it->second[0], sizeof(header));
+        appendRecord(header, &it->second[0]);
+      }
+      return true;
+    }
+
+    void RecordWriter::finishChunk() {
+      if(!chunk) return;
+      ChunkHeader *chunkHeader = (ChunkHeader*)chunk;
+      IndexEntry entry = {chunkOffset, chunkHeader->firstTime,
+                          chunkHeader->lastTime};
+      index.push_back(entry);
+      fileEnd = chunkOffset + alignTo(sizeof(ChunkHeader) + chunkHeader->size,
+                                      pageSize);
+      munmap(chunk, chunkCapacity);
+      chunk = NULL;
+    }
+
+    void RecordWriter::close() {
+      if(fd == -1) return;
+      finishChunk();
+      uint64_t indexOffset = fileEnd;
+      uint64_t indexCount = index.size();
+      size_t indexSize = index.size() * sizeof(IndexEntry);
+      bool ok = (ftruncate(fd, indexOffset) == 0);
+      if(ok && indexSize) {
+        ok = (pwrite(fd, &index[0], indexSize, indexOffset) ==
+              (ssize_t)indexSize);
+      }
+      if(ok) {
+        ok = (pwrite(fd, &indexCount, sizeof(indexCount),
+                     offsetof(FileHeader, indexCount)) ==
+              sizeof(indexCount));
+      }
+      // the index offset is written last and marks the file as complete
+      if(ok) {
+        ok = (pwrite(fd, &indexOffset, sizeof(indexOffset),
+                     offsetof(FileHeader, indexOffset)) ==
+              sizeof(indexOffset));
+      }
+      if(!ok) {
+        fprintf(stderr, "RecordWriter: could not write index: %s\n",
+                strerror(errno));
+      }
+      ::close(fd);
+      fd = -1;
+    }
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file RecordWriter.h
+ * \brief Appends records to a memory mapped, chunked log file.
+ */
+
+#ifndef DATA_BROKER_RECORDER_RECORD_WRITER_H
+#define DATA_BROKER_RECORDER_RECORD_WRITER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RecordWriter.h"
+#endif
+
+#include "RecordFormat.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_recorder {
+
+    /**
+     * \brief Writes complete records into page aligned chunks that are
+     *        mapped into memory one at a time.
+     *
+     * The latest schema record of every stream is repeated at the start of
+     * each chunk. Thus every chunk can be decoded on its own, which allows
+     * a reader to seek through the index without scanning the whole file.
+     *
+     * The writer is not thread safe. The DataBrokerRecorder only uses it
+     * from its writer thread.
+     */
+    class RecordWriter {
+    public:
+      RecordWriter();
+      ~RecordWriter();
+
+      /**
+       * \brief creates \a filename and writes the file header.
+       * \param chunkSize The minimal size of a chunk in bytes.
+       */
+      bool open(const std::string &filename, size_t chunkSize);
+
+      /**
+       * \brief appends a buffer that contains a sequence of complete
+       *        records as created by encodeSchema() and encodeSample().
+       */
+      bool append(const char *records, size_t size);
+
+      /** \brief writes the chunk index and closes the file */
+      void close();
+
+      bool isOpen() const
+      { return fd != -1; }
+
+    private:
+      bool startChunk(size_t minSize);
+      void finishChunk();
+      void appendRecord(const RecordHeader &header, const char *record);
+
+      int fd;
+      size_t pageSize, chunkSize;
+      uint64_t fileEnd;
+      uint64_t chunkOffset;
+      size_t chunkCapacity;
+      char *chunk;
+      std::vector<IndexEntry> index;
+      std::map<uint32_t, std::vector<char> > schemas;
+
+    }; // end of class RecordWriter
+
+  } // end of namespace data_broker_recorder
+} // end of namespace mars
+
+#endif // DATA_BROKER_RECORDER_RECORD_WRITER_H
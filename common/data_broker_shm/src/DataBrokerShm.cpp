@@ -0,0 +1,424 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DataBrokerShm.h"
+
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace mars {
+  namespace data_broker_shm {
+
+    using namespace mars::data_broker;
+
+    /// \cond HIDDEN_SYMBOLS
+    namespace {
+
+      uint64_t align8(uint64_t value) {
+        return (value + 7) & ~(uint64_t)7;
+      }
+
+      void copyName(char *dst, const std::string &src) {
+        strncpy(dst, src.c_str(), SHM_NAME_SIZE - 1);
+        dst[SHM_NAME_SIZE - 1] = '\0';
+      }
+
+      void encodeCell(char *cell, const DataItem &item) {
+        int64_t l;
+        uint64_t ul;
+        double d;
+        switch(item.type) {
+        case INT_TYPE: l = item.i; memcpy(cell, &l, sizeof(l)); break;
+        case LONG_TYPE: l = item.l; memcpy(cell, &l, sizeof(l)); break;
+        case BOOL_TYPE: l = item.b; memcpy(cell, &l, sizeof(l)); break;
+        case UINT_TYPE: ul = item.ui; memcpy(cell, &ul, sizeof(ul)); break;
+        case ULONG_TYPE: ul = item.ul; memcpy(cell, &ul, sizeof(ul)); break;
+        case FLOAT_TYPE: d = item.f; memcpy(cell, &d, sizeof(d)); break;
+        case DOUBLE_TYPE: memcpy(cell, &item.d, sizeof(d)); break;
+        case STRING_TYPE:
+          strncpy(cell, item.s.c_str(), SHM_STRING_SIZE - 1);
+          cell[SHM_STRING_SIZE - 1] = '\0';
+          break;
+        case UNDEFINED_TYPE:
+          memset(cell, 0, SHM_CELL_SIZE);
+          break;
+        }
+      }
+
+      void decodeCell(const char *cell, DataItem *item) {
+        int64_t l;
+        uint64_t ul;
+        double d;
+        switch(item->type) {
+        case INT_TYPE: memcpy(&l, cell, sizeof(l)); item->i = l; break;
+        case LONG_TYPE: memcpy(&l, cell, sizeof(l)); item->l = l; break;
+        case BOOL_TYPE: memcpy(&l, cell, sizeof(l)); item->b = l; break;
+        case UINT_TYPE: memcpy(&ul, cell, sizeof(ul)); item->ui = ul; break;
+        case ULONG_TYPE: memcpy(&ul, cell, sizeof(ul)); item->ul = ul; break;
+        case FLOAT_TYPE: memcpy(&d, cell, sizeof(d)); item->f = d; break;
+        case DOUBLE_TYPE: memcpy(&item->d, cell, sizeof(d)); break;
+        case STRING_TYPE:
+          item->s.assign(cell, strnlen(cell, SHM_STRING_SIZE));
+          break;
+        case UNDEFINED_TYPE:
+          break;
+        }
+      }
+
+    } // end of anonymous namespace
+    /// \endcond
+
+    DataBrokerShm::DataBrokerShm(lib_manager::LibManager *theManager)
+      : lib_manager::LibInterface(theManager), dataBroker(NULL), cfg(NULL),
+        header(NULL), segmentSize(0), dataEnd(0), numSlots(0),
+        stopThread(false), threadStarted(false) {
+
+      cfgSegmentName.sValue = "/mars_data_broker";
+      cfgSegmentSize.iValue = 16;
+      cfgStreams.sValue = "mars_sim:*";
+
+      dataBroker = theManager->getLibraryAs<DataBrokerInterface>("data_broker");
+      if(!dataBroker) {
+        fprintf(stderr, "DataBrokerShm: could not get DataBroker!\n");
+        return;
+      }
+      cfg = theManager->getLibraryAs<cfg_manager::CFGManagerInterface>("cfg_manager");
+      if(cfg) {
+        cfgSegmentName = cfg->getOrCreateProperty("DataBrokerShm",
+                                                  "segment name",
+                                                  cfgSegmentName.sValue,
+                                                  this);
+        cfgSegmentSize = cfg->getOrCreateProperty("DataBrokerShm",
+                                                  "segment size MB",
+                                                  cfgSegmentSize.iValue,
+                                                  this);
+        cfgStreams = cfg->getOrCreateProperty("DataBrokerShm", "streams",
+                                              cfgStreams.sValue, this);
+      }
+      open(cfgSegmentName.sValue, (size_t)cfgSegmentSize.iValue << 20,
+           cfgStreams.sValue);
+    }
+
+    DataBrokerShm::~DataBrokerShm() {
+      close();
+      if(cfg) {
+        cfg->unregisterFromParam(cfgSegmentName.paramId, this);
+        cfg->unregisterFromParam(cfgSegmentSize.paramId, this);
+        cfg->unregisterFromParam(cfgStreams.paramId, this);
+        libManager->releaseLibrary("cfg_manager");
+      }
+      if(dataBroker) libManager->releaseLibrary("data_broker");
+    }
+
+    bool DataBrokerShm::open(const std::string &segmentName_, size_t size,
+                             const std::string &streams) {
+      close();
+      if(size < sizeof(ShmHeader)) {
+        size = sizeof(ShmHeader);
+      }
+      // never take over a segment of another instance
+      int fd = shm_open(segmentName_.c_str(), O_CREAT | O_EXCL | O_RDWR,
+                        0600);
+      if(fd == -1) {
+        if(errno == EEXIST) {
+          fprintf(stderr, "DataBrokerShm: \"%s\" already exists, another "
+                  "instance uses it or it is left from an earlier run "
+                  "(see /dev/shm)\n", segmentName_.c_str());
+        } else {
+          fprintf(stderr, "DataBrokerShm: could not open \"%s\": %s\n",
+                  segmentName_.c_str(), strerror(errno));
+        }
+        return false;
+      }
+      if(ftruncate(fd, size) != 0) {
+        fprintf(stderr, "DataBrokerShm: could not resize \"%s\": %s\n",
+                segmentName_.c_str(), strerror(errno));
+        ::close(fd);
+        shm_unlink(segmentName_.c_str());
+        return false;
+      }
+      void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0);
+      ::close(fd);
+      if(mapping == MAP_FAILED) {
+        fprintf(stderr, "DataBrokerShm: could not map \"%s\": %s\n",
+                segmentName_.c_str(), strerror(errno));
+        shm_unlink(segmentName_.c_str());
+        return false;
+      }
+
+      ShmHeader *newHeader = (ShmHeader*)mapping;
+      newHeader->version = SHM_VERSION;
+      newHeader->maxSlots = SHM_MAX_SLOTS;
+      newHeader->size = size;
+      newHeader->dataEnd.store(align8(sizeof(ShmHeader)));
+      // clients check the magic, so it is written last
+      std::atomic_thread_fence(std::memory_order_release);
+      memcpy(newHeader->magic, SHM_MAGIC, sizeof(newHeader->magic));
+
+      slotMutex.lock();
+      header = newHeader;
+      segmentSize = size;
+      dataEnd = align8(sizeof(ShmHeader));
+      numSlots = 0;
+      segmentName = segmentName_;
+      elements.clear();
+      writableElements.clear();
+      slotMutex.unlock();
+
+      // parse "group:data;group:data"
+      patterns.clear();
+      size_t begin = 0;
+      while(begin < streams.size()) {
+        size_t end = streams.find(';', begin);
+        if(end == std::string::npos) end = streams.size();
+        std::string pattern = streams.substr(begin, end - begin);
+        begin = end + 1;
+        if(pattern.empty()) continue;
+        size_t colon = pattern.find(':');
+        if(colon == std::string::npos) {
+          patterns.push_back(std::make_pair(pattern, std::string("*")));
+        } else {
+          patterns.push_back(std::make_pair(pattern.substr(0, colon),
+                                            pattern.substr(colon + 1)));
+        }
+      }
+
+      stopThread = false;
+      threadStarted = true;
+      start();
+      for(size_t i = 0; i < patterns.size(); ++i) {
+        dataBroker->registerSyncReceiver(this, patterns[i].first,
+                                         patterns[i].second);
+      }
+      return true;
+    }
+
+    void DataBrokerShm::close() {
+      if(!header) return;
+      for(size_t i = 0; i < patterns.size(); ++i) {
+        dataBroker->unregisterSyncReceiver(this, patterns[i].first,
+                                           patterns[i].second);
+      }
+      stopThread = true;
+      header->commandNotify.fetch_add(1);
+      utils::shmWake(&header->commandNotify, &header->commandWaiters);
+      if(threadStarted) {
+        wait();
+        threadStarted = false;
+      }
+      slotMutex.lock();
+      ShmHeader *oldHeader = header;
+      header = NULL;
+      slotMutex.unlock();
+      munmap(oldHeader, segmentSize);
+      shm_unlink(segmentName.c_str());
+    }
+
+    void DataBrokerShm::receiveData(const DataInfo &info,
+                                    const DataPackage &package,
+                                    int callbackParam) {
+      utils::MutexLocker locker(&slotMutex);
+      if(!header) return;
+
+      if(info.dataId >= elements.size()) {
+        MirroredElement none;
+        none.slot = SLOT_NONE;
+        none.dataId = 0;
+        none.lastCommand = 0;
+        elements.resize(info.dataId + 1, none);
+      }
+      MirroredElement &element = elements[info.dataId];
+      if(element.slot == SLOT_FULL) return;
+
+      bool sameLayout = (element.slot != SLOT_NONE &&
+                         element.types.size() == package.size());
+      for(size_t i = 0; sameLayout && i < package.size(); ++i) {
+        sameLayout = (element.types[i] == package[i].type);
+      }
+      if(!sameLayout) {
+        if(element.slot == SLOT_NONE) {
+          if(info.flags & DATA_PACKAGE_WRITE_FLAG) {
+            writableElements.push_back(info.dataId);
+          }
+        } else {
+          header->slots[element.slot].flags.fetch_or(SHM_SLOT_RETIRED);
+        }
+        element.dataId = info.dataId;
+        element.types.resize(package.size());
+        for(size_t i = 0; i < package.size(); ++i) {
+          element.types[i] = package[i].type;
+        }
+        element.commandPackage = package;
+        element.lastCommand = 0;
+        element.slot = createSlot(info, package, &element);
+        if(element.slot == SLOT_FULL) return;
+      }
+      writeState(element, package);
+      (void)callbackParam;
+    }
+
+    long DataBrokerShm::createSlot(const DataInfo &info,
+                                   const DataPackage &package,
+                                   MirroredElement *element) {
+      uint32_t index = numSlots;
+      if(index >= SHM_MAX_SLOTS) {
+        fprintf(stderr, "DataBrokerShm: no free slot for \"%s/%s\"\n",
+                info.groupName.c_str(), info.dataName.c_str());
+        return SLOT_FULL;
+      }
+      uint32_t dataSize = 0;
+      for(size_t i = 0; i < package.size(); ++i) {
+        dataSize += shmCellSize(package[i].type);
+      }
+      uint64_t itemsOffset = dataEnd;
+      uint64_t stateOffset = align8(itemsOffset +
+                                    package.size() * sizeof(ShmItem));
+      uint64_t commandOffset = stateOffset + dataSize;
+      uint64_t end = commandOffset + dataSize;
+      if(end > segmentSize) {
+        fprintf(stderr, "DataBrokerShm: segment is full, cannot mirror "
+                "\"%s/%s\"\n", info.groupName.c_str(), info.dataName.c_str());
+        return SLOT_FULL;
+      }
+
+      ShmSlot *slot = &header->slots[index];
+      ShmItem *items = (ShmItem*)((char*)header + itemsOffset);
+      uint32_t offset = 0;
+      element->cellOffsets.resize(package.size());
+      for(size_t i = 0; i < package.size(); ++i) {
+        copyName(items[i].name, package[i].getName());
+        items[i].type = package[i].type;
+        items[i].offset = offset;
+        element->cellOffsets[i] = offset;
+        offset += shmCellSize(package[i].type);
+      }
+      element->stateOffset = stateOffset;
+      element->commandOffset = commandOffset;
+      element->dataSize = dataSize;
+      copyName(slot->groupName, info.groupName);
+      copyName(slot->dataName, info.dataName);
+      slot->numItems = package.size();
+      slot->itemsOffset = itemsOffset;
+      slot->stateOffset = stateOffset;
+      slot->commandOffset = commandOffset;
+      slot->dataSize = dataSize;
+      slot->flags.store(info.flags & (SHM_SLOT_READ | SHM_SLOT_WRITE));
+      dataEnd = end;
+      numSlots = index + 1;
+      header->dataEnd.store(end);
+      // publish the slot after it is complete
+      header->numSlots.store(numSlots, std::memory_order_release);
+      return index;
+    }
+
+    void DataBrokerShm::writeState(const MirroredElement &element,
+                                   const DataPackage &package) {
+      ShmSlot *slot = &header->slots[element.slot];
+      char *cells = (char*)header + element.stateOffset;
+      uint32_t s = utils::shmSeqWriteBegin(&slot->stateSequence);
+      for(size_t i = 0; i < package.size(); ++i) {
+        encodeCell(cells + element.cellOffsets[i], package[i]);
+      }
+      utils::shmSeqWriteEnd(&slot->stateSequence, s);
+      slot->stateTime.store(utils::getTimeNs(), std::memory_order_relaxed);
+      header->notify.fetch_add(1);
+      utils::shmWake(&header->notify, &header->notifyWaiters);
+    }
+
+    void DataBrokerShm::processCommands() {
+      std::vector<std::pair<unsigned long, DataPackage> > commands;
+
+      slotMutex.lock();
+      if(!header) {
+        slotMutex.unlock();
+        return;
+      }
+      for(size_t i = 0; i < writableElements.size(); ++i) {
+        MirroredElement &element = elements[writableElements[i]];
+        if(element.slot < 0) continue;
+        ShmSlot *slot = &header->slots[element.slot];
+        uint32_t sequence = slot->commandSequence.load(std::memory_order_acquire);
+        if(sequence == element.lastCommand || (sequence & 1)) continue;
+
+        // a client that died while writing must not block the bridge
+        commandBuffer.resize(element.dataSize);
+        if(!utils::shmSeqTryRead(&slot->commandSequence, &commandBuffer[0],
+                                 (char*)header + element.commandOffset,
+                                 element.dataSize, SHM_READ_RETRIES,
+                                 &sequence)) {
+          continue;
+        }
+        element.lastCommand = sequence;
+        for(size_t j = 0; j < element.commandPackage.size(); ++j) {
+          decodeCell(&commandBuffer[element.cellOffsets[j]],
+                     &element.commandPackage[j]);
+        }
+        commands.push_back(std::make_pair(element.dataId,
+                                          element.commandPackage));
+      }
+      slotMutex.unlock();
+
+      // push without holding the lock, our own receiveData will be called
+      for(size_t i = 0; i < commands.size(); ++i) {
+        dataBroker->pushData(commands[i].first, commands[i].second);
+      }
+    }
+
+    void DataBrokerShm::run() {
+      uint32_t seen = header->commandNotify.load();
+      while(!stopThread) {
+        utils::shmWait(&header->commandNotify, &header->commandWaiters,
+                       seen, 100);
+        seen = header->commandNotify.load();
+        processCommands();
+      }
+    }
+
+    void DataBrokerShm::cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property) {
+
+      if(_property.paramId == cfgSegmentName.paramId) {
+        cfgSegmentName.sValue = _property.sValue;
+      }
+      else if(_property.paramId == cfgSegmentSize.paramId) {
+        cfgSegmentSize.iValue = _property.iValue;
+      }
+      else if(_property.paramId == cfgStreams.paramId) {
+        cfgStreams.sValue = _property.sValue;
+      }
+      else {
+        return;
+      }
+      open(cfgSegmentName.sValue, (size_t)cfgSegmentSize.iValue << 20,
+           cfgStreams.sValue);
+    }
+
+  } // end of namespace data_broker_shm
+} // end of namespace mars
+
+DESTROY_LIB(mars::data_broker_shm::DataBrokerShm);
+CREATE_LIB(mars::data_broker_shm::DataBrokerShm);
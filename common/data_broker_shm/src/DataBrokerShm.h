@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file DataBrokerShm.h
+ * \brief Mirrors DataBroker elements into a POSIX shared memory segment.
+ */
+
+#ifndef DATA_BROKER_SHM_H
+#define DATA_BROKER_SHM_H
+
+#ifdef _PRINT_HEADER_
+  #warning "DataBrokerShm.h"
+#endif
+
+#include "ShmLayout.h"
+
+#include <lib_manager/LibInterface.hpp>
+#include <mars/data_broker/DataBrokerInterface.h>
+#include <mars/data_broker/ReceiverInterface.h>
+#include <mars/data_broker/DataPackage.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/cfg_manager/CFGClient.h>
+#include <mars/utils/Thread.h>
+#include <mars/utils/Mutex.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_shm {
+
+    /**
+     * \brief Bridge between the DataBroker and out-of-process consumers.
+     *
+     * All elements that match one of the configured patterns are mirrored
+     * into a shared memory segment (see ShmLayout.h). The bridge is a
+     * synchronous receiver of these elements and writes the new values
+     * directly into the segment, so a client sees an update as soon as it
+     * is pushed. Commands that a client writes to a writable element are
+     * picked up by the command thread and pushed into the DataBroker.
+     *
+     * The cfg group "DataBrokerShm" holds the segment name, the segment
+     * size, and the mirrored streams as a list of "group:data" patterns
+     * separated by ';'. Use ShmClient to access the segment.
+     */
+    class DataBrokerShm : public lib_manager::LibInterface,
+                          public data_broker::ReceiverInterface,
+                          public cfg_manager::CFGClient,
+                          public utils::Thread {
+    public:
+      DataBrokerShm(lib_manager::LibManager *theManager);
+      ~DataBrokerShm();
+
+      // LibInterface methods
+      int getLibVersion() const
+      { return 1; }
+      const std::string getLibName() const
+      { return std::string("data_broker_shm"); }
+      CREATE_MODULE_INFO();
+
+      /**
+       * \brief creates the segment and registers the mirrored streams.
+       *        Fails if a segment with the name already exists.
+       */
+      bool open(const std::string &segmentName, size_t size,
+                const std::string &streams);
+      void close();
+
+      // DataBroker ReceiverInterface
+      virtual void receiveData(const data_broker::DataInfo &info,
+                               const data_broker::DataPackage &package,
+                               int callbackParam);
+
+      // CFGClient
+      virtual void cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property);
+
+    protected:
+      /// the command thread
+      void run();
+
+    private:
+      enum { SLOT_NONE = -1, SLOT_FULL = -2 };
+
+      /**
+       * The layout of the slot is kept here and never read back from the
+       * segment, clients can write to the whole segment.
+       */
+      struct MirroredElement {
+        long slot;
+        unsigned long dataId;
+        std::vector<data_broker::DataType> types;
+        std::vector<uint32_t> cellOffsets;
+        uint64_t stateOffset, commandOffset;
+        uint32_t dataSize;
+        data_broker::DataPackage commandPackage;
+        uint32_t lastCommand;
+      };
+
+      long createSlot(const data_broker::DataInfo &info,
+                      const data_broker::DataPackage &package,
+                      MirroredElement *element);
+      void writeState(const MirroredElement &element,
+                      const data_broker::DataPackage &package);
+      void processCommands();
+
+      data_broker::DataBrokerInterface *dataBroker;
+      cfg_manager::CFGManagerInterface *cfg;
+
+      ShmHeader *header;
+      size_t segmentSize;
+      uint64_t dataEnd;  ///< allocation pointer of the segment
+      uint32_t numSlots;
+      std::string segmentName;
+      std::vector<std::pair<std::string, std::string> > patterns;
+
+      utils::Mutex slotMutex;
+      std::vector<MirroredElement> elements; ///< indexed by the DataBroker id
+      std::vector<unsigned long> writableElements;
+      std::vector<char> commandBuffer;
+      volatile bool stopThread;
+      bool threadStarted;
+
+      cfg_manager::cfgPropertyStruct cfgSegmentName, cfgSegmentSize;
+      cfg_manager::cfgPropertyStruct cfgStreams;
+
+    }; // end of class DataBrokerShm
+
+  } // end of namespace data_broker_shm
+} // end of namespace mars
+
+#endif // DATA_BROKER_SHM_H
@@ -0,0 +1,256 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ShmClient.h"
+
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace mars {
+  namespace data_broker_shm {
+
+    ShmClient::ShmClient() : header(NULL), segmentSize(0) {
+    }
+
+    ShmClient::~ShmClient() {
+      disconnect();
+    }
+
+    bool ShmClient::connect(const std::string &segmentName) {
+      struct stat segmentStat;
+
+      disconnect();
+      int fd = shm_open(segmentName.c_str(), O_RDWR, 0);
+      if(fd == -1 || fstat(fd, &segmentStat) != 0) {
+        fprintf(stderr, "ShmClient: could not open \"%s\": %s\n",
+                segmentName.c_str(), strerror(errno));
+        if(fd != -1) ::close(fd);
+        return false;
+      }
+      if((size_t)segmentStat.st_size < sizeof(ShmHeader)) {
+        fprintf(stderr, "ShmClient: \"%s\" is not ready\n",
+                segmentName.c_str());
+        ::close(fd);
+        return false;
+      }
+      void *mapping = mmap(NULL, segmentStat.st_size,
+                           PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if(mapping == MAP_FAILED) {
+        fprintf(stderr, "ShmClient: could not map \"%s\": %s\n",
+                segmentName.c_str(), strerror(errno));
+        return false;
+      }
+      ShmHeader *newHeader = (ShmHeader*)mapping;
+      if(memcmp(newHeader->magic, SHM_MAGIC, sizeof(newHeader->magic)) != 0 ||
+         newHeader->version != SHM_VERSION) {
+        fprintf(stderr, "ShmClient: \"%s\" is not a DataBroker segment\n",
+                segmentName.c_str());
+        munmap(mapping, segmentStat.st_size);
+        return false;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      header = newHeader;
+      segmentSize = segmentStat.st_size;
+      return true;
+    }
+
+    void ShmClient::disconnect() {
+      if(header) {
+        munmap(header, segmentSize);
+        header = NULL;
+        segmentSize = 0;
+      }
+    }
+
+    int ShmClient::getNumStreams() const {
+      if(!header) return 0;
+      return header->numSlots.load(std::memory_order_acquire);
+    }
+
+    const ShmSlot* ShmClient::getSlot(int stream) const {
+      if(stream < 0 || stream >= getNumStreams()) return NULL;
+      return &header->slots[stream];
+    }
+
+    const ShmItem* ShmClient::getItems(const ShmSlot *slot) const {
+      return (const ShmItem*)((const char*)header + slot->itemsOffset);
+    }
+
+    int ShmClient::findStream(const std::string &groupName,
+                              const std::string &dataName) const {
+      // search backwards, a retired slot is always followed by its successor
+      for(int i = getNumStreams() - 1; i >= 0; --i) {
+        const ShmSlot *slot = &header->slots[i];
+        if(groupName == slot->groupName && dataName == slot->dataName) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+    bool ShmClient::getStreamInfo(int stream, ShmStreamInfo *info) const {
+      const ShmSlot *slot = getSlot(stream);
+      if(!slot) return false;
+      const ShmItem *items = getItems(slot);
+      info->groupName = slot->groupName;
+      info->dataName = slot->dataName;
+      info->writable = slot->flags.load() & SHM_SLOT_WRITE;
+      info->itemNames.resize(slot->numItems);
+      info->itemTypes.resize(slot->numItems);
+      for(uint32_t i = 0; i < slot->numItems; ++i) {
+        info->itemNames[i] = items[i].name;
+        info->itemTypes[i] = (ShmType)items[i].type;
+      }
+      return true;
+    }
+
+    int ShmClient::findItem(int stream, const std::string &itemName) const {
+      const ShmSlot *slot = getSlot(stream);
+      if(!slot) return -1;
+      const ShmItem *items = getItems(slot);
+      for(uint32_t i = 0; i < slot->numItems; ++i) {
+        if(itemName == items[i].name) return i;
+      }
+      return -1;
+    }
+
+    void ShmClient::readCells(const ShmSlot *slot, uint32_t *sequence) const {
+      cells.resize(slot->dataSize);
+      uint32_t s = utils::shmSeqRead(&slot->stateSequence, &cells[0],
+                                     (const char*)header + slot->stateOffset,
+                                     slot->dataSize);
+      if(sequence) *sequence = s;
+    }
+
+    bool ShmClient::read(int stream, std::vector<double> *values,
+                         uint32_t *sequence) const {
+      const ShmSlot *slot = getSlot(stream);
+      if(!slot) return false;
+      const ShmItem *items = getItems(slot);
+      readCells(slot, sequence);
+      values->resize(slot->numItems);
+      for(uint32_t i = 0; i < slot->numItems; ++i) {
+        const char *cell = &cells[items[i].offset];
+        int64_t l;
+        uint64_t ul;
+        switch(items[i].type) {
+        case SHM_INT_TYPE:
+        case SHM_LONG_TYPE:
+        case SHM_BOOL_TYPE:
+          memcpy(&l, cell, sizeof(l));
+          (*values)[i] = l;
+          break;
+        case SHM_UINT_TYPE:
+        case SHM_ULONG_TYPE:
+          memcpy(&ul, cell, sizeof(ul));
+          (*values)[i] = ul;
+          break;
+        case SHM_FLOAT_TYPE:
+        case SHM_DOUBLE_TYPE:
+          memcpy(&(*values)[i], cell, sizeof(double));
+          break;
+        default:
+          (*values)[i] = 0.0;
+          break;
+        }
+      }
+      return true;
+    }
+
+    bool ShmClient::readString(int stream, int item,
+                               std::string *value) const {
+      const ShmSlot *slot = getSlot(stream);
+      if(!slot || item < 0 || (uint32_t)item >= slot->numItems) return false;
+      const ShmItem *items = getItems(slot);
+      if(items[item].type != SHM_STRING_TYPE) return false;
+      readCells(slot, NULL);
+      const char *cell = &cells[items[item].offset];
+      value->assign(cell, strnlen(cell, SHM_STRING_SIZE));
+      return true;
+    }
+
+    int64_t ShmClient::getUpdateTime(int stream) const {
+      const ShmSlot *slot = getSlot(stream);
+      if(!slot) return 0;
+      return slot->stateTime.load(std::memory_order_relaxed);
+    }
+
+    bool ShmClient::write(int stream, const std::vector<double> &values) {
+      const ShmSlot *constSlot = getSlot(stream);
+      if(!constSlot || !(constSlot->flags.load() & SHM_SLOT_WRITE) ||
+         values.size() != constSlot->numItems) {
+        return false;
+      }
+      ShmSlot *slot = &header->slots[stream];
+      const ShmItem *items = getItems(slot);
+      char *commandCells = (char*)header + slot->commandOffset;
+
+      uint32_t s = utils::shmSeqWriteBegin(&slot->commandSequence);
+      for(uint32_t i = 0; i < slot->numItems; ++i) {
+        char *cell = commandCells + items[i].offset;
+        int64_t l;
+        uint64_t ul;
+        switch(items[i].type) {
+        case SHM_INT_TYPE:
+        case SHM_LONG_TYPE:
+        case SHM_BOOL_TYPE:
+          l = (int64_t)values[i];
+          memcpy(cell, &l, sizeof(l));
+          break;
+        case SHM_UINT_TYPE:
+        case SHM_ULONG_TYPE:
+          ul = (uint64_t)values[i];
+          memcpy(cell, &ul, sizeof(ul));
+          break;
+        case SHM_FLOAT_TYPE:
+        case SHM_DOUBLE_TYPE:
+          memcpy(cell, &values[i], sizeof(double));
+          break;
+        default:
+          break;
+        }
+      }
+      utils::shmSeqWriteEnd(&slot->commandSequence, s);
+      header->commandNotify.fetch_add(1);
+      utils::shmWake(&header->commandNotify, &header->commandWaiters);
+      return true;
+    }
+
+    uint32_t ShmClient::getNotifyCount() const {
+      if(!header) return 0;
+      return header->notify.load();
+    }
+
+    uint32_t ShmClient::waitForUpdate(uint32_t notifyCount,
+                                      long timeoutMilliseconds) {
+      if(!header) return 0;
+      utils::shmWait(&header->notify, &header->notifyWaiters, notifyCount,
+                     timeoutMilliseconds);
+      return header->notify.load();
+    }
+
+  } // end of namespace data_broker_shm
+} // end of namespace mars
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file ShmClient.h
+ * \brief Client side of the shared memory DataBroker bridge.
+ *
+ * The client only depends on the standard library and can be used by
+ * processes that do not link against the MARS libraries.
+ */
+
+#ifndef DATA_BROKER_SHM_CLIENT_H
+#define DATA_BROKER_SHM_CLIENT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ShmClient.h"
+#endif
+
+#include "ShmLayout.h"
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace data_broker_shm {
+
+    struct ShmStreamInfo {
+      std::string groupName;
+      std::string dataName;
+      bool writable;
+      std::vector<std::string> itemNames;
+      std::vector<ShmType> itemTypes;
+    };
+
+    /**
+     * \brief Reads mirrored DataBroker streams from the shared memory
+     *        segment and sends commands back.
+     *
+     * A stream is addressed by its slot index as returned by findStream().
+     * If the layout of a stream changes, the bridge retires its slot and
+     * creates a new one; findStream() then returns the new slot.
+     *
+     * Reading is lock free and can be done from any number of threads and
+     * processes. Each writable stream must only be written by one thread.
+     */
+    class ShmClient {
+    public:
+      ShmClient();
+      ~ShmClient();
+
+      bool connect(const std::string &segmentName="/mars_data_broker");
+      void disconnect();
+
+      bool isConnected() const
+      { return header != NULL; }
+
+      /** \brief returns the number of slots; it grows while the bridge runs */
+      int getNumStreams() const;
+
+      /**
+       * \brief returns the current slot of the stream or -1 if the stream
+       *        is not mirrored (yet).
+       */
+      int findStream(const std::string &groupName,
+                     const std::string &dataName) const;
+
+      bool getStreamInfo(int stream, ShmStreamInfo *info) const;
+
+      /** \brief returns the index of the item or -1 */
+      int findItem(int stream, const std::string &itemName) const;
+
+      /**
+       * \brief reads a consistent state of \a stream.
+       *
+       * Numeric items are converted to double. String items are read as 0.
+       * \param sequence If not \c NULL receives the sequence of the state.
+       *                 It changes with every update of the stream.
+       */
+      bool read(int stream, std::vector<double> *values,
+                uint32_t *sequence=NULL) const;
+
+      /** \brief reads a consistent state of a string item of \a stream */
+      bool readString(int stream, int item, std::string *value) const;
+
+      /** \brief returns the time of the last update in ns (CLOCK_MONOTONIC) */
+      int64_t getUpdateTime(int stream) const;
+
+      /**
+       * \brief sends a command to a writable stream.
+       *
+       * \a values contains one value for each item of the stream. The
+       * bridge pushes the command into the DataBroker.
+       */
+      bool write(int stream, const std::vector<double> &values);
+
+      /** \brief returns a counter that is incremented with every update */
+      uint32_t getNotifyCount() const;
+
+      /**
+       * \brief blocks until any stream was updated after \a notifyCount
+       *        was read or \a timeoutMilliseconds passed.
+       * \return the current notify count
+       */
+      uint32_t waitForUpdate(uint32_t notifyCount, long timeoutMilliseconds);
+
+    private:
+      const ShmSlot* getSlot(int stream) const;
+      const ShmItem* getItems(const ShmSlot *slot) const;
+      void readCells(const ShmSlot *slot, uint32_t *sequence) const;
+
+      ShmHeader *header;
+      size_t segmentSize;
+      mutable std::vector<char> cells;
+
+    }; // end of class ShmClient
+
+  } // end of namespace data_broker_shm
+} // end of namespace mars
+
+#endif // DATA_BROKER_SHM_CLIENT_H
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file ShmLayout.h
+ * \brief Layout of the shared memory segment of the DataBroker bridge.
+ *
+ * The segment starts with a ShmHeader followed by a fixed table of
+ * ShmSlot descriptors. Each mirrored DataBroker element gets one slot.
+ * The item descriptors and the value cells of the slots are allocated
+ * behind the table. Slots are only appended; \c numSlots is incremented
+ * after a slot is completely initialized.
+ *
+ * Every numeric item occupies an 8 byte cell in its native representation
+ * (int64_t, uint64_t, or double). Strings occupy a zero terminated cell
+ * of SHM_STRING_SIZE bytes. A slot has two value areas: the state written
+ * by the bridge and the command written by a client. Both are protected
+ * by a seqlock of mars/utils/ShmSeqLock.h.
+ *
+ * \c notify is incremented after every state update and \c commandNotify
+ * after every command. On Linux both are futex words; waiting processes
+ * are only woken if they announced themselves in the waiter counters.
+ *
+ * This header is shared by the bridge and the client library and only
+ * depends on the standard library and the header only ShmSeqLock.h.
+ */
+
+#ifndef DATA_BROKER_SHM_LAYOUT_H
+#define DATA_BROKER_SHM_LAYOUT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ShmLayout.h"
+#endif
+
+#include <mars/utils/ShmSeqLock.h>
+
+#include <atomic>
+#include <stdint.h>
+
+namespace mars {
+  namespace data_broker_shm {
+
+    const char SHM_MAGIC[8] = {'M', 'D', 'B', 'S', 'H', 'M', 0, 0};
+    const uint32_t SHM_VERSION = 1;
+    const uint32_t SHM_MAX_SLOTS = 4096;
+    const uint32_t SHM_NAME_SIZE = 128;
+    const uint32_t SHM_STRING_SIZE = 64;
+    const uint32_t SHM_CELL_SIZE = 8;
+    /// attempts of the bridge to read a command before it skips it
+    const int SHM_READ_RETRIES = 1000;
+
+    /// same values as mars::data_broker::DataType
+    enum ShmType {
+      SHM_UNDEFINED_TYPE,
+      SHM_INT_TYPE,
+      SHM_LONG_TYPE,
+      SHM_FLOAT_TYPE,
+      SHM_DOUBLE_TYPE,
+      SHM_BOOL_TYPE,
+      SHM_STRING_TYPE,
+      SHM_UINT_TYPE,
+      SHM_ULONG_TYPE
+    };
+
+    enum ShmSlotFlags {
+      SHM_SLOT_READ = (1 << 0),    ///< same as DATA_PACKAGE_READ_FLAG
+      SHM_SLOT_WRITE = (1 << 1),   ///< clients may send commands
+      SHM_SLOT_RETIRED = (1 << 8)  ///< the layout changed, see next slot
+    };
+
+    struct ShmItem {
+      char name[SHM_NAME_SIZE];
+      uint32_t type;
+      uint32_t offset;       ///< byte offset of the cell in the value area
+    };
+
+    struct ShmSlot {
+      char groupName[SHM_NAME_SIZE];
+      char dataName[SHM_NAME_SIZE];
+      std::atomic<uint32_t> flags;
+      uint32_t numItems;
+      uint64_t itemsOffset;   ///< segment offset of the ShmItem array
+      uint64_t stateOffset;   ///< segment offset of the state cells
+      uint64_t commandOffset; ///< segment offset of the command cells
+      uint32_t dataSize;      ///< bytes of each value area
+      std::atomic<uint32_t> stateSequence;
+      std::atomic<uint32_t> commandSequence;
+      std::atomic<int64_t> stateTime; ///< ns, CLOCK_MONOTONIC
+    };
+
+    struct ShmHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t maxSlots;
+      uint64_t size;
+      std::atomic<uint32_t> numSlots;
+      std::atomic<uint32_t> notify;
+      std::atomic<uint32_t> notifyWaiters;
+      std::atomic<uint32_t> commandNotify;
+      std::atomic<uint32_t> commandWaiters;
+      std::atomic<uint64_t> dataEnd; ///< allocation pointer
+      ShmSlot slots[SHM_MAX_SLOTS];
+    };
+
+    /** \brief returns the cell size of an item of the given type */
+    inline uint32_t shmCellSize(uint32_t type) {
+      return type == SHM_STRING_TYPE ? SHM_STRING_SIZE : SHM_CELL_SIZE;
+    }
+
+  } // end of namespace data_broker_shm
+} // end of namespace mars
+
+#endif // DATA_BROKER_SHM_LAYOUT_H
@@ -72,9 +72,9 @@ namespace mars {
         for(it=infoList.begin(); it!=infoList.end(); ++it) {
           if(it->flags & data_broker::DATA_PACKAGE_WRITE_FLAG) {
             addParam(*it);
-            dataBroker->registerTimedReceiver(this, it->groupName, it->dataName,
-                                              "_REALTIME_", 250);
-            //          dataBroker->registerAsyncReceiver(this, it->groupName, it->dataName);
+            dataBroker->registerAsyncReceiver(this, it->groupName, it->dataName,
+                                              0, data_broker::ASYNC_DECIMATE,
+                                              4.);
           }
         }
       }  
@@ -82,7 +82,6 @@ namespace mars {
 
     DataWidget::~DataWidget(void) {
       dataBroker->unregisterAsyncReceiver(this, "*", "*");
-      dataBroker->unregisterTimedReceiver(this, "*", "*", "_REALTIME_");
       dataBroker->unregisterSyncReceiver(this, "data_broker", "newStream");
       libManager->releaseLibrary("data_broker");
     }
@@ -109,9 +108,9 @@ namespace mars {
         dataPackage.get("flags", (int*)&newInfo.flags);
         if(showAll || newInfo.flags & data_broker::DATA_PACKAGE_WRITE_FLAG) {
           addParam(newInfo);
-          dataBroker->registerTimedReceiver(this, newInfo.groupName, 
-                                            newInfo.dataName, "_REALTIME_", 250);
-          //        dataBroker->registerAsyncReceiver(this, newInfo.groupName, newInfo.dataName);
+          dataBroker->registerAsyncReceiver(this, newInfo.groupName,
+                                            newInfo.dataName, 0,
+                                            data_broker::ASYNC_DECIMATE, 4.);
         }
       } else {
         map<unsigned long, paramWrapper>::iterator it;
@@ -278,7 +277,6 @@ namespace mars {
         bool newShowAll = value.toBool();
         assert(newShowAll != showAll);
         dataBroker->unregisterAsyncReceiver(this, "*", "*");
-        dataBroker->unregisterTimedReceiver(this, "*", "*", "_REALTIME_");
         changeMutex.lock();
         addMutex.lock();
         listMutex.lock();
@@ -301,9 +299,9 @@ namespace mars {
         for(it=infoList.begin(); it!=infoList.end(); ++it) {
           if(newShowAll || it->flags & data_broker::DATA_PACKAGE_WRITE_FLAG) {
             addParam(*it);
-            dataBroker->registerTimedReceiver(this, it->groupName, it->dataName,
-                                              "_REALTIME_", 250);
-            //dataBroker->registerAsyncReceiver(this, it->groupName, it->dataName);
+            dataBroker->registerAsyncReceiver(this, it->groupName, it->dataName,
+                                              0, data_broker::ASYNC_DECIMATE,
+                                              4.);
           }
         }
         return;
@@ -39,7 +39,8 @@ namespace mars {
 
     MainDataGui::MainDataGui(lib_manager::LibManager *theManager) :
       lib_manager::LibInterface(theManager),
-      gui(NULL), cfg(NULL), dataBroker(NULL), dataWidget(NULL) {
+      gui(NULL), cfg(NULL), dataBroker(NULL), dataWidget(NULL),
+      dataConnWidget(NULL), statsWidget(NULL) {
 
       // setup GUI with default path
       setupGUI("../resources/");
@@ -75,8 +76,14 @@ namespace mars {
       gui->addGenericMenuAction("../Data/DataBrokerConnections", 2, this, 0,
                                 path2, true);
 
+      path2 = path;
+      path2.append("/mars/data_broker_gui/resources/images/data_broker_symbol.png");
+      gui->addGenericMenuAction("../Data/DataBrokerStatistics", 3, this, 0,
+                                path2, true);
+
       dataWidget = NULL;//new DataWidget(dataBroker);
       dataConnWidget = NULL;
+      statsWidget = NULL;
       if(cfg) {
         if(!cfg->getOrCreateProperty("Windows", "DataBrokerWidget/hidden",
                                      true).bValue) {
@@ -87,6 +94,11 @@ namespace mars {
                                      true).bValue) {
           menuAction(2, false);
         }
+        if(!cfg->getOrCreateProperty("Windows",
+                                     "DataBrokerStatistics/hidden",
+                                     true).bValue) {
+          menuAction(3, false);
+        }
       }
 
     }
@@ -129,6 +141,16 @@ namespace mars {
           dataConnWidget = NULL;
         }
         break;
+      case 3:
+        if(statsWidget == NULL) {
+          statsWidget = new StatsWidget(this, libManager, dataBroker, cfg);
+          gui->addDockWidget((void*)statsWidget, 0);
+        }
+        else {
+          gui->removeDockWidget((void*)statsWidget, 0);
+          statsWidget = NULL;
+        }
+        break;
       }
     }
 
@@ -139,6 +161,7 @@ namespace mars {
     void MainDataGui::destroyWindow(QWidget *w) {
       if(w == dataWidget) dataWidget = NULL;
       else if(w == dataConnWidget) dataConnWidget = NULL;
+      else if(w == statsWidget) statsWidget = NULL;
     }
 
   } // end of namespace: data_broker_gui
@@ -33,6 +33,7 @@
 
 #include "DataWidget.h"
 #include "DataConnWidget.h"
+#include "StatsWidget.h"
 #include <lib_manager/LibInterface.hpp>
 #include <mars/cfg_manager/CFGManagerInterface.h>
 #include <mars/cfg_manager/CFGClient.h>
@@ -82,6 +83,7 @@ namespace mars {
       
       DataWidget* dataWidget;
       DataConnWidget* dataConnWidget;
+      StatsWidget* statsWidget;
 
     protected slots:
       void timerEvent(QTimerEvent* event);
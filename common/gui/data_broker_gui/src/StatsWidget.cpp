@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "StatsWidget.h"
+#include "MainDataGui.h"
+
+#include <mars/data_broker/DataBrokerInterface.h>
+
+#include <QVBoxLayout>
+#include <QStringList>
+
+namespace mars {
+  namespace data_broker_gui {
+
+    using namespace mars::data_broker;
+
+    enum { COLUMN_NAME=0, COLUMN_PUSH_RATE, COLUMN_KBYTES, COLUMN_SYNC,
+           COLUMN_ASYNC, COLUMN_TIMED, COLUMN_TRIGGERED, COLUMN_P50,
+           COLUMN_P99, COLUMN_COUNT };
+
+    static const char* kindNames[] = {"sync", "async", "timed", "triggered"};
+
+    StatsWidget::StatsWidget(MainDataGui *mainLib,
+                             lib_manager::LibManager* libManager,
+                             DataBrokerInterface *_dataBroker,
+                             cfg_manager::CFGManagerInterface *_cfg,
+                             QWidget *parent) :
+      mars::main_gui::BaseWidget(parent, _cfg, "DataBrokerStatistics"),
+      mainLib(mainLib), libManager(libManager), dataBroker(_dataBroker) {
+
+      libManager->getLibrary("data_broker");
+
+      QVBoxLayout *vLayout = new QVBoxLayout();
+      vLayout->setContentsMargins(1, 1, 1, 1);
+      treeWidget = new QTreeWidget(this);
+      treeWidget->setColumnCount(COLUMN_COUNT);
+      QStringList header;
+      header << "stream" << "push/s" << "kB/s" << "sync" << "async"
+             << "timed" << "triggered" << "p50 [us]" << "p99 [us]";
+      treeWidget->setHeaderLabels(header);
+      vLayout->addWidget(treeWidget);
+      setLayout(vLayout);
+
+      if(dataBroker) {
+        dataBroker->setStatisticsEnabled(true);
+      }
+      startTimer(1000);
+    }
+
+    StatsWidget::~StatsWidget() {
+      if(dataBroker) {
+        dataBroker->setStatisticsEnabled(false);
+      }
+      libManager->releaseLibrary("data_broker");
+    }
+
+    void StatsWidget::timerEvent(QTimerEvent* event) {
+      (void)event;
+      if(!dataBroker) return;
+
+      std::vector<DataElementStatistics> statistics;
+      std::vector<DataElementStatistics>::iterator it;
+      statistics = dataBroker->getStatistics();
+
+      for(it = statistics.begin(); it != statistics.end(); ++it) {
+        QTreeWidgetItem *item;
+        std::map<unsigned long, QTreeWidgetItem*>::iterator itemIt;
+        itemIt = items.find(it->info.dataId);
+        if(itemIt == items.end()) {
+          std::string name = it->info.groupName + "/" + it->info.dataName;
+          item = new QTreeWidgetItem(QStringList(QString::fromStdString(name)));
+          treeWidget->addTopLevelItem(item);
+          items[it->info.dataId] = item;
+        } else {
+          item = itemIt->second;
+        }
+        item->setText(COLUMN_PUSH_RATE, QString::number(it->pushRate, 'f', 1));
+        item->setText(COLUMN_KBYTES,
+                      QString::number(it->bytesPerSecond/1024., 'f', 1));
+        item->setText(COLUMN_SYNC, QString::number(it->numSyncReceivers));
+        item->setText(COLUMN_ASYNC, QString::number(it->numAsyncReceivers));
+        item->setText(COLUMN_TIMED, QString::number(it->numTimedReceivers));
+        item->setText(COLUMN_TRIGGERED,
+                      QString::number(it->numTriggeredReceivers));
+
+        // one child per measured receiver
+        while(item->childCount() > (int)it->receivers.size()) {
+          delete item->takeChild(item->childCount()-1);
+        }
+        for(size_t i = 0; i < it->receivers.size(); ++i) {
+          const ReceiverStatistics &receiver = it->receivers[i];
+          QTreeWidgetItem *child;
+          if((int)i < item->childCount()) {
+            child = item->child(i);
+          } else {
+            child = new QTreeWidgetItem(item);
+          }
+          child->setText(COLUMN_NAME, QString("%1 receiver 0x%2 (%3 samples)")
+                         .arg(kindNames[receiver.kind])
+                         .arg((qulonglong)(quintptr)receiver.receiver, 0, 16)
+                         .arg((qulonglong)receiver.samples));
+          child->setText(COLUMN_P50, QString::number(receiver.p50, 'f', 2));
+          child->setText(COLUMN_P99, QString::number(receiver.p99, 'f', 2));
+        }
+      }
+    }
+
+    void StatsWidget::closeEvent(QCloseEvent *e) {
+      (void)e;
+      mainLib->destroyWindow(this);
+    }
+
+  } // end of namespace: data_broker_gui
+} // end of namespace: mars
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file StatsWidget.h
+ * \brief Shows the per stream statistics of the DataBroker.
+ **/
+
+#ifndef STATS_WIDGET_H
+#define STATS_WIDGET_H
+
+#ifdef _PRINT_HEADER_
+#warning "StatsWidget.h"
+#endif
+
+#include <QWidget>
+#include <QCloseEvent>
+#include <QTimerEvent>
+#include <QTreeWidget>
+
+#include <mars/main_gui/BaseWidget.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+
+#include <map>
+
+namespace mars {
+  namespace data_broker {
+    class DataBrokerInterface;
+  }
+
+  namespace data_broker_gui {
+
+    class MainDataGui;
+
+    /**
+     * Enables the DataBroker statistics while it is open and refreshes
+     * the table once per second.
+     */
+    class StatsWidget : public mars::main_gui::BaseWidget {
+      Q_OBJECT;
+
+    public:
+      StatsWidget(MainDataGui *mainLib, lib_manager::LibManager* libManager,
+                  mars::data_broker::DataBrokerInterface *_dataBroker,
+                  mars::cfg_manager::CFGManagerInterface *_cfg,
+                  QWidget *parent = 0);
+      ~StatsWidget();
+
+    protected:
+      void closeEvent(QCloseEvent *event);
+
+    private:
+      MainDataGui *mainLib;
+      lib_manager::LibManager* libManager;
+      mars::data_broker::DataBrokerInterface *dataBroker;
+      QTreeWidget *treeWidget;
+      std::map<unsigned long, QTreeWidgetItem*> items;
+
+    protected slots:
+      void timerEvent(QTimerEvent* event);
+
+    };
+
+  } // end of namespace data_broker_gui
+} // end of namespace mars
+
+#endif // STATS_WIDGET_H
@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file ShmSeqLock.h
+ * \brief Seqlock and wait/wake helpers for data in shared memory.
+ *
+ * A seqlock protects data with one writer. The writer makes the sequence
+ * odd, changes the data and makes it even again. A reader retries until
+ * it read the same even sequence before and after copying the data.
+ *
+ * shmWait() and shmWake() block on and wake a 32 bit word. On Linux the
+ * word is a futex that is shared between processes; waiting processes are
+ * only woken if they announced themselves in the waiter counter. Other
+ * POSIX systems poll the word.
+ *
+ * The helpers are header only, so that programs outside of MARS can use
+ * them without linking against mars_utils.
+ */
+
+#ifndef MARS_UTILS_SHM_SEQ_LOCK_H
+#define MARS_UTILS_SHM_SEQ_LOCK_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ShmSeqLock.h"
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <climits>
+#endif
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+namespace mars {
+
+  namespace utils {
+
+    /**
+     * \brief starts a write to the data protected by the seqlock
+     *        \a sequence. There must only be one writer per seqlock.
+     * \return the value that has to be passed to shmSeqWriteEnd()
+     */
+    inline uint32_t shmSeqWriteBegin(std::atomic<uint32_t> *sequence) {
+      uint32_t s = sequence->load(std::memory_order_relaxed);
+      sequence->store(s + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      return s;
+    }
+
+    inline void shmSeqWriteEnd(std::atomic<uint32_t> *sequence, uint32_t s) {
+      sequence->store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * \brief copies \a size bytes from \a src to \a dst as writer of the
+     *        seqlock \a sequence.
+     */
+    inline void shmSeqWrite(std::atomic<uint32_t> *sequence, void *dst,
+                            const void *src, size_t size) {
+      uint32_t s = shmSeqWriteBegin(sequence);
+      memcpy(dst, src, size);
+      shmSeqWriteEnd(sequence, s);
+    }
+
+    /**
+     * \brief copies \a size bytes from \a src to \a dst as reader of the
+     *        seqlock \a sequence.
+     * \return the sequence of the copied data
+     */
+    inline uint32_t shmSeqRead(const std::atomic<uint32_t> *sequence,
+                               void *dst, const void *src, size_t size) {
+      uint32_t s1, s2;
+      do {
+        do {
+          s1 = sequence->load(std::memory_order_acquire);
+        } while(s1 & 1);
+        memcpy(dst, src, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = sequence->load(std::memory_order_relaxed);
+      } while(s1 != s2);
+      return s1;
+    }
+
+    /**
+     * \brief like shmSeqRead(), but gives up after \a maxRetries attempts,
+     *        e.g. if the writer died while writing.
+     * \return \c true and the sequence of the copied data in \a *sequenceOut
+     *         if a consistent copy was read
+     */
+    inline bool shmSeqTryRead(const std::atomic<uint32_t> *sequence,
+                              void *dst, const void *src, size_t size,
+                              int maxRetries, uint32_t *sequenceOut) {
+      uint32_t s1, s2;
+      for(int i = 0; i < maxRetries; ++i) {
+        s1 = sequence->load(std::memory_order_acquire);
+        if(s1 & 1) continue;
+        memcpy(dst, src, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = sequence->load(std::memory_order_relaxed);
+        if(s1 == s2) {
+          *sequenceOut = s1;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * \brief blocks while \a *word equals \a value, at most
+     *        \a timeoutMilliseconds or without limit if it is negative.
+     */
+    inline void shmWait(std::atomic<uint32_t> *word,
+                        std::atomic<uint32_t> *waiters,
+                        uint32_t value, long timeoutMilliseconds) {
+      waiters->fetch_add(1);
+#ifdef __linux__
+      // the futex is shared between processes, so no FUTEX_PRIVATE_FLAG
+      timespec timeout = {timeoutMilliseconds / 1000,
+                          (timeoutMilliseconds % 1000) * 1000000};
+      if(word->load() == value) {
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, value,
+                timeoutMilliseconds < 0 ? NULL : &timeout, NULL, 0);
+      }
+#elif !defined(WIN32)
+      // poll where no futex is available
+      for(long t = 0; word->load() == value &&
+            (timeoutMilliseconds < 0 || t < timeoutMilliseconds); ++t) {
+        usleep(1000);
+      }
+#endif
+      waiters->fetch_sub(1);
+    }
+
+    /** \brief wakes all processes blocked in shmWait() on \a word */
+    inline void shmWake(std::atomic<uint32_t> *word,
+                        std::atomic<uint32_t> *waiters) {
+#ifdef __linux__
+      if(waiters->load()) {
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX,
+                NULL, NULL, 0);
+      }
+#else
+      (void)word;
+      (void)waiters;
+#endif
+    }
+
+  } // end of namespace utils
+
+} // end of namespace mars
+
+#endif // MARS_UTILS_SHM_SEQ_LOCK_H
@@ -0,0 +1,217 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Trace.h"
+#include "Mutex.h"
+#include "MutexLocker.h"
+#include "misc.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+namespace mars {
+
+  namespace utils {
+
+    /// \cond HIDDEN_SYMBOLS
+    struct TraceEvent {
+      int64_t begin, end;
+      char name[TRACE_NAME_LENGTH];
+    };
+
+    struct TraceBuffer {
+      TraceEvent events[TRACE_BUFFER_SIZE];
+      // number of events ever written, only the writing thread stores it
+      std::atomic<uint64_t> head;
+      // events before this one were dropped by Trace::clear()
+      std::atomic<uint64_t> start;
+      int id;
+      std::string threadName;
+    };
+
+    struct TraceRegistry {
+      Mutex mutex;
+      std::vector<TraceBuffer*> buffers;
+      std::string exitFile;
+
+      TraceRegistry() {
+        const char *file = getenv("MARS_TRACE_FILE");
+        if(file && *file) {
+          exitFile = file;
+          Trace::setEnabled(true);
+        }
+      }
+
+      ~TraceRegistry() {
+        if(!exitFile.empty()) {
+          Trace::writeChromeTrace(exitFile);
+        }
+      }
+    };
+
+    static TraceRegistry& registry() {
+      static TraceRegistry theRegistry;
+      return theRegistry;
+    }
+
+    // make sure MARS_TRACE_FILE is handled at startup
+    static TraceRegistry &initRegistry = registry();
+
+    static thread_local TraceBuffer *threadBuffer = NULL;
+    static thread_local char threadName[64] = "";
+
+    static TraceBuffer* createThreadBuffer() {
+      TraceBuffer *buffer = new TraceBuffer;
+      buffer->head.store(0);
+      buffer->start.store(0);
+      buffer->threadName = threadName;
+      TraceRegistry &r = registry();
+      MutexLocker locker(&r.mutex);
+      buffer->id = (int)r.buffers.size() + 1;
+      r.buffers.push_back(buffer);
+      return buffer;
+    }
+
+    static void writeEscaped(FILE *file, const char *s) {
+      for(; *s; ++s) {
+        if(*s == '"' || *s == '\\') fputc('\\', file);
+        if((unsigned char)*s >= 0x20) fputc(*s, file);
+      }
+    }
+    /// \endcond
+
+    std::atomic<bool> Trace::enabled(false);
+
+    void Trace::setEnabled(bool enable) {
+      enabled.store(enable);
+    }
+
+    int64_t Trace::now() {
+      return getTimeNs();
+    }
+
+    void Trace::record(const char *name, int64_t begin, int64_t end) {
+      TraceBuffer *buffer = threadBuffer;
+      if(!buffer) {
+        buffer = threadBuffer = createThreadBuffer();
+      }
+      uint64_t head = buffer->head.load(std::memory_order_relaxed);
+      TraceEvent &event = buffer->events[head % TRACE_BUFFER_SIZE];
+      event.begin = begin;
+      event.end = end;
+      strncpy(event.name, name, TRACE_NAME_LENGTH - 1);
+      event.name[TRACE_NAME_LENGTH - 1] = '\0';
+      buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void Trace::setThreadName(const std::string &name) {
+      strncpy(threadName, name.c_str(), sizeof(threadName) - 1);
+      if(threadBuffer) {
+        TraceRegistry &r = registry();
+        MutexLocker locker(&r.mutex);
+        threadBuffer->threadName = threadName;
+      }
+    }
+
+    void Trace::clear() {
+      TraceRegistry &r = registry();
+      MutexLocker locker(&r.mutex);
+      for(size_t i = 0; i < r.buffers.size(); ++i) {
+        r.buffers[i]->start.store(r.buffers[i]->head.load());
+      }
+    }
+
+    bool Trace::writeChromeTrace(const std::string &filename) {
+      FILE *file = fopen(filename.c_str(), "w");
+      if(!file) {
+        fprintf(stderr, "Trace: could not write \"%s\"\n", filename.c_str());
+        return false;
+      }
+#ifndef WIN32
+      int pid = (int)getpid();
+#else
+      int pid = 1;
+#endif
+      TraceRegistry &r = registry();
+      MutexLocker locker(&r.mutex);
+      std::vector<TraceEvent> events;
+      bool first = true;
+
+      fprintf(file, "{\"traceEvents\":[");
+      for(size_t i = 0; i < r.buffers.size(); ++i) {
+        TraceBuffer *buffer = r.buffers[i];
+        if(!buffer->threadName.empty()) {
+          fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                  "\"tid\":%d,\"args\":{\"name\":\"", first ? "" : ",",
+                  pid, buffer->id);
+          writeEscaped(file, buffer->threadName.c_str());
+          fprintf(file, "\"}}");
+          first = false;
+        }
+
+        // the owning thread keeps writing, events that were overwritten
+        // while they were copied are dropped; that includes the slot of
+        // event newHead, which is written before head is published
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = buffer->start.load();
+        if(head > TRACE_BUFFER_SIZE && begin < head - TRACE_BUFFER_SIZE) {
+          begin = head - TRACE_BUFFER_SIZE;
+        }
+        events.clear();
+        for(uint64_t k = begin; k < head; ++k) {
+          events.push_back(buffer->events[k % TRACE_BUFFER_SIZE]);
+        }
+        uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+        size_t skip = 0;
+        if(newHead >= TRACE_BUFFER_SIZE &&
+           begin <= newHead - TRACE_BUFFER_SIZE) {
+          skip = newHead - TRACE_BUFFER_SIZE + 1 - begin;
+        }
+
+        for(size_t k = skip; k < events.size(); ++k) {
+          fprintf(file, "%s\n{\"name\":\"", first ? "" : ",");
+          writeEscaped(file, events[k].name);
+          fprintf(file, "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                  "\"ts\":%.3f,\"dur\":%.3f}", pid, buffer->id,
+                  events[k].begin * 1e-3,
+                  (events[k].end - events[k].begin) * 1e-3);
+          first = false;
+        }
+      }
+      fprintf(file, "\n]}\n");
+      fclose(file);
+      return true;
+    }
+
+    void Trace::setExitFile(const std::string &filename) {
+      TraceRegistry &r = registry();
+      MutexLocker locker(&r.mutex);
+      r.exitFile = filename;
+    }
+
+  } // end of namespace utils
+
+} // end of namespace mars
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file Trace.h
+ * \brief Scoped timing of code sections of all threads, exported in the
+ *        Chrome trace event format.
+ *
+ * A section is traced with MARS_TRACE_SCOPE("name") or
+ * MARS_TRACE_SCOPE_DYNAMIC(string). Every thread records into its own
+ * ring buffer of TRACE_BUFFER_SIZE events, so only the latest events of a
+ * thread are kept. Recording does not lock and does not allocate once the
+ * buffer of a thread exists. While tracing is disabled a scope costs one
+ * atomic load.
+ *
+ * writeChromeTrace() writes the recorded events as JSON that can be loaded
+ * into chrome://tracing or Perfetto. If the environment variable
+ * MARS_TRACE_FILE is set, tracing starts enabled and the trace is written
+ * to that file on exit.
+ *
+ * Defining MARS_NO_TRACE removes the macros at compile time.
+ */
+
+#ifndef MARS_UTILS_TRACE_H
+#define MARS_UTILS_TRACE_H
+
+#ifdef _PRINT_HEADER_
+  #warning "Trace.h"
+#endif
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+namespace mars {
+
+  namespace utils {
+
+    const unsigned int TRACE_BUFFER_SIZE = 1 << 15;
+    const unsigned int TRACE_NAME_LENGTH = 48;
+
+    class Trace {
+    public:
+      static inline bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+      }
+      static void setEnabled(bool enable);
+
+      /** \brief monotonic time in nanoseconds */
+      static int64_t now();
+
+      /** \brief records a section of the calling thread */
+      static void record(const char *name, int64_t begin, int64_t end);
+
+      /** \brief names the calling thread in the trace */
+      static void setThreadName(const std::string &name);
+
+      /** \brief drops all recorded events */
+      static void clear();
+
+      /**
+       * \brief writes the recorded events of all threads to \a filename
+       * \return \c false if the file could not be written
+       */
+      static bool writeChromeTrace(const std::string &filename);
+
+      /** \brief file that is written on exit, empty for none */
+      static void setExitFile(const std::string &filename);
+
+    private:
+      static std::atomic<bool> enabled;
+    };
+
+    /** \brief Records the lifetime of the object as a section. */
+    class TraceScope {
+    public:
+      explicit TraceScope(const char *name)
+        : name(name), begin(Trace::isEnabled() ? Trace::now() : 0) {}
+      ~TraceScope() {
+        if(begin) Trace::record(name, begin, Trace::now());
+      }
+    private:
+      // disallow copying
+      TraceScope(const TraceScope &);
+      TraceScope &operator=(const TraceScope &);
+
+      const char *name;
+      int64_t begin;
+    };
+
+  } // end of namespace utils
+
+} // end of namespace mars
+
+#ifndef MARS_NO_TRACE
+  #define MARS_TRACE_CONCAT_(a, b) a ## b
+  #define MARS_TRACE_CONCAT(a, b) MARS_TRACE_CONCAT_(a, b)
+  /** \brief traces the enclosing scope under the string literal \a name */
+  #define MARS_TRACE_SCOPE(name)                                          \
+    mars::utils::TraceScope MARS_TRACE_CONCAT(marsTraceScope, __LINE__)(name)
+  /** \brief like MARS_TRACE_SCOPE for a std::string that outlives the scope */
+  #define MARS_TRACE_SCOPE_DYNAMIC(name)                                  \
+    mars::utils::TraceScope MARS_TRACE_CONCAT(marsTraceScope, __LINE__)((name).c_str())
+  #define MARS_TRACE_THREAD_NAME(name) mars::utils::Trace::setThreadName(name)
+#else
+  #define MARS_TRACE_SCOPE(name)
+  #define MARS_TRACE_SCOPE_DYNAMIC(name)
+  #define MARS_TRACE_THREAD_NAME(name)
+#endif
+
+#endif // MARS_UTILS_TRACE_H
@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file TripleBuffer.h
+ * \brief Lock-free exchange of the latest value between one writer and one
+ *        reader.
+ */
+
+#ifndef MARS_UTILS_TRIPLE_BUFFER_H
+#define MARS_UTILS_TRIPLE_BUFFER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "TripleBuffer.h"
+#endif
+
+#include <atomic>
+
+namespace mars {
+
+  namespace utils {
+
+    /**
+     * \brief Three instances of \a T shared by one writer and one reader.
+     *
+     * The writer fills getWriteBuffer() and calls publish(). The reader
+     * calls update() to take the latest published buffer and reads it with
+     * getReadBuffer(). Neither side ever waits for the other one, values
+     * that are published before the reader takes them are overwritten.
+     * The buffers are reused, so a container of \a T only allocates while
+     * it grows.
+     */
+    template <typename T>
+    class TripleBuffer {
+    public:
+      TripleBuffer() : writeIndex(0), middle(1), readIndex(2) {}
+
+      inline T& getWriteBuffer() {
+        return buffers[writeIndex];
+      }
+
+      /** \brief hands the write buffer to the reader */
+      inline void publish() {
+        writeIndex = middle.exchange(writeIndex | NEW_DATA,
+                                     std::memory_order_acq_rel) & INDEX_MASK;
+      }
+
+      /**
+       * \brief takes the latest published buffer
+       * \return \c false if nothing was published since the last call
+       */
+      inline bool update() {
+        if(!(middle.load(std::memory_order_relaxed) & NEW_DATA)) {
+          return false;
+        }
+        readIndex = middle.exchange(readIndex,
+                                    std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+      }
+
+      inline const T& getReadBuffer() const {
+        return buffers[readIndex];
+      }
+
+    private:
+      enum { INDEX_MASK = 3, NEW_DATA = 4 };
+
+      // disallow copying
+      TripleBuffer(const TripleBuffer &);
+      TripleBuffer &operator=(const TripleBuffer &);
+
+      T buffers[3];
+      int writeIndex;
+      std::atomic<int> middle;
+      int readIndex;
+    };
+
+  } // end of namespace utils
+
+} // end of namespace mars
+
+#endif // MARS_UTILS_TRIPLE_BUFFER_H
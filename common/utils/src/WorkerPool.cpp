@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "WorkerPool.h"
+#include "Trace.h"
+
+namespace mars {
+  namespace utils {
+
+    static void* createPoolThread(void *theObject) {
+      ((WorkerPool*)theObject)->runWorker();
+      pthread_exit(NULL);
+      return 0;
+    }
+
+    WorkerPool::WorkerPool(int numThreads) :
+      generation(0), stop(false), activeWorkers(0), job(NULL),
+      numTasks(0), nextTask(0) {
+      for(int i = 0; i < numThreads; ++i) {
+        pthread_t thread;
+        if(pthread_create(&thread, NULL, createPoolThread, (void*)this) == 0) {
+          threads.push_back(thread);
+        }
+      }
+    }
+
+    WorkerPool::~WorkerPool() {
+      mutex.lock();
+      stop = true;
+      startCondition.wakeAll();
+      mutex.unlock();
+      for(size_t i = 0; i < threads.size(); ++i) {
+        pthread_join(threads[i], NULL);
+      }
+    }
+
+    void WorkerPool::execute(WorkerJob *job, size_t numTasks) {
+      if(threads.empty() || numTasks < 2 ||
+         executeMutex.tryLock() != MUTEX_ERROR_NO_ERROR) {
+        for(size_t i = 0; i < numTasks; ++i) {
+          job->runTask(i);
+        }
+        return;
+      }
+      mutex.lock();
+      this->job = job;
+      this->numTasks = numTasks;
+      nextTask.store(0);
+      ++generation;
+      startCondition.wakeAll();
+      mutex.unlock();
+
+      work();
+
+      // workers that claimed a task are active until it is done
+      mutex.lock();
+      while(activeWorkers > 0) {
+        doneCondition.wait(&mutex);
+      }
+      this->job = NULL;
+      mutex.unlock();
+      executeMutex.unlock();
+    }
+
+    void WorkerPool::runWorker() {
+      unsigned long seen = 0;
+      MARS_TRACE_THREAD_NAME("worker");
+      mutex.lock();
+      while(true) {
+        while(!stop && generation == seen) {
+          startCondition.wait(&mutex);
+        }
+        if(stop) break;
+        seen = generation;
+        if(job) {
+          ++activeWorkers;
+          mutex.unlock();
+          work();
+          mutex.lock();
+          if(--activeWorkers == 0) {
+            doneCondition.wakeAll();
+          }
+        }
+      }
+      mutex.unlock();
+    }
+
+    void WorkerPool::work() {
+      // job and numTasks are only changed while no worker is active
+      size_t index;
+      while((index = nextTask.fetch_add(1)) < numTasks) {
+        job->runTask(index);
+      }
+    }
+
+  } // end of namespace utils
+} // end of namespace mars
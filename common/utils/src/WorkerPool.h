@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file WorkerPool.h
+ * \brief A fixed set of worker threads that run the tasks of a job
+ *        concurrently.
+ */
+
+#ifndef MARS_UTILS_WORKER_POOL_H
+#define MARS_UTILS_WORKER_POOL_H
+
+#ifdef _PRINT_HEADER_
+  #warning "WorkerPool.h"
+#endif
+
+#include "Mutex.h"
+#include "WaitCondition.h"
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+#include <pthread.h>
+
+namespace mars {
+
+  namespace utils {
+
+    /** \brief A job of the WorkerPool that consists of indexed tasks. */
+    class WorkerJob {
+    public:
+      virtual ~WorkerJob() {}
+      /** \brief Runs task \a index. Tasks of one job run concurrently. */
+      virtual void runTask(size_t index) = 0;
+    };
+
+    /**
+     * A fixed set of worker threads. execute() hands out the task indices
+     * of a job to the workers and to the calling thread and returns when
+     * all tasks are done. Only one job runs at a time; a concurrent caller
+     * runs its job on its own thread.
+     */
+    class WorkerPool {
+    public:
+      explicit WorkerPool(int numThreads);
+      ~WorkerPool();
+
+      inline int getNumThreads() const {
+        return (int)threads.size();
+      }
+
+      void execute(WorkerJob *job, size_t numTasks);
+
+      void runWorker();
+
+    private:
+      // runs tasks of the current job until none is left
+      void work();
+
+      std::vector<pthread_t> threads;
+      Mutex executeMutex;
+      Mutex mutex;
+      WaitCondition startCondition;
+      WaitCondition doneCondition;
+      unsigned long generation;
+      bool stop;
+      int activeWorkers;
+      WorkerJob *job;
+      size_t numTasks;
+      std::atomic<size_t> nextTask;
+    };
+
+  } // end of namespace utils
+
+} // end of namespace mars
+
+#endif // MARS_UTILS_WORKER_POOL_H
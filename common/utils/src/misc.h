@@ -27,6 +27,7 @@
   #include <io.h>
 #else
   #include <sys/time.h>
+  #include <time.h>
   #include <unistd.h>
 #endif
 
@@ -89,6 +90,33 @@ namespace mars {
       return getTime() - start;
     }
 
+    /**
+     * @return monotonic time in nanoseconds, only meaningful as difference
+     */
+    inline long long getTimeNs() {
+#ifdef WIN32
+      LARGE_INTEGER frequency, counter;
+      QueryPerformanceFrequency(&frequency);
+      QueryPerformanceCounter(&counter);
+      return (long long)(counter.QuadPart / frequency.QuadPart) * 1000000000LL +
+        (long long)(counter.QuadPart % frequency.QuadPart) * 1000000000LL /
+        frequency.QuadPart;
+#else
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ((long long)ts.tv_sec)*1000000000LL + ts.tv_nsec;
+#endif
+    }
+
+    /**
+     * @brief returns the time difference between now and a given reference.
+     * @param start reference time from getTimeNs()
+     * @return time difference between now and start in nanoseconds
+     */
+    inline long long getTimeDiffNs(long long start) {
+      return getTimeNs() - start;
+    }
+
     /**
      * sleeps for at least the specified time.
      * @param milliseconds time to sleep in milliseconds
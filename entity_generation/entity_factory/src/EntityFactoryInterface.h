@@ -59,6 +59,19 @@ namespace mars {
       }
       ;
       virtual sim::SimEntity* createEntity(const configmaps::ConfigMap& config) = 0;
+      /**
+       * \brief creates an entity that may share the parsed description
+       *        with the entities of earlier calls
+       *
+       * The configs of the calls may only differ in "name", "position"
+       * and "rotation". Factories without templates parse \a config again.
+       */
+      virtual sim::SimEntity* instantiateEntity(const configmaps::ConfigMap& config) {
+        return createEntity(config);
+      }
+      /** \brief forgets the descriptions kept by instantiateEntity */
+      virtual void clearTemplates() {
+      }
       virtual std::string getType() {
         return this->type;
       }
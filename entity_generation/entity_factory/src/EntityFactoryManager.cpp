@@ -49,6 +49,12 @@ namespace mars {
     }
 
     void EntityFactoryManager::reset() {
+      // the files may have changed on disk
+      utils::MutexLocker locker(&iMutex);
+      std::map<std::string, EntityFactoryInterface*>::iterator it;
+      for(it=factories.begin(); it!=factories.end(); ++it) {
+        it->second->clearTemplates();
+      }
     }
 
     EntityFactoryManager::~EntityFactoryManager() {
@@ -68,6 +74,11 @@ namespace mars {
     }
 
     unsigned long EntityFactoryManager::createEntity(configmaps::ConfigMap& config) {
+      return addEntity(config, false);
+    }
+
+    unsigned long EntityFactoryManager::addEntity(configmaps::ConfigMap& config,
+                                                  bool instantiate) {
       unsigned long id = 0;
       utils::MutexLocker locker(&iMutex);
       std::map<std::string, EntityFactoryInterface*>::iterator it;
@@ -79,7 +90,9 @@ namespace mars {
       }
       if(knowntype) {
         fprintf(stderr, "Loading Entity of type %s.\n", ((std::string)config["type"]).c_str());
-        sim::SimEntity* newentity = factories[config["type"]]->createEntity(config);
+        EntityFactoryInterface *factory = factories[config["type"]];
+        sim::SimEntity* newentity = (instantiate ? factory->instantiateEntity(config)
+                                     : factory->createEntity(config));
         id = control->entities->addEntity(newentity);
       }
       else {
@@ -94,6 +107,26 @@ namespace mars {
       return createEntity(config);
     }
 
+    unsigned long EntityFactoryManager::instantiateEntity(const configmaps::ConfigMap& config,
+                                                          const std::string &name,
+                                                          const utils::Vector &position,
+                                                          const utils::Quaternion &rotation) {
+      configmaps::ConfigMap instance = config;
+      configmaps::ConfigVector pos, rot;
+      pos += configmaps::ConfigAtom(position.x());
+      pos += configmaps::ConfigAtom(position.y());
+      pos += configmaps::ConfigAtom(position.z());
+      // see SimEntity::setInitialPose
+      rot += configmaps::ConfigAtom(rotation.w());
+      rot += configmaps::ConfigAtom(rotation.x());
+      rot += configmaps::ConfigAtom(rotation.y());
+      rot += configmaps::ConfigAtom(rotation.z());
+      instance["name"] = name;
+      instance["position"] = pos;
+      instance["rotation"] = rot;
+      return addEntity(instance, true);
+    }
+
   } // end of namespace entity_generation
 } // end of namespace mars
 
@@ -38,6 +38,8 @@
 #include <mars/data_broker/ReceiverInterface.h>
 #include <mars/cfg_manager/CFGManagerInterface.h>
 #include <mars/utils/Mutex.h>
+#include <mars/utils/Vector.h>
+#include <mars/utils/Quaternion.h>
 #include <configmaps/ConfigData.h>
 
 namespace mars {
@@ -76,10 +78,27 @@ namespace mars {
         virtual unsigned long createEntity(configmaps::ConfigMap& config);
         virtual unsigned long createEntity(std::string configfile);
 
+        /**
+         * \brief creates another entity from the config of an existing one
+         *
+         * The name and the pose in \a config are replaced by \a name,
+         * \a position and \a rotation. Factories that keep templates, like
+         * the smurf factory, build the new entity without parsing the
+         * files of \a config again, see
+         * EntityFactoryInterface::instantiateEntity. The templates are
+         * cleared by reset().
+         */
+        virtual unsigned long instantiateEntity(const configmaps::ConfigMap& config,
+                                                const std::string &name,
+                                                const utils::Vector &position,
+                                                const utils::Quaternion &rotation);
+
         // EntityFactoryManager methods
 
     private:
         std::map<std::string, EntityFactoryInterface*> factories;
+
+        unsigned long addEntity(configmaps::ConfigMap& config, bool instantiate);
         mutable utils::Mutex iMutex;
 
       };
@@ -39,6 +39,8 @@
 #include <mars/utils/mathUtils.h>
 #include <smurf_parser/SMURFParser.h>
 
+#include <sys/stat.h>
+
 //#define DEBUG_PARSE_SENSOR 1
 //#define DEBUG_SCENE_MAP
 
@@ -182,14 +184,40 @@ namespace mars {
     }
 
     sim::SimEntity* SMURF::createEntity(const ConfigMap& config) {
+      return loadEntity(config, false);
+    }
+
+    sim::SimEntity* SMURF::instantiateEntity(const ConfigMap& config) {
+      return loadEntity(config, true);
+    }
+
+    sim::SimEntity* SMURF::loadEntity(const ConfigMap& config, bool useTemplate) {
       reset();
       entityconfig = config;
       std::string path = (std::string)entityconfig["path"];
       tmpPath = path;
       entityconfig["abs_path"] = pathJoin(getCurrentWorkingDir(), path);
       std::string filename = (std::string)entityconfig["file"];
-      fprintf(stderr, "SMURF::createEntity: Creating entity of type %s\n", ((std::string)entityconfig["type"]).c_str());
-      if((std::string)entityconfig["type"] == "smurf" || entityconfig["type"].getString() == "particle") {
+      std::string templateKey;
+      std::map<std::string, EntityTemplate>::iterator tIt = templates.end();
+      if(useTemplate) {
+        templateKey = getTemplateKey(entityconfig);
+        tIt = templates.find(templateKey);
+        // the file changed on disk
+        if(tIt != templates.end() &&
+           tIt->second.fileTime != getFileTime(entityconfig)) {
+          templates.erase(tIt);
+          tIt = templates.end();
+        }
+      }
+      if(tIt != templates.end()) {
+        fprintf(stderr, "SMURF::createEntity: Creating entity of type %s from template\n", ((std::string)entityconfig["type"]).c_str());
+        loadTemplate(tIt->second, config);
+        entity = new sim::SimEntity(control, entityconfig);
+      }
+      else if((std::string)entityconfig["type"] == "smurf" || entityconfig["type"].getString() == "particle") {
+        fprintf(stderr, "SMURF::createEntity: Creating entity of type %s\n", ((std::string)entityconfig["type"]).c_str());
+        int firstGroupID = groupID;
         model = smurf_parser::parseFile(&entityconfig, path, filename, true);
 #ifdef DEBUG_SCENE_MAP
         debugMap.append(entityconfig);
@@ -214,13 +242,21 @@ namespace mars {
             tmpconfig[it->first] = it->second;
             addConfigMap(tmpconfig);
         }
+        if(!templateKey.empty() && model) {
+          storeTemplate(templateKey, config, firstGroupID);
+        }
       } else { // if type is "urdf"
+        fprintf(stderr, "SMURF::createEntity: Creating entity of type %s\n", ((std::string)entityconfig["type"]).c_str());
+        int firstGroupID = groupID;
         std::string urdfpath = path + filename;
         fprintf(stderr, "  ...loading urdf data from %s.\n", urdfpath.c_str());
         fprintf(stderr, "parsing model...\n");
         parseURDF(urdfpath);
         entity = new sim::SimEntity(control, entityconfig);
         createModel(false);
+        if(!templateKey.empty() && model) {
+          storeTemplate(templateKey, config, firstGroupID);
+        }
       }
 
       // node mapping and name checking
@@ -242,6 +278,98 @@ namespace mars {
       return entity;
     }
 
+    void SMURF::clearTemplates() {
+      templates.clear();
+    }
+
+    // the keys of the config that may differ between the entities of a template
+    static bool isInstanceKey(const std::string &key) {
+      return key == "name" || key == "position" || key == "rotation";
+    }
+
+    std::string SMURF::getTemplateKey(const ConfigMap &config) {
+      ConfigMap map = config;
+      ConfigMap keyMap;
+      ConfigMap::iterator it;
+      for(it = map.begin(); it != map.end(); ++it) {
+        if(!isInstanceKey(it->first)) {
+          keyMap[it->first] = it->second;
+        }
+      }
+      return keyMap.toYamlString();
+    }
+
+    long long SMURF::getFileTime(const ConfigMap &config) {
+      ConfigMap map = config;
+      std::string file = pathJoin((std::string)map["path"],
+                                  (std::string)map["file"]);
+      struct stat fileStat;
+      if(stat(file.c_str(), &fileStat) != 0) {
+        return 0;
+      }
+      return (long long)fileStat.st_mtime;
+    }
+
+    void SMURF::storeTemplate(const std::string &key, const ConfigMap &config,
+                              int firstGroupID) {
+      EntityTemplate &t = templates[key];
+      t.materialList = materialList;
+      t.nodeList = nodeList;
+      t.jointList = jointList;
+      t.motorList = motorList;
+      t.sensorList = sensorList;
+      t.controllerList = controllerList;
+      t.graphicList = graphicList;
+      t.lightList = lightList;
+      t.entityconfig = entityconfig;
+      t.fileTime = getFileTime(config);
+      t.robotname = robotname;
+      t.model = model;
+      t.firstGroupID = firstGroupID;
+      t.endGroupID = groupID;
+    }
+
+    void SMURF::loadTemplate(const EntityTemplate &t, const ConfigMap &config) {
+      ConfigMap parsedconfig = t.entityconfig;
+      ConfigMap newconfig = config;
+      ConfigMap::iterator it;
+
+      materialList = t.materialList;
+      nodeList = t.nodeList;
+      jointList = t.jointList;
+      motorList = t.motorList;
+      sensorList = t.sensorList;
+      controllerList = t.controllerList;
+      graphicList = t.graphicList;
+      lightList = t.lightList;
+      robotname = t.robotname;
+      model = t.model;
+
+      // everything except the name and the pose equals the parsed config
+      entityconfig.clear();
+      for(it = parsedconfig.begin(); it != parsedconfig.end(); ++it) {
+        if(!isInstanceKey(it->first)) {
+          entityconfig[it->first] = it->second;
+        }
+      }
+      for(it = newconfig.begin(); it != newconfig.end(); ++it) {
+        if(isInstanceKey(it->first)) {
+          entityconfig[it->first] = it->second;
+        }
+      }
+
+      // the nodes of each entity get their own group ids
+      int offset = groupID - t.firstGroupID;
+      std::vector<ConfigMap>::iterator nIt;
+      for(nIt = nodeList.begin(); offset && nIt != nodeList.end(); ++nIt) {
+        if(!nIt->hasKey("groupid")) continue;
+        int group = (int)(*nIt)["groupid"];
+        if(group >= t.firstGroupID && group < t.endGroupID) {
+          (*nIt)["groupid"] = group + offset;
+        }
+      }
+    }
+
     void SMURF::addConfigMap(ConfigMap &config) {
       ConfigVector::iterator it;
       for (it = config["motors"].begin(); it != config["motors"].end(); ++it) {
@@ -47,6 +47,30 @@ namespace mars {
 
   namespace smurf {
 
+    /**
+     * \brief The parsed description of an entity file.
+     *
+     * The lists hold the configs after the URDF is translated and the
+     * SMURF sections are merged with the files of their URIs.
+     * SMURF::instantiateEntity loads further entities of the same config
+     * from it without reading or parsing any file.
+     */
+    struct EntityTemplate {
+      std::vector<configmaps::ConfigMap> materialList;
+      std::vector<configmaps::ConfigMap> nodeList;
+      std::vector<configmaps::ConfigMap> jointList;
+      std::vector<configmaps::ConfigMap> motorList;
+      std::vector<configmaps::ConfigMap> sensorList;
+      std::vector<configmaps::ConfigMap> controllerList;
+      std::vector<configmaps::ConfigMap> graphicList;
+      std::vector<configmaps::ConfigMap> lightList;
+      configmaps::ConfigMap entityconfig; ///< the config after parsing
+      long long fileTime;                 ///< modification time of the file
+      std::string robotname;
+      urdf::ModelInterfaceSharedPtr model;
+      int firstGroupID, endGroupID;       ///< the group ids of the nodes
+    };
+
     class SMURF: public interfaces::MarsPluginTemplate,
         public mars::entity_generation::EntityFactoryInterface {
 
@@ -70,6 +94,17 @@ namespace mars {
 
       // EntityFactoryInterface
       virtual sim::SimEntity* createEntity(const configmaps::ConfigMap& config);
+      /**
+       * \brief creates the entity from an EntityTemplate of \a config
+       *
+       * The template is created by the first call for a config and is
+       * used by all calls whose config differs only in the name, the
+       * position and the rotation. It is parsed again if the modification
+       * time of the entity file changes; changes of the files it refers
+       * to are only seen after clearTemplates().
+       */
+      virtual sim::SimEntity* instantiateEntity(const configmaps::ConfigMap& config);
+      virtual void clearTemplates();
 
       // MarsPlugin methods
       void init();
@@ -110,11 +145,24 @@ namespace mars {
       std::string robotname;
       urdf::ModelInterfaceSharedPtr model;
       sim::SimEntity* entity;
+      std::map<std::string, EntityTemplate> templates;
 
       void handleURI(configmaps::ConfigMap *map, std::string uri);
       void handleURIs(configmaps::ConfigMap *map);
       void getSensorIDList(configmaps::ConfigMap *map);
 
+      sim::SimEntity* loadEntity(const configmaps::ConfigMap &config,
+                                 bool useTemplate);
+
+      // entity templates
+      std::string getTemplateKey(const configmaps::ConfigMap &config);
+      long long getFileTime(const configmaps::ConfigMap &config);
+      void storeTemplate(const std::string &key,
+                         const configmaps::ConfigMap &config,
+                         int firstGroupID);
+      void loadTemplate(const EntityTemplate &entityTemplate,
+                        const configmaps::ConfigMap &config);
+
       // creating URDF objects
       void translateLink(urdf::LinkSharedPtr link, bool fixed); // handleKinematics
       void translateJoint(urdf::LinkSharedPtr childlink); // handleKinematics
@@ -28,6 +28,7 @@
 #include "GraphicsManager.h"
 #include "config.h"
 #include <mars/utils/misc.h>
+#include <mars/utils/Trace.h>
 
 //#include <osgUtil/Optimizer>
 
@@ -130,6 +131,7 @@ namespace mars {
 
     void GraphicsManager::initializeOSG(void *data, bool createWindow) {
       if(!initialized) {
+        MARS_TRACE_THREAD_NAME("gui");
         cfg = libManager->getLibraryAs<cfg_manager::CFGManagerInterface>("cfg_manager");
         if(!cfg) {
           fprintf(stderr, "******* mars_graphics: couldn't find cfg_manager\n");
@@ -706,6 +708,7 @@ namespace mars {
     }
 
     void GraphicsManager::draw() {
+      MARS_TRACE_SCOPE("GraphicsManager::draw");
       std::list<interfaces::GraphicsUpdateInterface*>::iterator it;
       std::vector<GraphicsWidget*>::iterator iter;
 
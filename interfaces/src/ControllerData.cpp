@@ -36,6 +36,8 @@ namespace mars {
 
     ControllerData::ControllerData() {
       rate = 20;
+      lockstep = true;
+      async = false;
     }
 
     bool ControllerData::fromConfigMap(ConfigMap *config,
@@ -51,6 +53,9 @@ namespace mars {
       GET_VALUE("index", id, ULong);
       GET_VALUE("rate", rate, Double);
       dylib_path = config->get("dylib_path", dylib_path);
+      shm_name = config->get("shm_name", shm_name);
+      lockstep = config->get("lockstep", lockstep);
+      async = config->get("async", async);
 
       if((it = config->find("sensorid")) != config->end()) {
         ConfigVector _ids = (*config)["sensorid"];
@@ -99,6 +104,13 @@ namespace mars {
       SET_VALUE("index", id);
       SET_VALUE("rate", rate);
       SET_VALUE("dylib_path", dylib_path);
+      if(!shm_name.empty()) {
+        SET_VALUE("shm_name", shm_name);
+        SET_VALUE("lockstep", lockstep);
+      }
+      if(async) {
+        SET_VALUE("async", async);
+      }
 
       for(it=sensors.begin(); it!=sensors.end(); ++it) {
         (*config)["sensorid"] << *it;
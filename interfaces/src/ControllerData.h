@@ -49,6 +49,14 @@ namespace mars {
       std::vector<unsigned long> sensors;
       std::vector<unsigned long> sNodes;
       std::string dylib_path;
+      /** \brief name of the shared memory segment, if set the controller
+       *         uses the shared memory transport instead of TCP
+       */
+      std::string shm_name;
+      /// wait for the controller at every control step (shm transport)
+      bool lockstep;
+      /// use the asynchronous socket mode, see Controller::setAsyncMode
+      bool async;
     }; // end of class ControllerData
 
   } // end of namespace interfaces
@@ -22,6 +22,9 @@
 #define MARS_INTERFACES_NODE_STATE_H
 
 #include <mars/utils/Vector.h>
+#include <mars/utils/Quaternion.h>
+
+#include <vector>
 
 namespace mars {
 
@@ -58,6 +61,43 @@ namespace mars {
       utils::Vector t;
     }; // end of struct nodeState
 
+    /** \brief Selects the fields of NodeStates in setNodeStates(). */
+    enum NodeStateField {
+      NODE_STATE_POSITION = 1 << 0,
+      NODE_STATE_ROTATION = 1 << 1,
+      NODE_STATE_LINEAR_VELOCITY = 1 << 2,
+      NODE_STATE_ANGULAR_VELOCITY = 1 << 3,
+      NODE_STATE_ALL = (1 << 4) - 1
+    };
+
+    /**
+     * \brief The states of several nodes as one array per field.
+     *
+     * Entry i of every array belongs to the same node.
+     */
+    struct NodeStates {
+      void resize(size_t n) {
+        position.resize(n);
+        rotation.resize(n);
+        linearVelocity.resize(n);
+        angularVelocity.resize(n);
+        linearAcceleration.resize(n);
+        angularAcceleration.resize(n);
+        force.resize(n);
+        torque.resize(n);
+      }
+      size_t size() const { return position.size(); }
+
+      std::vector<utils::Vector> position;
+      std::vector<utils::Quaternion> rotation;
+      std::vector<utils::Vector> linearVelocity;
+      std::vector<utils::Vector> angularVelocity;
+      std::vector<utils::Vector> linearAcceleration;
+      std::vector<utils::Vector> angularAcceleration;
+      std::vector<utils::Vector> force;
+      std::vector<utils::Vector> torque;
+    }; // end of struct NodeStates
+
   } // end of namespace interfaces
 
 } // end of namespace mars
@@ -104,6 +104,23 @@ namespace mars {
         return configmaps::ConfigMap();
       }
 
+      /**
+       * \brief Appends the values the sensor buffers between steps to a
+       *        checkpoint.
+       * \return \c false if the sensor keeps no state, which is the
+       *         default.
+       */
+      virtual bool saveCheckpoint(std::vector<char> *data) const {
+        (void)data;
+        return false;
+      }
+
+      /** \brief Restores the values that saveCheckpoint() returned. */
+      virtual void loadCheckpoint(const char *data, size_t size) {
+        (void)data;
+        (void)size;
+      }
+
       //Should be proteted due to compability of old code currently direct accessable
       unsigned long id;
       std::string name; //Todo naming bei mehreren robotern
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file ControllerFrame.h
+ * \brief Binary frames of the asynchronous socket mode of a controller.
+ *
+ * Every frame starts with a ControllerFrameHeader followed by \c count
+ * payload entries. All values are in the byte order of the simulation
+ * host.
+ *
+ * - CONTROLLER_FRAME_SENSORS (simulation to client): \c count doubles with
+ *   the sensor values of the control step \c step.
+ * - CONTROLLER_FRAME_MOTORS (client to simulation): \c count doubles with
+ *   the control values of the motors. \c step is the step of the sensor
+ *   frame that was answered.
+ * - CONTROLLER_FRAME_COMMANDS (client to simulation): \c count
+ *   ControllerShmCommand records.
+ *
+ * The simulation only keeps the latest sensor and motor frame. Frames
+ * that are replaced before they were sent or applied are dropped.
+ */
+
+#ifndef MARS_INTERFACES_CONTROLLER_FRAME_H
+#define MARS_INTERFACES_CONTROLLER_FRAME_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ControllerFrame.h"
+#endif
+
+#include "ControllerShmLayout.h"
+
+#include <stdint.h>
+
+namespace mars {
+  namespace interfaces {
+
+    const uint32_t CONTROLLER_FRAME_MAGIC = 0x4d435446; // "MCTF"
+
+    enum ControllerFrameType {
+      CONTROLLER_FRAME_SENSORS = 1,
+      CONTROLLER_FRAME_MOTORS,
+      CONTROLLER_FRAME_COMMANDS
+    };
+
+    struct ControllerFrameHeader {
+      uint32_t magic;
+      uint32_t type;
+      uint32_t step;
+      uint32_t count;
+    };
+
+  } // end of namespace interfaces
+} // end of namespace mars
+
+#endif // MARS_INTERFACES_CONTROLLER_FRAME_H
@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file ControllerShmLayout.h
+ * \brief Layout of the shared memory segment of a controller that uses the
+ *        shared memory transport instead of the TCP/ASCII protocol.
+ *
+ * The segment is created by the simulation and starts with a
+ * ControllerShmHeader. It is followed by the sensor values, the motor
+ * values and the command queue at the offsets given in the header. Sensor
+ * and motor values are doubles in the order of the sensors and motors of
+ * the controller. The motor values are the control values of the motors
+ * and are applied at every step once a client answered.
+ *
+ * At every control step the simulation writes the sensor values under
+ * \c sensorSequence and increments \c step. The client writes the motor
+ * values and the commands under \c commandSequence, increments
+ * \c commandSerial for every new set of commands and finally stores the
+ * step it answered in \c reply.
+ *
+ * In CONTROLLER_SHM_LOCKSTEP mode the simulation waits for \c reply to
+ * reach \c step as long as a client is attached. In
+ * CONTROLLER_SHM_FREE_RUNNING mode the simulation never waits and applies
+ * the latest motor values.
+ *
+ * The seqlocks and the waits on \c step and \c reply use the helpers of
+ * mars/utils/ShmSeqLock.h. A waiting process announces itself in the
+ * corresponding waiter counter.
+ *
+ * This header only depends on the standard library and the header only
+ * ShmSeqLock.h so that controllers can include it without linking against
+ * MARS.
+ */
+
+#ifndef MARS_INTERFACES_CONTROLLER_SHM_LAYOUT_H
+#define MARS_INTERFACES_CONTROLLER_SHM_LAYOUT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ControllerShmLayout.h"
+#endif
+
+#include <mars/utils/ShmSeqLock.h>
+
+#include <atomic>
+#include <stdint.h>
+
+namespace mars {
+  namespace interfaces {
+
+    const char CONTROLLER_SHM_MAGIC[8] = {'M', 'C', 'T', 'R', 'L', 0, 0, 0};
+    const uint32_t CONTROLLER_SHM_VERSION = 1;
+    const uint32_t CONTROLLER_SHM_MAX_COMMANDS = 256;
+
+    enum ControllerShmMode {
+      CONTROLLER_SHM_LOCKSTEP,
+      CONTROLLER_SHM_FREE_RUNNING
+    };
+
+    /**
+     * \brief command type that resets the simulation, all other types are
+     *        values of mars::interfaces::Command
+     */
+    const uint32_t CONTROLLER_SHM_RESET_SIM = 0x10000;
+
+    /**
+     * \brief One entry of the command queue.
+     *
+     * The values depend on the type:
+     * - COMMAND_MOTOR_POSITION, COMMAND_MOTOR_MAX_VELOCITY: value, \a id is
+     *   the index of the motor in the controller
+     * - COMMAND_MOTOR_PID: p, i, d
+     * - COMMAND_NODE_POSITION, COMMAND_NODE_VELOCITY,
+     *   COMMAND_NODE_ANGULAR_VELOCITY, COMMAND_NODE_APPLY_FORCE,
+     *   COMMAND_PHYSICS_GRAVITY: x, y, z
+     * - COMMAND_NODE_ROTATION: euler angles in degree
+     * - COMMAND_NODE_APPLY_FORCE_AT: force x, y, z, position x, y, z
+     * - COMMAND_NODE_ANGULAR_DAMPING: damping
+     * - COMMAND_NODES_CONNECT, COMMAND_NODES_DISCONNECT: id of the second
+     *   node
+     */
+    struct ControllerShmCommand {
+      uint32_t type;
+      uint32_t reserved;
+      uint64_t id;
+      double values[6];
+    };
+
+    struct ControllerShmHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t mode;             ///< ControllerShmMode
+      uint64_t size;
+      double rate;               ///< ms of simulation time per step
+      uint32_t numSensorValues;  ///< capacity of the sensor array
+      uint32_t numMotors;
+      uint64_t sensorOffset;     ///< segment offset of the sensor values
+      uint64_t motorOffset;      ///< segment offset of the motor values
+      uint64_t commandOffset;    ///< segment offset of the command queue
+
+      std::atomic<uint32_t> attached; ///< set by the client while connected
+      std::atomic<uint32_t> sensorSequence;
+      std::atomic<uint32_t> sensorCount;   ///< valid sensor values
+      std::atomic<uint32_t> step;
+      std::atomic<uint32_t> stepWaiters;
+
+      std::atomic<uint32_t> commandSequence;
+      std::atomic<uint32_t> commandSerial;
+      std::atomic<uint32_t> numCommands;
+      std::atomic<uint32_t> reply;
+      std::atomic<uint32_t> replyWaiters;
+    };
+
+    /** \brief returns the size of a segment with the given capacities */
+    inline uint64_t controllerShmSize(uint32_t numSensorValues,
+                                      uint32_t numMotors) {
+      return sizeof(ControllerShmHeader) +
+        (numSensorValues + numMotors) * sizeof(double) +
+        CONTROLLER_SHM_MAX_COMMANDS * sizeof(ControllerShmCommand);
+    }
+
+  } // end of namespace interfaces
+} // end of namespace mars
+
+#endif // MARS_INTERFACES_CONTROLLER_SHM_LAYOUT_H
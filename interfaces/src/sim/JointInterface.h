@@ -76,6 +76,9 @@ namespace mars {
       virtual void setHighStop(sReal lowStop) = 0;
       virtual void setLowStop2(sReal lowStop) = 0;
       virtual void setHighStop2(sReal lowStop) = 0;
+      // the forces, torques and the joint load are only calculated while
+      // the feedback is enabled, it is enabled after creation
+      virtual void setFeedbackEnabled(bool enabled) = 0;
     };
 
   } // end of namespace interfaces
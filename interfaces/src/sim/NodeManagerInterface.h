@@ -269,6 +269,38 @@ namespace mars {
       virtual void setNodeState(NodeId id, const nodeState &state) = 0;
       virtual void getNodeState(NodeId id, nodeState *state) const = 0;
 
+      /**
+       * \brief Copies the states of the nodes \a ids at the end of the
+       *        last physics step.
+       *
+       * The states of all nodes are kept in one array per field. The
+       * physics thread updates the dynamic nodes once per step and the
+       * static nodes after they were moved. This call takes one lock for
+       * all nodes and finds them by their id without a map lookup, so it
+       * is meant for reading many nodes every step, e.g. for observations
+       * of a learning agent.
+       * \param ids The ids of the nodes.
+       * \param states Resized to the number of ids. Unknown ids get a zero
+       *               state.
+       * \return \c false if one of the ids is unknown
+       */
+      virtual bool getNodeStates(const std::vector<NodeId> &ids,
+                                 NodeStates *states) const = 0;
+
+      /**
+       * \brief Sets the \a fields of the nodes \a ids from \a states.
+       *
+       * Entry i of \a states is applied to the node ids[i]. The positions
+       * and rotations are set without moving connected nodes. Like the
+       * other setters this has to be serialized with the physics thread,
+       * e.g. by calling it while the physics is locked.
+       * \param fields A combination of NodeStateField values.
+       * \return \c false if one of the ids is unknown
+       */
+      virtual bool setNodeStates(const std::vector<NodeId> &ids,
+                                 const NodeStates &states,
+                                 unsigned int fields=NODE_STATE_ALL) = 0;
+
       /**
        * \brief Gives the center of mass of a set of nodes.
        *
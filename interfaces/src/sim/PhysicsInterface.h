@@ -58,6 +58,9 @@ namespace mars {
       bool fast_step;
       bool draw_contact_points;
       sReal world_cfm, world_erp;
+      /** durations of the collision and the solver part of the last
+       *  stepTheWorld() call in ms */
+      sReal collide_time, solve_time;
 
       virtual ~PhysicsInterface() {}
       virtual void initTheWorld(void) = 0;
@@ -35,12 +35,35 @@
 #include <mars/interfaces/MARSDefs.h> // for sReal
 
 #include <string>
+#include <vector>
 
 namespace mars {
   namespace interfaces {
 
     class ControlCenter;
 
+    /**
+     * \brief State a plugin accesses from update(), returned by
+     *        PluginInterface::getUpdateAccess()
+     *
+     * Plugins that are PLUGIN_ACCESS_PARALLEL_SAFE and whose accesses do not
+     * conflict are updated concurrently. Two plugins conflict if one of them
+     * writes state the other one reads or writes.
+     */
+    enum PluginAccess {
+      PLUGIN_READ_NODES = 1 << 0,
+      PLUGIN_READ_JOINTS = 1 << 1,
+      PLUGIN_READ_MOTORS = 1 << 2,
+      PLUGIN_READ_SENSORS = 1 << 3,
+      PLUGIN_READ_CFG = 1 << 4,
+      PLUGIN_WRITE_NODES = PLUGIN_READ_NODES << 8,
+      PLUGIN_WRITE_JOINTS = PLUGIN_READ_JOINTS << 8,
+      PLUGIN_WRITE_MOTORS = PLUGIN_READ_MOTORS << 8,
+      PLUGIN_WRITE_SENSORS = PLUGIN_READ_SENSORS << 8,
+      PLUGIN_WRITE_CFG = PLUGIN_READ_CFG << 8,
+      PLUGIN_ACCESS_PARALLEL_SAFE = 1 << 16
+    };
+
     /**
      * The interface to load plugin dynamically into the simulation
      *
@@ -54,6 +77,33 @@ namespace mars {
       virtual void init(void) = 0;
       virtual void handleError(void) {};
       virtual void getSomeData(void* data) {(void)data;};
+      /**
+       * \brief Returns a combination of PluginAccess flags.
+       *
+       * The default marks the plugin as not parallel-safe, it is updated
+       * alone. A parallel-safe plugin must not access state it did not
+       * declare and must not call SimulatorInterface::switchPluginUpdateMode
+       * or removePlugin from update().
+       */
+      virtual unsigned int getUpdateAccess(void) const { return 0; }
+
+      /**
+       * \brief Appends the state of the plugin to a checkpoint.
+       * \return \c false if the plugin has no state to save, which is
+       *         the default.
+       *
+       * Called while the physics is locked between two steps.
+       */
+      virtual bool saveCheckpoint(std::vector<char> *data) const
+      { (void)data; return false; }
+      /**
+       * \brief Restores the state that saveCheckpoint() returned.
+       *
+       * Called while the physics is locked between two steps. \a data is only
+       * valid during the call.
+       */
+      virtual void loadCheckpoint(const char *data, size_t size)
+      { (void)data; (void)size; }
 
     protected:
       ControlCenter *control;
@@ -39,6 +39,8 @@
 #include "../graphics/draw_structs.h"
 #include "../LightData.h"
 
+#include <functional>
+
 namespace lib_manager {
   class LibManager;
 }
@@ -47,6 +49,13 @@ namespace mars {
 
   namespace interfaces {
 
+    /**
+     * \brief Called by SimulatorInterface::stepN after every step with the
+     *        number of the finished step starting at 1. Returning \c false
+     *        stops the batch.
+     */
+    typedef std::function<bool(unsigned long)> StepCallback;
+
     class SimulatorInterface {
     public:
 
@@ -62,6 +71,18 @@ namespace mars {
       virtual bool isSimRunning() const = 0;
       virtual bool startStopTrigger() = 0;
       virtual void singleStep(void) = 0;
+      /**
+       * \brief Runs \a n physics steps back to back in the calling thread.
+       *
+       * The physics lock is taken once for the whole batch, there are no
+       * sleeps and no synchronization with the graphics. Should be used
+       * while the simulation is stopped, e.g. for optimization or learning
+       * loops.
+       * \param callback optional hook that is called after each step
+       * \return the number of steps that were done
+       */
+      virtual unsigned long stepN(unsigned long n,
+                                  const StepCallback &callback=StepCallback()) = 0;
       virtual void newWorld(bool clear_all=false) = 0;
       virtual void exitMars(void) = 0;
       virtual void readArguments(int argc, char **argv) = 0;
@@ -86,6 +107,28 @@ namespace mars {
       virtual bool sceneChanged() const = 0;
       virtual void sceneHasChanged(bool reset) = 0;
 
+      // checkpoints
+      /**
+       * \brief Writes the dynamic state of the simulation to \a filename.
+       *
+       * The state is copied after the current step and written by a
+       * background thread, so the physics is paused for at most one step.
+       * The scene itself is not part of a checkpoint, it has to be loaded
+       * before a checkpoint is restored.
+       * \return \c false if another checkpoint is still being written
+       */
+      virtual bool saveCheckpoint(const std::string &filename) = 0;
+      /**
+       * \brief Restores the state written by saveCheckpoint() into the
+       *        currently loaded scene.
+       * \return \c false if the file could not be read
+       *
+       * Takes the physics lock, so it must not be called from a plugin
+       * update. States of objects that are missing in the scene are
+       * skipped with a warning.
+       */
+      virtual bool loadCheckpoint(const std::string &filename) = 0;
+
       //threads
       bool allConcurrencysHandled();
       virtual void setSyncThreads(bool value) = 0;
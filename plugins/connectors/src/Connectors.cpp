@@ -123,6 +123,8 @@ namespace mars {
         jointdata.name = "connector_"+male+"_"+female;
         unsigned long jointid = control->joints->addJoint(&jointdata);
         if (jointid > 0) {
+          // the joint load is needed to break the connection
+          control->joints->getSimJoint(jointid)->requestFeedback();
           // TODO: maybe update NodeData here and set collision group differently to avoid collision problems
           maleconnectors[male]["jointid"] = jointid;
           maleconnectors[male]["partner"] = female;
@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Checkpoint.h"
+
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/Logging.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace mars {
+  namespace sim {
+
+    /// \cond HIDDEN_SYMBOLS
+    static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    static uint64_t align8(uint64_t value) {
+      return (value + 7) & ~(uint64_t)7;
+    }
+
+    static uint64_t entriesSize(const std::vector<CheckpointBlob> &blobs) {
+      uint64_t size = 0;
+      for(size_t i = 0; i < blobs.size(); ++i) {
+        size += sizeof(CheckpointEntry) + align8(blobs[i].name.size()) +
+          align8(blobs[i].data.size());
+      }
+      return size;
+    }
+
+    static bool writePadded(FILE *file, const void *data, size_t size) {
+      if(size && fwrite(data, 1, size, file) != size) return false;
+      size_t pad = align8(size) - size;
+      return !pad || fwrite(padding, 1, pad, file) == pad;
+    }
+
+    static bool writeEntries(FILE *file,
+                             const std::vector<CheckpointBlob> &blobs) {
+      for(size_t i = 0; i < blobs.size(); ++i) {
+        CheckpointEntry entry;
+        entry.id = blobs[i].id;
+        entry.nameSize = blobs[i].name.size();
+        entry.dataSize = blobs[i].data.size();
+        if(fwrite(&entry, sizeof(entry), 1, file) != 1 ||
+           !writePadded(file, blobs[i].name.data(), entry.nameSize) ||
+           !writePadded(file, blobs[i].data.empty() ? NULL : &blobs[i].data[0],
+                        entry.dataSize)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    /// \endcond
+
+    void CheckpointData::clear() {
+      simTimeNs = 0;
+      calcMs = 0.;
+      nodes.clear();
+      joints.clear();
+      motors.clear();
+      sensors.clear();
+      timers.clear();
+      plugins.clear();
+    }
+
+    CheckpointWriter::CheckpointWriter() : started(false) {
+    }
+
+    CheckpointWriter::~CheckpointWriter() {
+      finish();
+    }
+
+    bool CheckpointWriter::write(const std::string &filename_,
+                                 CheckpointData *data_) {
+      if(isBusy()) return false;
+      finish();
+      std::swap(data, *data_);
+      filename = filename_;
+      started = true;
+      start();
+      return true;
+    }
+
+    bool CheckpointWriter::isBusy() const {
+      return started && isRunning();
+    }
+
+    void CheckpointWriter::finish() {
+      if(started) {
+        wait();
+        started = false;
+      }
+    }
+
+    void CheckpointWriter::run() {
+      writeFile(filename, data);
+    }
+
+    bool CheckpointWriter::writeFile(const std::string &filename,
+                                     const CheckpointData &data) {
+      const uint32_t numSections = 6;
+      CheckpointFileHeader header;
+      CheckpointSection sections[numSections];
+      std::string tmpName = filename + ".tmp";
+
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, CHECKPOINT_FILE_MAGIC, sizeof(header.magic));
+      header.version = CHECKPOINT_FILE_VERSION;
+      header.numSections = numSections;
+      header.simTimeNs = data.simTimeNs;
+      header.calcMs = data.calcMs;
+
+      memset(sections, 0, sizeof(sections));
+      sections[0].type = CHECKPOINT_NODES;
+      sections[0].count = data.nodes.size();
+      sections[0].size = data.nodes.size() * sizeof(CheckpointNodeState);
+      sections[1].type = CHECKPOINT_JOINTS;
+      sections[1].count = data.joints.size();
+      sections[1].size = data.joints.size() * sizeof(CheckpointJointState);
+      sections[2].type = CHECKPOINT_MOTORS;
+      sections[2].count = data.motors.size();
+      sections[2].size = data.motors.size() * sizeof(CheckpointMotorState);
+      sections[3].type = CHECKPOINT_SENSORS;
+      sections[3].count = data.sensors.size();
+      sections[3].size = entriesSize(data.sensors);
+      sections[4].type = CHECKPOINT_TIMERS;
+      sections[4].count = data.timers.size();
+      sections[4].size = entriesSize(data.timers);
+      sections[5].type = CHECKPOINT_PLUGINS;
+      sections[5].count = data.plugins.size();
+      sections[5].size = entriesSize(data.plugins);
+      uint64_t offset = align8(sizeof(header) + sizeof(sections));
+      for(uint32_t i = 0; i < numSections; ++i) {
+        sections[i].offset = offset;
+        offset += align8(sections[i].size);
+      }
+
+      FILE *file = fopen(tmpName.c_str(), "wb");
+      if(!file) {
+        LOG_ERROR("Checkpoint: could not open \"%s\": %s",
+                  tmpName.c_str(), strerror(errno));
+        return false;
+      }
+      bool ok = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 writePadded(file, sections, sizeof(sections)) &&
+                 writePadded(file, data.nodes.empty() ? NULL : &data.nodes[0],
+                             sections[0].size) &&
+                 writePadded(file, data.joints.empty() ? NULL : &data.joints[0],
+                             sections[1].size) &&
+                 writePadded(file, data.motors.empty() ? NULL : &data.motors[0],
+                             sections[2].size) &&
+                 writeEntries(file, data.sensors) &&
+                 writeEntries(file, data.timers) &&
+                 writeEntries(file, data.plugins));
+      ok = (fflush(file) == 0) && ok;
+#ifndef WIN32
+      ok = ok && (fsync(fileno(file)) == 0);
+#endif
+      ok = (fclose(file) == 0) && ok;
+      if(!ok) {
+        LOG_ERROR("Checkpoint: could not write \"%s\": %s",
+                  tmpName.c_str(), strerror(errno));
+        remove(tmpName.c_str());
+        return false;
+      }
+#ifdef WIN32
+      // rename does not replace existing files on Windows
+      remove(filename.c_str());
+#endif
+      if(rename(tmpName.c_str(), filename.c_str()) != 0) {
+        LOG_ERROR("Checkpoint: could not rename \"%s\": %s",
+                  tmpName.c_str(), strerror(errno));
+        return false;
+      }
+      return true;
+    }
+
+    CheckpointReader::CheckpointReader() : mapping(NULL), mappingSize(0),
+                                           header(NULL), sections(NULL) {
+    }
+
+    CheckpointReader::~CheckpointReader() {
+      close();
+    }
+
+    bool CheckpointReader::open(const std::string &filename) {
+      close();
+#ifndef WIN32
+      struct stat fileStat;
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if(fd == -1 || fstat(fd, &fileStat) != 0) {
+        LOG_ERROR("Checkpoint: could not open \"%s\": %s",
+                  filename.c_str(), strerror(errno));
+        if(fd != -1) ::close(fd);
+        return false;
+      }
+      mappingSize = fileStat.st_size;
+      if(mappingSize) {
+        void *m = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m != MAP_FAILED) {
+          mapping = (const char*)m;
+        }
+      }
+      ::close(fd);
+      if(!mapping) {
+        LOG_ERROR("Checkpoint: could not map \"%s\": %s",
+                  filename.c_str(), strerror(errno));
+        mappingSize = 0;
+        return false;
+      }
+#else
+      FILE *file = fopen(filename.c_str(), "rb");
+      if(!file) {
+        LOG_ERROR("Checkpoint: could not open \"%s\"", filename.c_str());
+        return false;
+      }
+      fseek(file, 0, SEEK_END);
+      long size = ftell(file);
+      fseek(file, 0, SEEK_SET);
+      if(size > 0) {
+        buffer.resize((size + 7) / 8);
+        if(fread(&buffer[0], 1, size, file) == (size_t)size) {
+          mapping = (const char*)&buffer[0];
+          mappingSize = size;
+        }
+      }
+      fclose(file);
+      if(!mapping) {
+        LOG_ERROR("Checkpoint: could not read \"%s\"", filename.c_str());
+        buffer.clear();
+        return false;
+      }
+#endif
+
+      header = (const CheckpointFileHeader*)mapping;
+      sections = (const CheckpointSection*)(mapping + sizeof(*header));
+      bool valid = (mappingSize >= sizeof(*header) &&
+                    memcmp(header->magic, CHECKPOINT_FILE_MAGIC,
+                           sizeof(header->magic)) == 0 &&
+                    header->version == CHECKPOINT_FILE_VERSION &&
+                    (mappingSize - sizeof(*header)) / sizeof(*sections) >=
+                    header->numSections);
+      for(uint32_t i = 0; valid && i < header->numSections; ++i) {
+        valid = (sections[i].offset % 8 == 0 &&
+                 sections[i].offset <= mappingSize &&
+                 sections[i].size <= mappingSize - sections[i].offset);
+      }
+      if(!valid) {
+        LOG_ERROR("Checkpoint: \"%s\" is not a valid checkpoint",
+                  filename.c_str());
+        close();
+        return false;
+      }
+      return true;
+    }
+
+    void CheckpointReader::close() {
+#ifndef WIN32
+      if(mapping) {
+        munmap((void*)mapping, mappingSize);
+      }
+#endif
+      buffer.clear();
+      mapping = NULL;
+      mappingSize = 0;
+      header = NULL;
+      sections = NULL;
+    }
+
+    const CheckpointSection*
+    CheckpointReader::findSection(CheckpointSectionType type,
+                                  size_t stateSize) const {
+      if(!header) return NULL;
+      for(uint32_t i = 0; i < header->numSections; ++i) {
+        if(sections[i].type == (uint32_t)type) {
+          if(stateSize &&
+             sections[i].size != (uint64_t)sections[i].count * stateSize) {
+            LOG_ERROR("Checkpoint: section %d has a wrong size", type);
+            return NULL;
+          }
+          return sections + i;
+        }
+      }
+      return NULL;
+    }
+
+    const CheckpointNodeState* CheckpointReader::getNodes(size_t *count) const {
+      const CheckpointSection *section =
+        findSection(CHECKPOINT_NODES, sizeof(CheckpointNodeState));
+      *count = section ? section->count : 0;
+      return section ? (const CheckpointNodeState*)(mapping + section->offset)
+        : NULL;
+    }
+
+    const CheckpointJointState* CheckpointReader::getJoints(size_t *count) const {
+      const CheckpointSection *section =
+        findSection(CHECKPOINT_JOINTS, sizeof(CheckpointJointState));
+      *count = section ? section->count : 0;
+      return section ? (const CheckpointJointState*)(mapping + section->offset)
+        : NULL;
+    }
+
+    const CheckpointMotorState* CheckpointReader::getMotors(size_t *count) const {
+      const CheckpointSection *section =
+        findSection(CHECKPOINT_MOTORS, sizeof(CheckpointMotorState));
+      *count = section ? section->count : 0;
+      return section ? (const CheckpointMotorState*)(mapping + section->offset)
+        : NULL;
+    }
+
+    void CheckpointReader::getEntries(CheckpointSectionType type,
+                                      std::vector<CheckpointEntryView> *entries) const {
+      entries->clear();
+      const CheckpointSection *section = findSection(type, 0);
+      if(!section) return;
+      const char *p = mapping + section->offset;
+      const char *end = p + section->size;
+      for(uint32_t i = 0; i < section->count; ++i) {
+        CheckpointEntry entry;
+        if((size_t)(end - p) < sizeof(entry)) break;
+        memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+        uint64_t nameSize = align8(entry.nameSize);
+        uint64_t dataSize = align8(entry.dataSize);
+        if((uint64_t)(end - p) < nameSize + dataSize) break;
+        CheckpointEntryView view;
+        view.id = entry.id;
+        view.name.assign(p, entry.nameSize);
+        view.data = p + nameSize;
+        view.size = entry.dataSize;
+        entries->push_back(view);
+        p += nameSize + dataSize;
+      }
+      if(entries->size() != section->count) {
+        LOG_ERROR("Checkpoint: section %d is truncated", type);
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
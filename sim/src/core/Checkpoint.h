@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file Checkpoint.h
+ * \brief Writes and reads the binary checkpoints of CheckpointFormat.h.
+ */
+
+#ifndef MARS_SIM_CHECKPOINT_H
+#define MARS_SIM_CHECKPOINT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "Checkpoint.h"
+#endif
+
+#include "CheckpointFormat.h"
+
+#include <mars/utils/Thread.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace sim {
+
+    /** \brief A named or numbered state of variable size. */
+    struct CheckpointBlob {
+      uint64_t id;
+      std::string name;
+      std::vector<char> data;
+    };
+
+    /** \brief A view of a CheckpointBlob inside a CheckpointReader. */
+    struct CheckpointEntryView {
+      uint64_t id;
+      std::string name;
+      const char *data;
+      size_t size;
+    };
+
+    /** \brief The dynamic state of the simulation in memory. */
+    struct CheckpointData {
+      CheckpointData() : simTimeNs(0), calcMs(0.) {}
+      void clear();
+
+      int64_t simTimeNs;
+      double calcMs;
+      std::vector<CheckpointNodeState> nodes;
+      std::vector<CheckpointJointState> joints;
+      std::vector<CheckpointMotorState> motors;
+      std::vector<CheckpointBlob> sensors;
+      std::vector<CheckpointBlob> timers;
+      std::vector<CheckpointBlob> plugins;
+    };
+
+    /**
+     * \brief Writes a CheckpointData to a file in a background thread.
+     *
+     * The file is written to "<filename>.tmp" and renamed when it is
+     * complete, so a crash while writing keeps the previous checkpoint.
+     */
+    class CheckpointWriter : public utils::Thread {
+    public:
+      CheckpointWriter();
+      ~CheckpointWriter();
+
+      /**
+       * \brief starts writing \a data to \a filename
+       *
+       * The content of \a data is taken over, \a data is left with the
+       * buffers of the previous checkpoint to avoid reallocations.
+       * \return \c false if the previous checkpoint is still being written
+       */
+      bool write(const std::string &filename, CheckpointData *data);
+
+      /** \brief \c true while a checkpoint is being written */
+      bool isBusy() const;
+
+      /** \brief waits until the current checkpoint is written */
+      void finish();
+
+      /** \brief writes \a data to \a filename in the calling thread */
+      static bool writeFile(const std::string &filename,
+                            const CheckpointData &data);
+
+    protected:
+      void run();
+
+    private:
+      CheckpointData data;
+      std::string filename;
+      bool started;
+    };
+
+    /**
+     * \brief Maps a checkpoint file into memory and gives access to its
+     *        sections without copying them.
+     *
+     * The pointers and views that are returned are valid until close()
+     * is called or the reader is destroyed.
+     */
+    class CheckpointReader {
+    public:
+      CheckpointReader();
+      ~CheckpointReader();
+
+      bool open(const std::string &filename);
+      void close();
+
+      inline int64_t getSimTimeNs() const
+      { return header ? header->simTimeNs : 0; }
+      inline double getCalcMs() const
+      { return header ? header->calcMs : 0.; }
+
+      const CheckpointNodeState* getNodes(size_t *count) const;
+      const CheckpointJointState* getJoints(size_t *count) const;
+      const CheckpointMotorState* getMotors(size_t *count) const;
+
+      /** \brief returns the entries of a sensor, timer or plugin section */
+      void getEntries(CheckpointSectionType type,
+                      std::vector<CheckpointEntryView> *entries) const;
+
+    private:
+      const CheckpointSection* findSection(CheckpointSectionType type,
+                                           size_t stateSize) const;
+
+      // disallow copying
+      CheckpointReader(const CheckpointReader &);
+      CheckpointReader &operator=(const CheckpointReader &);
+
+      const char *mapping;
+      size_t mappingSize;
+      std::vector<uint64_t> buffer; ///< the file content if mmap is missing
+      const CheckpointFileHeader *header;
+      const CheckpointSection *sections;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_CHECKPOINT_H
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file CheckpointFormat.h
+ * \brief On-disk layout of the binary simulation checkpoints.
+ *
+ * A checkpoint file starts with a CheckpointFileHeader that is followed by
+ * numSections CheckpointSection entries. Each section points to its data
+ * in the file. All offsets and sizes are multiples of eight bytes, so the
+ * fixed size states of a mapped file can be used in place.
+ *
+ * The node, joint and motor sections are arrays of CheckpointNodeState,
+ * CheckpointJointState and CheckpointMotorState. The sensor, timer and
+ * plugin sections are sequences of CheckpointEntry records, each followed
+ * by its name and its data, both padded to eight bytes. Sensors are keyed
+ * by their id, timers and plugins by their name. The data of a timer is
+ * its time as int64_t in ns.
+ *
+ * All values are stored in host byte order.
+ */
+
+#ifndef MARS_SIM_CHECKPOINT_FORMAT_H
+#define MARS_SIM_CHECKPOINT_FORMAT_H
+
+#ifdef _PRINT_HEADER_
+  #warning "CheckpointFormat.h"
+#endif
+
+#include <stdint.h>
+
+namespace mars {
+  namespace sim {
+
+    const char CHECKPOINT_FILE_MAGIC[8] = {'M', 'A', 'R', 'S', 'C', 'K', 'P', 0};
+    const uint32_t CHECKPOINT_FILE_VERSION = 1;
+
+    enum CheckpointSectionType {
+      CHECKPOINT_NODES = 1,
+      CHECKPOINT_JOINTS,
+      CHECKPOINT_MOTORS,
+      CHECKPOINT_SENSORS,
+      CHECKPOINT_TIMERS,
+      CHECKPOINT_PLUGINS
+    };
+
+    struct CheckpointFileHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t numSections;
+      int64_t simTimeNs;
+      double calcMs;        ///< step size the checkpoint was taken with
+    };
+
+    struct CheckpointSection {
+      uint32_t type;        ///< a CheckpointSectionType
+      uint32_t count;       ///< number of states or entries
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    struct CheckpointNodeState {
+      uint64_t id;
+      double position[3];
+      double rotation[4];   ///< x, y, z, w
+      double linearVelocity[3];
+      double angularVelocity[3];
+    };
+
+    struct CheckpointJointState {
+      uint64_t id;
+      double position[2];
+      double velocity[2];
+      double force[2][3];
+      double torque[2][3];
+      double axisTorque[2][3];
+      double jointLoad[3];
+      double motorTorque;
+    };
+
+    struct CheckpointMotorState {
+      uint64_t id;
+      double time;
+      double controlValue;
+      double lastVelocity, velocity;
+      double effort, current, temperature, filterValue;
+      double lastError, integError, error;
+      double jointVelocity;
+      double tmpMaxEffort, tmpMaxSpeed;
+      uint32_t active;
+      uint32_t reserved;
+    };
+
+    struct CheckpointEntry {
+      uint64_t id;
+      uint32_t nameSize;    ///< without padding and without terminating zero
+      uint32_t dataSize;    ///< without padding
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_CHECKPOINT_FORMAT_H
@@ -37,12 +37,33 @@
 #include <mars/interfaces/sim/SensorManagerInterface.h>
 #include <mars/utils/misc.h>
 #include <mars/utils/mathUtils.h>
+#include <mars/utils/Trace.h>
 #include <mars/interfaces/Logging.hpp>
 #include <mars/data_broker/DataBrokerInterface.h>
 #include <mars/cfg_manager/CFGManagerInterface.h>
 
 #include <cmath>
 #include <cstring>
+#include <algorithm>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <poll.h>
+#include <errno.h>
+#include <netinet/tcp.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// time after which a lockstep client that does not answer is detached
+#define SHM_LOCKSTEP_TIMEOUT 2000
+// attempts to read the commands before a client is assumed to have died
+// while writing them
+#define SHM_COMMAND_READ_RETRIES 1000
+// commands of the asynchronous mode that wait to be applied
+#define ASYNC_MAX_COMMANDS 1024
 
 namespace mars {
   namespace sim {
@@ -86,6 +107,23 @@ namespace mars {
       dy = 0;
       dylibController = 0;
       count_ms = 0;
+      shm = 0;
+      shmSize = 0;
+      shmCommandSerial = 0;
+      asyncMode = false;
+      asyncStep = asyncMotorStep = 0;
+      asyncSensorsPending = asyncMotorsPending = false;
+      lateFrames = 0;
+      droppedFrames = 0;
+      sendOffset = 0;
+      asyncConnected = false;
+      wakePipe[0] = wakePipe[1] = -1;
+#ifndef WIN32
+      if(::pipe(wakePipe) == 0) {
+        fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+      }
+#endif
 #ifdef WIN32
       if(!Controller::sock_init) {
         /* Initialisiere TCP f�r Windows ("winsock") */
@@ -113,6 +151,7 @@ namespace mars {
 
     Controller::~Controller(void){
       running = false;
+      closeShm();
       if(dy) {
 #ifdef WIN32
         if(dylibController) {
@@ -128,10 +167,17 @@ namespace mars {
         dlclose(dy);
 #endif
       }
-      if(connected) close(conn);
-      connected = false;
+      // the controller thread uses the connection in the async mode
       while(!isFinished()) 
         msleep(10);
+      if(connected) close(conn);
+      connected = false;
+#ifndef WIN32
+      if(wakePipe[0] != -1) {
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+      }
+#endif
     }
     
     void Controller::setID(unsigned long id) {
@@ -172,7 +218,10 @@ namespace mars {
 #endif
       if ((count_ms += time_ms) >= sController.rate) {
         count_ms -= sController.rate;
-        if (dylibController) {
+        if (shm) {
+          updateShm();
+        }
+        else if (dylibController) {
           for (i=0; i<100; i++) t_sensors[i] = t_motors[i] = 0;
           for (iter = sensors.begin(); iter != sensors.end(); iter++) {
             count_val = (*iter)->getSensorData(&sens_val);
@@ -409,6 +458,9 @@ namespace mars {
               (*jter)->setControlValue((sReal)*pt_motors);
           }
         }
+        else if(asyncMode) {
+          if(connected) updateAsync();
+        }
         else if(connected) {
           // here we can communicate
 #ifdef WIN32
@@ -773,6 +825,456 @@ namespace mars {
       }
     }
 
+    bool Controller::openShm(const std::string &name, bool lockstep) {
+#ifdef WIN32
+      LOG_ERROR("Controller: the shared memory transport is not supported");
+      return false;
+#else
+      std::vector<BaseSensor*>::iterator iter;
+      sReal *sens_val;
+      uint32_t numSensorValues = 0;
+
+      closeShm();
+      for(iter = sensors.begin(); iter != sensors.end(); ++iter) {
+        numSensorValues += (*iter)->getSensorData(&sens_val);
+        free(sens_val);
+      }
+      shmName = name[0] == '/' ? name : "/" + name;
+      uint64_t size = controllerShmSize(numSensorValues, motors.size());
+
+      // always start with a fresh segment
+      shm_unlink(shmName.c_str());
+      int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      if(fd < 0) {
+        LOG_ERROR("Controller: cannot create shared memory %s",
+                  shmName.c_str());
+        return false;
+      }
+      void *mem = MAP_FAILED;
+      if(ftruncate(fd, size) == 0) {
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+      close(fd);
+      if(mem == MAP_FAILED) {
+        LOG_ERROR("Controller: cannot map shared memory %s", shmName.c_str());
+        shm_unlink(shmName.c_str());
+        return false;
+      }
+      memset(mem, 0, size);
+      ControllerShmHeader *header = (ControllerShmHeader*)mem;
+      shmSize = size;
+      shmNumSensorValues = numSensorValues;
+      shmSensorOffset = sizeof(ControllerShmHeader);
+      shmMotorOffset = shmSensorOffset + numSensorValues*sizeof(double);
+      shmCommandOffset = shmMotorOffset + motors.size()*sizeof(double);
+      shmLockstep = lockstep;
+      header->version = CONTROLLER_SHM_VERSION;
+      header->mode = lockstep ? CONTROLLER_SHM_LOCKSTEP :
+        CONTROLLER_SHM_FREE_RUNNING;
+      header->size = shmSize;
+      header->rate = sController.rate;
+      header->numSensorValues = shmNumSensorValues;
+      header->numMotors = motors.size();
+      header->sensorOffset = shmSensorOffset;
+      header->motorOffset = shmMotorOffset;
+      header->commandOffset = shmCommandOffset;
+      // clients check the magic last
+      std::atomic_thread_fence(std::memory_order_release);
+      memcpy(header->magic, CONTROLLER_SHM_MAGIC, sizeof(header->magic));
+
+      shmMotors.resize(motors.size());
+      shmCommands.resize(CONTROLLER_SHM_MAX_COMMANDS);
+      shmCommandSerial = 0;
+      shm = header;
+
+      // the shared memory replaces the TCP connection
+      auto_connect = false;
+      if(connected) {
+        close(conn);
+        connected = 0;
+      }
+      LOG_INFO("Controller: shared memory %s (%s)", shmName.c_str(),
+               lockstep ? "lockstep" : "free running");
+      return true;
+#endif
+    }
+
+    void Controller::closeShm(void) {
+#ifndef WIN32
+      if(shm) {
+        ControllerShmHeader *header = shm;
+        shm = 0;
+        munmap(header, shmSize);
+        shm_unlink(shmName.c_str());
+      }
+#endif
+    }
+
+    void Controller::updateShm(void) {
+      std::vector<BaseSensor*>::iterator iter;
+      std::vector<SimMotor*>::iterator jter;
+      char *base = (char*)shm;
+      double *sensorValues = (double*)(base + shmSensorOffset);
+      const double *motorValues = (double*)(base + shmMotorOffset);
+      const ControllerShmCommand *commandQueue;
+      commandQueue = (ControllerShmCommand*)(base + shmCommandOffset);
+      sReal *sens_val;
+      uint32_t count = 0, s, s2, step, reply, serial, numCommands;
+      int count_val;
+
+      s = shmSeqWriteBegin(&shm->sensorSequence);
+      for(iter = sensors.begin(); iter != sensors.end(); ++iter) {
+        count_val = (*iter)->getSensorData(&sens_val);
+        for(int i = 0; i < count_val && count < shmNumSensorValues; ++i) {
+          sensorValues[count++] = sens_val[i];
+        }
+        free(sens_val);
+      }
+      shm->sensorCount.store(count, std::memory_order_relaxed);
+      shmSeqWriteEnd(&shm->sensorSequence, s);
+
+      step = shm->step.load(std::memory_order_relaxed) + 1;
+      shm->step.store(step, std::memory_order_release);
+      shmWake(&shm->step, &shm->stepWaiters);
+
+      if(shmLockstep) {
+        long long start = getTime();
+        while(shm->attached.load() &&
+              (reply = shm->reply.load(std::memory_order_acquire)) != step) {
+          if(getTimeDiff(start) > SHM_LOCKSTEP_TIMEOUT) {
+            LOG_WARN("Controller: shared memory client does not answer, "
+                     "detaching it");
+            shm->attached.store(0);
+            break;
+          }
+          shmWait(&shm->reply, &shm->replyWaiters, reply, 100);
+        }
+      }
+      if(shm->reply.load(std::memory_order_acquire) == 0) {
+        // no client answered yet
+        return;
+      }
+
+      // motor values and new commands are read in one consistent copy
+      for(int retries = 0; ; ++retries) {
+        if(retries == SHM_COMMAND_READ_RETRIES) {
+          // skip the commands of this step
+          if(shm->attached.exchange(0)) {
+            LOG_WARN("Controller: shared memory client stopped while "
+                     "writing commands, detaching it");
+          }
+          return;
+        }
+        s = shm->commandSequence.load(std::memory_order_acquire);
+        if(s & 1) continue;
+        if(!shmMotors.empty()) {
+          memcpy(&shmMotors[0], motorValues, shmMotors.size()*sizeof(double));
+        }
+        serial = shm->commandSerial.load(std::memory_order_relaxed);
+        numCommands = 0;
+        if(serial != shmCommandSerial) {
+          numCommands = std::min(shm->numCommands.load(std::memory_order_relaxed),
+                                 CONTROLLER_SHM_MAX_COMMANDS);
+          memcpy(&shmCommands[0], commandQueue,
+                 numCommands*sizeof(ControllerShmCommand));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = shm->commandSequence.load(std::memory_order_relaxed);
+        if(s == s2) break;
+      }
+      shmCommandSerial = serial;
+
+      for(uint32_t i = 0; i < numCommands; ++i) {
+        if(shmCommands[i].type == CONTROLLER_SHM_RESET_SIM) {
+          control->sim->resetSim();
+          return;
+        }
+      }
+      for(jter = motors.begin(), count = 0;
+          jter != motors.end() && count < shmMotors.size(); ++jter, ++count) {
+        (*jter)->setControlValue((sReal)shmMotors[count]);
+      }
+      for(uint32_t i = 0; i < numCommands; ++i) {
+        applyCommand(shmCommands[i]);
+      }
+    }
+
+    void Controller::applyCommand(const ControllerShmCommand &command) {
+      const double *v = command.values;
+      unsigned long id = command.id;
+      sRotation rot;
+
+      switch(command.type) {
+      case COMMAND_MOTOR_POSITION:
+        if(id < motors.size()) motors[id]->setControlValue(v[0]);
+        break;
+      case COMMAND_MOTOR_MAX_VELOCITY:
+        if(id < motors.size()) motors[id]->setMaxSpeed(v[0]);
+        break;
+      case COMMAND_MOTOR_PID:
+        if(id < motors.size()) motors[id]->setPID(v[0], v[1], v[2]);
+        break;
+      case COMMAND_NODE_POSITION:
+        control->nodes->setPosition(id, Vector(v[0], v[1], v[2]));
+        break;
+      case COMMAND_NODE_ROTATION:
+        rot.alpha = v[0];
+        rot.beta = v[1];
+        rot.gamma = v[2];
+        control->nodes->setRotation(id, eulerToQuaternion(rot));
+        break;
+      case COMMAND_NODE_VELOCITY:
+        control->nodes->setVelocity(id, Vector(v[0], v[1], v[2]));
+        break;
+      case COMMAND_NODE_ANGULAR_VELOCITY:
+        control->nodes->setAngularVelocity(id, Vector(v[0], v[1], v[2]));
+        break;
+      case COMMAND_NODE_APPLY_FORCE:
+        control->nodes->applyForce(id, Vector(v[0], v[1], v[2]));
+        break;
+      case COMMAND_NODE_APPLY_FORCE_AT:
+        control->nodes->applyForce(id, Vector(v[0], v[1], v[2]),
+                                   Vector(v[3], v[4], v[5]));
+        break;
+      case COMMAND_NODE_ANGULAR_DAMPING:
+        control->nodes->setAngularDamping(id, v[0]);
+        break;
+      case COMMAND_NODES_CONNECT:
+        control->sim->connectNodes(id, (unsigned long)v[0]);
+        break;
+      case COMMAND_NODES_DISCONNECT:
+        control->sim->disconnectNodes(id, (unsigned long)v[0]);
+        break;
+      case COMMAND_PHYSICS_GRAVITY:
+        control->sim->setGravity(Vector(v[0], v[1], v[2]));
+        break;
+      default:
+        break;
+      }
+    }
+
+    void Controller::setAsyncMode(bool async) {
+#ifdef WIN32
+      if(async) {
+        LOG_ERROR("Controller: the asynchronous mode is not supported");
+      }
+#else
+      asyncMode = async;
+#endif
+    }
+
+    bool Controller::getAsyncMode(void) const {
+      return asyncMode;
+    }
+
+    unsigned long Controller::getLateFrames(void) const {
+      return lateFrames;
+    }
+
+    unsigned long Controller::getDroppedFrames(void) const {
+      return droppedFrames;
+    }
+
+    void Controller::updateAsync(void) {
+      std::vector<BaseSensor*>::iterator iter;
+      std::vector<SimMotor*>::iterator jter;
+      sReal *sens_val;
+      int count_val;
+      bool newMotors;
+      size_t i;
+
+      sensorBuffer.clear();
+      for(iter = sensors.begin(); iter != sensors.end(); ++iter) {
+        count_val = (*iter)->getSensorData(&sens_val);
+        sensorBuffer.insert(sensorBuffer.end(), sens_val, sens_val+count_val);
+        free(sens_val);
+      }
+
+      // publish the snapshot and take the latest answer of the client
+      asyncMutex.lock();
+      if(asyncSensorsPending) {
+        ++droppedFrames;
+      }
+      asyncSensors.swap(sensorBuffer);
+      asyncSensorsPending = true;
+      ++asyncStep;
+      newMotors = asyncMotorsPending;
+      if(newMotors) {
+        motorBuffer.swap(asyncMotors);
+        asyncMotorsPending = false;
+        // the client has one control period to answer a snapshot
+        if(asyncMotorStep + 1 < asyncStep) {
+          ++lateFrames;
+        }
+      }
+      commandBuffer.clear();
+      commandBuffer.swap(asyncCommands);
+      asyncMutex.unlock();
+#ifndef WIN32
+      if(write(wakePipe[1], "", 1) < 0) {
+        // the pipe is full, the controller thread is awake anyway
+      }
+#endif
+
+      for(i = 0; i < commandBuffer.size(); ++i) {
+        if(commandBuffer[i].type == CONTROLLER_SHM_RESET_SIM) {
+          control->sim->resetSim();
+          return;
+        }
+      }
+      if(newMotors) {
+        for(jter = motors.begin(), i = 0;
+            jter != motors.end() && i < motorBuffer.size(); ++jter, ++i) {
+          (*jter)->setControlValue((sReal)motorBuffer[i]);
+        }
+      }
+      for(i = 0; i < commandBuffer.size(); ++i) {
+        applyCommand(commandBuffer[i]);
+      }
+    }
+
+    void Controller::runAsync(void) {
+#ifndef WIN32
+      struct pollfd fds[2];
+      ControllerFrameHeader header;
+      char buffer[4096];
+      ssize_t n;
+
+      if(!asyncConnected) {
+        int flag = 1;
+        fcntl(conn, F_SETFL, fcntl(conn, F_GETFL) | O_NONBLOCK);
+        setsockopt(conn, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        sendBuffer.clear();
+        recvBuffer.clear();
+        sendOffset = 0;
+        asyncConnected = true;
+      }
+
+      // take the latest snapshot once the previous frame is sent
+      if(sendOffset == sendBuffer.size()) {
+        asyncMutex.lock();
+        if(asyncSensorsPending) {
+          header.magic = CONTROLLER_FRAME_MAGIC;
+          header.type = CONTROLLER_FRAME_SENSORS;
+          header.step = asyncStep;
+          header.count = asyncSensors.size();
+          sendBuffer.resize(sizeof(header) + header.count*sizeof(double));
+          memcpy(&sendBuffer[0], &header, sizeof(header));
+          if(header.count) {
+            memcpy(&sendBuffer[sizeof(header)], &asyncSensors[0],
+                   header.count*sizeof(double));
+          }
+          sendOffset = 0;
+          asyncSensorsPending = false;
+        }
+        asyncMutex.unlock();
+      }
+      if(sendOffset < sendBuffer.size()) {
+        n = ::send(conn, &sendBuffer[sendOffset],
+                   sendBuffer.size()-sendOffset, MSG_NOSIGNAL);
+        if(n > 0) {
+          sendOffset += n;
+        } else if(errno != EAGAIN && errno != EWOULDBLOCK) {
+          connectionLost();
+          return;
+        }
+      }
+
+      fds[0].fd = conn;
+      fds[0].events = POLLIN;
+      if(sendOffset < sendBuffer.size()) {
+        fds[0].events |= POLLOUT;
+      }
+      fds[1].fd = wakePipe[0];
+      fds[1].events = POLLIN;
+      if(poll(fds, 2, 100) <= 0) {
+        return;
+      }
+      if(fds[1].revents & POLLIN) {
+        while(read(wakePipe[0], buffer, sizeof(buffer)) > 0) ;
+      }
+      if(fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+        MARS_TRACE_SCOPE("Controller::receive");
+        while((n = ::recv(conn, buffer, sizeof(buffer), 0)) > 0) {
+          recvBuffer.insert(recvBuffer.end(), buffer, buffer+n);
+        }
+        if(n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) ||
+           !parseFrames()) {
+          connectionLost();
+        }
+      }
+#endif
+    }
+
+    bool Controller::parseFrames(void) {
+      ControllerFrameHeader header;
+      size_t offset = 0, size;
+
+      while(recvBuffer.size() - offset >= sizeof(header)) {
+        memcpy(&header, &recvBuffer[offset], sizeof(header));
+        if(header.magic != CONTROLLER_FRAME_MAGIC) {
+          LOG_ERROR("Controller: invalid frame");
+          return false;
+        }
+        if(header.type == CONTROLLER_FRAME_MOTORS) {
+          size = header.count*sizeof(double);
+        } else if(header.type == CONTROLLER_FRAME_COMMANDS) {
+          size = header.count*sizeof(ControllerShmCommand);
+        } else {
+          LOG_ERROR("Controller: invalid frame type %u", header.type);
+          return false;
+        }
+        if(recvBuffer.size() - offset - sizeof(header) < size) {
+          break;
+        }
+        const char *payload = &recvBuffer[offset + sizeof(header)];
+        asyncMutex.lock();
+        if(header.type == CONTROLLER_FRAME_MOTORS) {
+          if(asyncMotorsPending) {
+            ++droppedFrames;
+          }
+          asyncMotors.resize(header.count);
+          if(size) {
+            memcpy(&asyncMotors[0], payload, size);
+          }
+          asyncMotorStep = header.step;
+          asyncMotorsPending = true;
+        } else {
+          for(uint32_t i = 0; i < header.count; ++i) {
+            if(asyncCommands.size() >= ASYNC_MAX_COMMANDS) {
+              ++droppedFrames;
+              break;
+            }
+            ControllerShmCommand command;
+            memcpy(&command, payload + i*sizeof(command), sizeof(command));
+            asyncCommands.push_back(command);
+          }
+        }
+        asyncMutex.unlock();
+        offset += sizeof(header) + size;
+      }
+      recvBuffer.erase(recvBuffer.begin(), recvBuffer.begin() + offset);
+      return true;
+    }
+
+    void Controller::connectionLost(void) {
+      if(connected) {
+#ifdef WIN32
+        closesocket(conn);
+#else
+        close(conn);
+#endif
+        conn = 0;
+        LOG_ERROR("Controller: connection lost");
+      }
+      connected = false;
+      sock_state = 0;
+      asyncConnected = false;
+      sendBuffer.clear();
+      recvBuffer.clear();
+      sendOffset = 0;
+    }
+
     int Controller::getSReal(const char *data, sReal *value) const {
       size_t d=0, i=0;
       const size_t BUFFER_SIZE = 50;
@@ -994,8 +1496,16 @@ namespace mars {
     }
 
     void Controller::run(void) {
+      MARS_TRACE_THREAD_NAME("controller");
 
       while (running) {
+        if (asyncMode && connected) {
+          runAsync();
+          continue;
+        }
+        if (asyncConnected) {
+          connectionLost();
+        }
         if (!connected && auto_connect) {
           if (conn) {
 #ifdef WIN32
@@ -56,6 +56,11 @@
 #include <mars/interfaces/sensor_bases.h>
 #include <mars/interfaces/ControllerData.h>
 #include <mars/interfaces/sim/ControllerInterface.h>
+#include <mars/interfaces/sim/ControllerShmLayout.h>
+#include <mars/interfaces/sim/ControllerFrame.h>
+#include <mars/utils/Mutex.h>
+
+#include <atomic>
 
 namespace mars {
   namespace sim {
@@ -92,6 +97,34 @@ namespace mars {
       void connect(void);
       void disconnect(void);
 
+      /**
+       * \brief Switches the controller to the shared memory transport.
+       *
+       * Creates the segment \a name with the layout of
+       * ControllerShmLayout.h and stops the TCP connection.
+       * \param lockstep If \c true the simulation waits for the answer of an
+       *                 attached client at every control step, otherwise
+       *                 it applies the latest motor values.
+       * \return \c true if the segment was created
+       */
+      bool openShm(const std::string &name, bool lockstep);
+
+      /**
+       * \brief Selects the asynchronous socket mode.
+       *
+       * In this mode the physics thread never waits for the network. It
+       * publishes a sensor snapshot at every control step and applies the
+       * latest motor values received from the client. The controller
+       * thread exchanges the binary frames of ControllerFrame.h with the
+       * client.
+       */
+      void setAsyncMode(bool async);
+      bool getAsyncMode(void) const;
+      /// motor frames that answered an older than the previous sensor frame
+      unsigned long getLateFrames(void) const;
+      /// sensor and motor frames that were replaced before their use
+      unsigned long getDroppedFrames(void) const;
+
 #ifdef WIN32
       static bool sock_init;
 #endif
@@ -120,6 +153,39 @@ namespace mars {
       std::vector<SimMotor*> motors;
       std::vector<interfaces::BaseSensor*> sensors;
       std::vector<interfaces::NodeData*> sNodes;
+      interfaces::ControllerShmHeader *shm;
+      std::string shmName;
+      // the layout is kept here, the header is writable by the client
+      uint64_t shmSize, shmSensorOffset, shmMotorOffset, shmCommandOffset;
+      uint32_t shmNumSensorValues;
+      bool shmLockstep;
+      uint32_t shmCommandSerial;
+      std::vector<double> shmMotors;
+      std::vector<interfaces::ControllerShmCommand> shmCommands;
+      void updateShm(void);
+      void closeShm(void);
+      void applyCommand(const interfaces::ControllerShmCommand &command);
+
+      // asynchronous socket mode, the async members are guarded by
+      // asyncMutex
+      std::atomic<bool> asyncMode;
+      mars::utils::Mutex asyncMutex;
+      std::vector<double> asyncSensors, sensorBuffer;
+      std::vector<double> asyncMotors, motorBuffer;
+      std::vector<interfaces::ControllerShmCommand> asyncCommands;
+      std::vector<interfaces::ControllerShmCommand> commandBuffer;
+      uint32_t asyncStep, asyncMotorStep;
+      bool asyncSensorsPending, asyncMotorsPending;
+      std::atomic<unsigned long> lateFrames, droppedFrames;
+      int wakePipe[2];
+      // only used by the controller thread
+      std::vector<char> sendBuffer, recvBuffer;
+      size_t sendOffset;
+      bool asyncConnected;
+      void updateAsync(void);
+      void runAsync(void);
+      bool parseFrames(void);
+      void connectionLost(void);
       int initServer(int port);
       void getClient(void);
       int openClient(const char *host, int port);
@@ -37,6 +37,7 @@
 #include <mars/interfaces/sim/MotorManagerInterface.h>
 #include <mars/interfaces/sim/SensorManagerInterface.h>
 #include <mars/utils/MutexLocker.h>
+#include <mars/utils/Trace.h>
 #include <mars/interfaces/Logging.hpp>
 
 #include <stdexcept>
@@ -261,6 +262,7 @@ namespace mars {
      * \param calc_ms The timing value in miliseconds.
      */
     void ControllerManager::updateControllers(double calc_ms) {
+      MARS_TRACE_SCOPE("ControllerManager::updateControllers");
       MutexLocker locker(&iMutex);
 
       map<unsigned long, Controller*>::iterator iter;
@@ -350,6 +352,10 @@ namespace mars {
       newController = new Controller(controller.rate, vmotor, vsensor, nodes,
                                      control, std_port);
       newController->setDylibPath(controller.dylib_path);
+      newController->setAsyncMode(controller.async);
+      if(!controller.shm_name.empty()) {
+        newController->openShm(controller.shm_name, controller.lockstep);
+      }
       newController->setID(id);
       iMutex.lock();
       simController[id] = newController;
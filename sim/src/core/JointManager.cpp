@@ -40,6 +40,7 @@
 #include <mars/utils/misc.h>
 #include <mars/utils/mathUtils.h>
 #include <mars/utils/MutexLocker.h>
+#include <mars/utils/Trace.h>
 #include <mars/interfaces/Logging.hpp>
 #include <mars/data_broker/DataBrokerInterface.h>
 
@@ -120,6 +121,7 @@ namespace mars {
         //    newJoint->setSJoint(*jointS);
         newJoint->setPhysicalJoint(newJointInterface);
         simJoints[jointS->index] = newJoint;
+        jointNames.add(jointS->name, jointS->index);
         iMutex.unlock();
         control->sim->sceneHasChanged(false);
         return jointS->index;
@@ -194,6 +196,7 @@ namespace mars {
       if (iter != simJoints.end()) {
         tmpJoint = iter->second;
         simJoints.erase(iter);
+        jointNames.remove(tmpJoint->getName(), index);
       }
 
       control->motors->removeJointFromMotors(index);
@@ -250,6 +253,7 @@ namespace mars {
     }
 
     void JointManager::updateJoints(sReal calc_ms) {
+      MARS_TRACE_SCOPE("JointManager::updateJoints");
       MutexLocker locker(&iMutex);
       map<unsigned long, SimJoint*>::iterator iter;
       for(iter = simJoints.begin(); iter != simJoints.end(); iter++) {
@@ -267,6 +271,7 @@ namespace mars {
         delete simJoints.begin()->second;
         simJoints.erase(simJoints.begin());
       }
+      jointNames.clear();
       control->sim->sceneHasChanged(false);
 
       next_joint_id = 1;
@@ -369,14 +374,8 @@ namespace mars {
 
 
     unsigned long JointManager::getID(const std::string& joint_name) const {
-      map<unsigned long, SimJoint*>::const_iterator iter;
       MutexLocker locker(&iMutex);
-      for(iter = simJoints.begin(); iter != simJoints.end(); iter++) {
-        JointData joint = iter->second->getSJoint();
-        if (joint.name == joint_name)
-          return joint.index;
-      }
-      return 0;
+      return jointNames.find(joint_name);
     }
 
     unsigned long JointManager::getIDByNodeIDs(unsigned long id1, unsigned long id2) {
@@ -37,6 +37,8 @@
 #include <mars/interfaces/sim/JointManagerInterface.h>
 #include <mars/utils/Mutex.h>
 
+#include "NameIndex.h"
+
 namespace mars {
   namespace sim {
 
@@ -96,6 +98,7 @@ namespace mars {
     private:
       unsigned long next_joint_id;
       std::map<unsigned long, SimJoint*> simJoints;
+      NameIndex jointNames; // of simJoints
       std::list<interfaces::JointData> simJointsReload;
       interfaces::ControlCenter *control;
       mutable utils::Mutex iMutex;
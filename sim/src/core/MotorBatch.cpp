@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MotorBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The controller loops read and write many arrays. Without this hint the
+// compiler has to assume that they overlap and does not vectorize them.
+#if defined(__clang__)
+#  define MOTOR_BATCH_LOOP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#  define MOTOR_BATCH_LOOP _Pragma("GCC ivdep")
+#else
+#  define MOTOR_BATCH_LOOP
+#endif
+
+namespace mars {
+  namespace sim {
+
+    /// \cond HIDDEN_SYMBOLS
+    namespace {
+      typedef std::vector<double> MotorBatch::*Field;
+      const Field fields[] = {
+        &MotorBatch::minValue, &MotorBatch::maxValue,
+        &MotorBatch::p, &MotorBatch::i, &MotorBatch::d,
+        &MotorBatch::filter, &MotorBatch::speedLimit,
+        &MotorBatch::effortLimit, &MotorBatch::maxSpeed,
+        &MotorBatch::maxEffort, &MotorBatch::position,
+        &MotorBatch::controlValue, &MotorBatch::error,
+        &MotorBatch::lastError, &MotorBatch::integError,
+        &MotorBatch::velocity, &MotorBatch::lastVelocity,
+        &MotorBatch::effort
+      };
+      const size_t numFields = sizeof(fields) / sizeof(fields[0]);
+    } // end of anonymous namespace
+    /// \endcond
+
+    size_t MotorBatch::add(SimMotor *motor) {
+      motors.push_back(motor);
+      for(size_t f = 0; f < numFields; ++f) {
+        (this->*fields[f]).push_back(0.);
+      }
+      return motors.size() - 1;
+    }
+
+    SimMotor* MotorBatch::remove(size_t index) {
+      size_t last = motors.size() - 1;
+      SimMotor *moved = NULL;
+      if(index != last) {
+        copySlot(index, *this, last);
+        moved = motors[index] = motors[last];
+      }
+      motors.pop_back();
+      for(size_t f = 0; f < numFields; ++f) {
+        (this->*fields[f]).pop_back();
+      }
+      return moved;
+    }
+
+    void MotorBatch::copySlot(size_t index, const MotorBatch &batch,
+                              size_t from) {
+      for(size_t f = 0; f < numFields; ++f) {
+        (this->*fields[f])[index] = (batch.*fields[f])[from];
+      }
+    }
+
+    // see SimMotor::runPositionController
+    void MotorBatch::runPositionController(double time) {
+      const size_t n = size();
+      if(!n) return;
+      const double *minV = minValue.data();
+      const double *maxV = maxValue.data();
+      const double *pV = p.data();
+      const double *iV = i.data();
+      const double *dV = d.data();
+      const double *filterV = filter.data();
+      const double *limitV = speedLimit.data();
+      const double *positionV = position.data();
+      double *valueV = controlValue.data();
+      double *errorV = error.data();
+      double *lastErrorV = lastError.data();
+      double *integV = integError.data();
+      double *velocityV = velocity.data();
+      double *lastVelocityV = lastVelocity.data();
+
+      MOTOR_BATCH_LOOP
+      for(size_t k = 0; k < n; ++k) {
+        double value = std::max(minV[k], std::min(valueV[k], maxV[k]));
+        double e = value - positionV[k];
+        e = std::abs(e) < 0.000001 ? 0.0 : e;
+        double integ = integV[k] + e*time;
+
+        // anti wind up, the division is done for all motors to keep the
+        // loop free of branches, its result is only used if i is not zero
+        double limit = limitV[k];
+        double integLimit = limit / iV[k];
+        double iPart = integ * iV[k];
+        bool high = iPart > limit;
+        iPart = high ? limit : iPart;
+        integ = high ? integLimit : integ;
+        bool low = iPart < -limit;
+        iPart = low ? -limit : iPart;
+        integ = low ? -integLimit : integ;
+
+        double v = e * pV[k] + iPart + ((e - lastErrorV[k])/time) * dV[k];
+        v = lastVelocityV[k]*filterV[k] + v*(1-filterV[k]);
+
+        valueV[k] = value;
+        errorV[k] = e;
+        lastErrorV[k] = e;
+        integV[k] = integ;
+        velocityV[k] = v;
+        lastVelocityV[k] = v;
+      }
+    }
+
+    // see SimMotor::runVeloctiyController
+    void MotorBatch::runVelocityController() {
+      const size_t n = size();
+      for(size_t k = 0; k < n; ++k) {
+        velocity[k] = controlValue[k];
+      }
+    }
+
+    // see SimMotor::runEffortController
+    void MotorBatch::runEffortController(double time) {
+      const size_t n = size();
+      if(!n) return;
+      const double *minV = minValue.data();
+      const double *maxV = maxValue.data();
+      const double *pV = p.data();
+      const double *iV = i.data();
+      const double *dV = d.data();
+      const double *limitV = effortLimit.data();
+      const double *positionV = position.data();
+      double *valueV = controlValue.data();
+      double *errorV = error.data();
+      double *lastErrorV = lastError.data();
+      double *integV = integError.data();
+      double *effortV = effort.data();
+
+      MOTOR_BATCH_LOOP
+      for(size_t k = 0; k < n; ++k) {
+        double value = std::max(minV[k], std::min(valueV[k], maxV[k]));
+        value = (value > 2*M_PI) ? 0 :
+                (value > M_PI) ? -2*M_PI + value :
+                (value < -2*M_PI) ? 0 :
+                (value < -M_PI) ? 2*M_PI + value : value;
+
+        double e = value - positionV[k];
+        e = (e > M_PI) ? -2*M_PI + e : (e < -M_PI) ? 2*M_PI + e : e;
+        double integ = integV[k] + e * time;
+        double f = e * pV[k];
+        f += integ * iV[k];
+        f += ((e - lastErrorV[k])/time) * dV[k];
+        f = std::max(-limitV[k], std::min(f, limitV[k]));
+
+        valueV[k] = value;
+        errorV[k] = e;
+        lastErrorV[k] = e;
+        integV[k] = integ;
+        effortV[k] = f;
+      }
+    }
+
+    void MotorBatch::limit() {
+      const size_t n = size();
+      if(!n) return;
+      const double *maxSpeedV = maxSpeed.data();
+      const double *maxEffortV = maxEffort.data();
+      double *velocityV = velocity.data();
+      double *effortV = effort.data();
+
+      MOTOR_BATCH_LOOP
+      for(size_t k = 0; k < n; ++k) {
+        velocityV[k] = std::max(-maxSpeedV[k],
+                                std::min(velocityV[k], maxSpeedV[k]));
+        effortV[k] = std::max(-maxEffortV[k],
+                              std::min(effortV[k], maxEffortV[k]));
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
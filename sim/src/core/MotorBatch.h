@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file MotorBatch.h
+ * \brief The controller state of several motors of one type as arrays.
+ */
+
+#ifndef MARS_SIM_MOTOR_BATCH_H
+#define MARS_SIM_MOTOR_BATCH_H
+
+#ifdef _PRINT_HEADER_
+  #warning "MotorBatch.h"
+#endif
+
+#include <cstddef>
+#include <vector>
+
+namespace mars {
+  namespace sim {
+
+    class SimMotor;
+
+    enum MotorBatchType {
+      MOTOR_BATCH_POSITION,
+      MOTOR_BATCH_VELOCITY,
+      MOTOR_BATCH_EFFORT,
+      NUM_MOTOR_BATCHES,
+      MOTOR_BATCH_NONE = NUM_MOTOR_BATCHES ///< updated by SimMotor::update
+    };
+
+    /**
+     * \brief Holds the parameters and the controller state of several
+     *        motors of one type, one array per field.
+     *
+     * Every SimMotor owns one slot of a MotorBatch and its getters and
+     * setters work directly on that slot. While a motor is updated in
+     * batches the slot is part of the batch of its controller type in the
+     * MotorManager, otherwise it is the only slot of a batch of the motor
+     * itself. MotorManager::updateMotors only stores the positions and the
+     * momentary maxima in the batches, runs the controller of each batch
+     * in one loop and then hands the results to the joints. The loops of
+     * the position and velocity controllers and of limit() have no
+     * branches, so the compiler can vectorize them. All loops compute the
+     * same values as the controllers of SimMotor.
+     */
+    class MotorBatch {
+    public:
+      /** \return the index of the new slot, all values are zero */
+      size_t add(SimMotor *motor);
+      /**
+       * \brief removes the slot \a index by moving the last slot into it
+       * \return the motor whose slot moved to \a index or NULL
+       */
+      SimMotor* remove(size_t index);
+      /** \brief copies the values of slot \a from of \a batch to \a index */
+      void copySlot(size_t index, const MotorBatch &batch, size_t from);
+      inline size_t size() const { return motors.size(); }
+
+      void runPositionController(double time);
+      void runVelocityController();
+      void runEffortController(double time);
+      /** \brief caps velocity and effort to the momentary maxima */
+      void limit();
+
+      std::vector<SimMotor*> motors;
+      // parameters
+      std::vector<double> minValue, maxValue;
+      std::vector<double> p, i, d;
+      std::vector<double> filter;
+      std::vector<double> speedLimit;   ///< the anti wind up limit
+      std::vector<double> effortLimit;  ///< the limit of the effort controller
+      // stored by MotorManager::updateMotors before the controllers run
+      std::vector<double> maxSpeed;     ///< the momentary maximum speed
+      std::vector<double> maxEffort;    ///< the momentary maximum effort
+      std::vector<double> position;
+      // state
+      std::vector<double> controlValue;
+      std::vector<double> error, lastError, integError;
+      std::vector<double> velocity, lastVelocity;
+      std::vector<double> effort;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_MOTOR_BATCH_H
@@ -43,6 +43,7 @@
 #include <mars/utils/MutexLocker.h>
 #include <mars/utils/mathUtils.h>
 #include <mars/utils/misc.h>
+#include <mars/utils/Trace.h>
 
 namespace mars {
   namespace sim {
@@ -96,6 +97,7 @@ namespace mars {
       newMotor->setSMotor(*motorS);
       iMutex.lock();
       simMotors[newMotor->getIndex()] = newMotor;
+      motorNames.add(newMotor->getName(), newMotor->getIndex());
       iMutex.unlock();
       control->sim->sceneHasChanged(false);
 
@@ -168,8 +170,11 @@ namespace mars {
     void MotorManager::editMotor(const MotorData &motorS) {
       MutexLocker locker(&iMutex);
       map<unsigned long, SimMotor*>::iterator iter = simMotors.find(motorS.index);
-      if (iter != simMotors.end())
+      if (iter != simMotors.end()) {
+        std::string oldName = iter->second->getName();
         iter->second->setSMotor(motorS);
+        motorNames.rename(oldName, iter->second->getName(), iter->first);
+      }
     }
 
 
@@ -226,8 +231,10 @@ namespace mars {
       if (iter != simMotors.end()) {
         tmpMotor = iter->second;
         simMotors.erase(iter);
-        if (tmpMotor)
+        if (tmpMotor) {
+          motorNames.remove(tmpMotor->getName(), index);
           delete tmpMotor;
+        }
       }
       iMutex.unlock();
 
@@ -273,9 +280,9 @@ namespace mars {
     SimMotor* MotorManager::getSimMotorByName(const std::string &name) const {
       MutexLocker locker(&iMutex);
       std::map<unsigned long, SimMotor*>::const_iterator iter;
-      for (iter = simMotors.begin(); iter != simMotors.end(); iter++)
-        if (iter->second->getName() == name)
-          return iter->second;
+      iter = simMotors.find(motorNames.find(name));
+      if (iter != simMotors.end())
+        return iter->second;
       return NULL;
     }
 
@@ -386,14 +393,8 @@ namespace mars {
      * \return Id of the motor if it exists, otherwise 0
      */
     unsigned long MotorManager::getID(const std::string& name) const {
-      map<unsigned long, SimMotor*>::const_iterator iter;
       MutexLocker locker(&iMutex);
-
-      for (iter = simMotors.begin(); iter != simMotors.end(); iter++) {
-        if (iter->second->getName() == name)
-          return iter->first;
-      }
-      return 0;
+      return motorNames.find(name);
     }
 
 
@@ -431,6 +432,7 @@ namespace mars {
       for(iter = simMotors.begin(); iter != simMotors.end(); iter++)
         delete iter->second;
       simMotors.clear();
+      motorNames.clear();
       mimicmotors.clear();
       if(clear_all) simMotorsReload.clear();
       next_motor_id = 1;
@@ -464,10 +466,39 @@ namespace mars {
      * \param calc_ms The timing value in miliseconds.
      */
     void MotorManager::updateMotors(double calc_ms) {
+      MARS_TRACE_SCOPE("MotorManager::updateMotors");
       map<unsigned long, SimMotor*>::iterator iter;
       MutexLocker locker(&iMutex);
-      for(iter = simMotors.begin(); iter != simMotors.end(); iter++)
-        iter->second->update(calc_ms);
+
+      // the state of the motors already is in the batches, only the
+      // positions and the momentary maxima are stored every step
+      for(iter = simMotors.begin(); iter != simMotors.end(); iter++) {
+        SimMotor *motor = iter->second;
+        MotorBatchType type = motor->getBatchType();
+        motor->setBatch(type == MOTOR_BATCH_NONE ? NULL : &motorBatches[type]);
+        if(type != MOTOR_BATCH_NONE) {
+          motor->prepareBatchStep();
+        }
+      }
+
+      motorBatches[MOTOR_BATCH_POSITION].runPositionController(calc_ms);
+      motorBatches[MOTOR_BATCH_VELOCITY].runVelocityController();
+      motorBatches[MOTOR_BATCH_EFFORT].runEffortController(calc_ms);
+
+      for(int t = 0; t < NUM_MOTOR_BATCHES; ++t) {
+        MotorBatch &batch = motorBatches[t];
+        batch.limit();
+        for(size_t k = 0; k < batch.size(); ++k) {
+          batch.motors[k]->finishBatchStep(calc_ms);
+        }
+      }
+
+      // inactive motors and mimics, which got their control value above
+      for(iter = simMotors.begin(); iter != simMotors.end(); iter++) {
+        if(!iter->second->isBatched()) {
+          iter->second->update(calc_ms);
+        }
+      }
     }
 
 
@@ -42,6 +42,9 @@
 #include <mars/interfaces/sim/MotorManagerInterface.h>
 #include <mars/utils/Mutex.h>
 
+#include "MotorBatch.h"
+#include "NameIndex.h"
+
 namespace mars {
   namespace sim {
 
@@ -324,6 +327,12 @@ namespace mars {
       //! a container for all motors currently present in the simulation
       std::map<unsigned long, SimMotor*> simMotors;
 
+      //! the ids of the motors in simMotors by name
+      NameIndex motorNames;
+
+      //! the parameters and the state of the batched motors by controller type
+      MotorBatch motorBatches[NUM_MOTOR_BATCHES];
+
       //! a containter for all motors that are reloaded after a reset of the simulation
       std::list<interfaces::MotorData> simMotorsReload;
 
@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file NameIndex.h
+ * \brief Maps the names of simulation objects to their ids.
+ */
+
+#ifndef MARS_SIM_NAME_INDEX_H
+#define MARS_SIM_NAME_INDEX_H
+
+#ifdef _PRINT_HEADER_
+  #warning "NameIndex.h"
+#endif
+
+#include <string>
+#include <unordered_map>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief A hash index from names to ids that the managers keep in sync
+     *        with their object maps.
+     *
+     * Names do not have to be unique. For a name that is used several times
+     * find() returns the smallest id, which is the object a scan over the
+     * id ordered maps found first. The index is not locked, the owning
+     * manager guards it with its own mutex.
+     */
+    class NameIndex {
+    public:
+      inline void add(const std::string &name, unsigned long id) {
+        index.insert(Index::value_type(name, id));
+      }
+
+      inline void remove(const std::string &name, unsigned long id) {
+        std::pair<Index::iterator, Index::iterator> range;
+        range = index.equal_range(name);
+        for(Index::iterator it = range.first; it != range.second; ++it) {
+          if(it->second == id) {
+            index.erase(it);
+            return;
+          }
+        }
+      }
+
+      inline void rename(const std::string &oldName,
+                         const std::string &newName, unsigned long id) {
+        if(oldName == newName) return;
+        remove(oldName, id);
+        add(newName, id);
+      }
+
+      /** \return the id of \a name or \c 0 if there is none */
+      inline unsigned long find(const std::string &name) const {
+        std::pair<Index::const_iterator, Index::const_iterator> range;
+        unsigned long id = 0;
+        range = index.equal_range(name);
+        for(Index::const_iterator it = range.first; it != range.second; ++it) {
+          if(!id || it->second < id) id = it->second;
+        }
+        return id;
+      }
+
+      inline void clear() { index.clear(); }
+
+    private:
+      typedef std::unordered_multimap<std::string, unsigned long> Index;
+      Index index;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_NAME_INDEX_H
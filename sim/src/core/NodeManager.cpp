@@ -46,6 +46,7 @@
 #include <stdexcept>
 
 #include <mars/utils/MutexLocker.h>
+#include <mars/utils/Trace.h>
 
 namespace mars {
   namespace sim {
@@ -68,6 +69,8 @@ namespace mars {
                                                  update_all_nodes(false),
                                                  visual_rep(1),
                                                  maxGroupID(0),
+                                                 stateLayoutChanged(true),
+                                                 stateStaticChanged(false),
                                                  control(c),
                                                  libManager(theManager)
     {
@@ -260,6 +263,8 @@ namespace mars {
         simNodes[nodeS->index] = newNode;
         if (nodeS->movable)
           simNodesDyn[nodeS->index] = newNode;
+        nodeNames.add(nodeS->name, nodeS->index);
+        stateLayoutChanged = true;
         iMutex.unlock();
         control->sim->sceneHasChanged(false);
         NodeId id;
@@ -325,6 +330,8 @@ namespace mars {
           if (nodeS->movable) {
             simNodesDyn[nodeS->index] = newNode;
           }
+          nodeNames.add(nodeS->name, nodeS->index);
+          stateLayoutChanged = true;
           iMutex.unlock();
         }
         control->sim->sceneHasChanged(false);
@@ -498,6 +505,7 @@ namespace mars {
           iMutex.lock();
         }
         update_all_nodes = true;
+        stateStaticChanged = true;
       }
       if(changes & EDIT_NODE_ROT) {
         Quaternion q(Quaternion::Identity());
@@ -555,6 +563,7 @@ namespace mars {
           iMutex.lock();
         }
         update_all_nodes = true;
+        stateStaticChanged = true;
       }
       if ((changes & EDIT_NODE_SIZE) || (changes & EDIT_NODE_TYPE) || (changes & EDIT_NODE_CONTACT) ||
           (changes & EDIT_NODE_MASS) || (changes & EDIT_NODE_NAME) ||
@@ -671,6 +680,8 @@ namespace mars {
       if (iter != simNodes.end()) {
         tmpNode = iter->second; //iter->second is a pointer to the SimNode associated with the map
         simNodes.erase(iter);
+        nodeNames.remove(tmpNode->getName(), id);
+        stateLayoutChanged = true;
       }
 
       iter = vizNodes.find(id);
@@ -725,6 +736,69 @@ namespace mars {
         iter->second->getPhysicalState(state);
     }
 
+    bool NodeManager::getNodeStates(const std::vector<NodeId> &ids,
+                                    NodeStates *states) const {
+      bool found = true;
+      states->resize(ids.size());
+      stateLock.lockForRead();
+      for(size_t i = 0; i < ids.size(); ++i) {
+        long index = -1;
+        if(ids[i] < stateIndex.size()) index = stateIndex[ids[i]];
+        if(index < 0) {
+          states->position[i].setZero();
+          states->rotation[i].setIdentity();
+          states->linearVelocity[i].setZero();
+          states->angularVelocity[i].setZero();
+          states->linearAcceleration[i].setZero();
+          states->angularAcceleration[i].setZero();
+          states->force[i].setZero();
+          states->torque[i].setZero();
+          found = false;
+          continue;
+        }
+        states->position[i] = stateStore.position[index];
+        states->rotation[i] = stateStore.rotation[index];
+        states->linearVelocity[i] = stateStore.linearVelocity[index];
+        states->angularVelocity[i] = stateStore.angularVelocity[index];
+        states->linearAcceleration[i] = stateStore.linearAcceleration[index];
+        states->angularAcceleration[i] = stateStore.angularAcceleration[index];
+        states->force[i] = stateStore.force[index];
+        states->torque[i] = stateStore.torque[index];
+      }
+      stateLock.unlock();
+      return found;
+    }
+
+    bool NodeManager::setNodeStates(const std::vector<NodeId> &ids,
+                                    const NodeStates &states,
+                                    unsigned int fields) {
+      bool found = true;
+      MutexLocker locker(&iMutex);
+      stateLock.lockForWrite();
+      for(size_t i = 0; i < ids.size() && i < states.size(); ++i) {
+        NodeMap::iterator iter = simNodes.find(ids[i]);
+        if(iter == simNodes.end()) {
+          found = false;
+          continue;
+        }
+        SimNode *node = iter->second;
+        if(fields & NODE_STATE_POSITION)
+          node->setPosition(states.position[i], false);
+        if(fields & NODE_STATE_ROTATION)
+          node->setRotation(states.rotation[i], false);
+        if(fields & NODE_STATE_LINEAR_VELOCITY)
+          node->setLinearVelocity(states.linearVelocity[i]);
+        if(fields & NODE_STATE_ANGULAR_VELOCITY)
+          node->setAngularVelocity(states.angularVelocity[i]);
+        nodesToUpdate[ids[i]] = node;
+        // readers see the new state before the next step
+        if(!stateLayoutChanged)
+          node->getStates(&stateStore, stateIndex[ids[i]]);
+      }
+      stateLock.unlock();
+      return found;
+    }
+
     /**
      *\brief Return the center of mass for the nodes corresponding to
      * the id's from the given vector.
@@ -754,6 +828,7 @@ namespace mars {
       if (iter != simNodes.end()) {
         iter->second->setPosition(pos, 1);
         nodesToUpdate[id] = iter->second;
+        stateStaticChanged = true;
       }
     }
 
@@ -878,8 +953,10 @@ namespace mars {
       if (iter != simNodes.end()) {
         iter->second->addSensor(sensor);
         NodeMap::iterator kter = simNodesDyn.find(sensor->getAttachedNode());
-        if (kter == simNodesDyn.end())
+        if (kter == simNodesDyn.end()) {
           simNodesDyn[iter->first] = iter->second;
+          stateLayoutChanged = true;
+        }
       }
       else
         {
@@ -1117,6 +1194,7 @@ namespace mars {
                             &gids, &nodes);
       }
       update_all_nodes = true;
+      stateStaticChanged = true;
       updateDynamicNodes(0, false);
     }
 
@@ -1152,6 +1230,7 @@ namespace mars {
       moveNodeRecursive(id, offset, &joints, &gids, &nodes);
 
       update_all_nodes = true;
+      stateStaticChanged = true;
       updateDynamicNodes(0, false);
     }
 
@@ -1267,11 +1346,86 @@ namespace mars {
      *\brief Updates the Node values of dynamical nodes from the physics.
      */
     void NodeManager::updateDynamicNodes(sReal calc_ms, bool physics_thread) {
+      MARS_TRACE_SCOPE("NodeManager::updateDynamicNodes");
       MutexLocker locker(&iMutex);
       NodeMap::iterator iter;
       for(iter = simNodesDyn.begin(); iter != simNodesDyn.end(); iter++) {
         iter->second->update(calc_ms, physics_thread);
       }
+      writeNodeStates();
+      if(control->graphics) {
+        publishPoses();
+      }
+    }
+
+    void NodeManager::writeNodeStates() {
+      NodeMap::iterator iter;
+      bool layoutChanged = stateLayoutChanged;
+      // static nodes only change when they are moved outside of the step
+      bool writeAll = layoutChanged || stateStaticChanged;
+
+      if(layoutChanged) {
+        stateNodes.clear();
+        stateDynEntries.clear();
+        for(iter = simNodes.begin(); iter != simNodes.end(); iter++) {
+          if(simNodesDyn.find(iter->first) != simNodesDyn.end()) {
+            stateDynEntries.push_back(stateNodes.size());
+          }
+          stateNodes.push_back(iter->second);
+        }
+        stateLayoutChanged = false;
+      }
+      stateStaticChanged = false;
+
+      stateLock.lockForWrite();
+      if(layoutChanged) {
+        // the ids are handed out sequentially, so a flat table is small
+        NodeId maxId = simNodes.empty() ? 0 : simNodes.rbegin()->first;
+        stateIndex.assign(maxId + 1, -1);
+        stateStore.resize(stateNodes.size());
+        for(size_t i = 0; i < stateNodes.size(); ++i) {
+          stateIndex[stateNodes[i]->getID()] = i;
+        }
+      }
+      if(writeAll) {
+        for(size_t i = 0; i < stateNodes.size(); ++i) {
+          stateNodes[i]->getStates(&stateStore, i);
+        }
+      } else {
+        for(size_t i = 0; i < stateDynEntries.size(); ++i) {
+          size_t entry = stateDynEntries[i];
+          stateNodes[entry]->getStates(&stateStore, entry);
+        }
+      }
+      stateLock.unlock();
+    }
+
+    void NodeManager::publishPoses() {
+      std::vector<NodePose> &poses = poseSnapshots.getWriteBuffer();
+      NodeMap::iterator iter;
+      size_t i = 0;
+
+      poses.resize(simNodesDyn.size());
+      for(iter = simNodesDyn.begin(); iter != simNodesDyn.end(); iter++, i++) {
+        poses[i].graphicsID = iter->second->getGraphicsID();
+        poses[i].graphicsID2 = iter->second->getGraphicsID2();
+        poses[i].visualPos = iter->second->getVisualPosition();
+        poses[i].visualRot = iter->second->getVisualRotation();
+        poses[i].pos = iter->second->getPosition();
+        poses[i].rot = iter->second->getRotation();
+      }
+      poseSnapshots.publish();
+    }
+
+    void NodeManager::setDrawObjectPoses(SimNode *node) {
+      control->graphics->setDrawObjectPos(node->getGraphicsID(),
+                                          node->getVisualPosition());
+      control->graphics->setDrawObjectRot(node->getGraphicsID(),
+                                          node->getVisualRotation());
+      control->graphics->setDrawObjectPos(node->getGraphicsID2(),
+                                          node->getPosition());
+      control->graphics->setDrawObjectRot(node->getGraphicsID2(),
+                                          node->getRotation());
     }
 
     void NodeManager::preGraphicsUpdate() {
@@ -1279,43 +1433,34 @@ namespace mars {
       if(!control->graphics)
         return;
 
-      iMutex.lock();
+      // the dynamic nodes are updated from the latest physics step
+      if(poseSnapshots.update()) {
+        const std::vector<NodePose> &poses = poseSnapshots.getReadBuffer();
+        std::vector<NodePose>::const_iterator it;
+        for(it = poses.begin(); it != poses.end(); ++it) {
+          control->graphics->setDrawObjectPos(it->graphicsID, it->visualPos);
+          control->graphics->setDrawObjectRot(it->graphicsID, it->visualRot);
+          control->graphics->setDrawObjectPos(it->graphicsID2, it->pos);
+          control->graphics->setDrawObjectRot(it->graphicsID2, it->rot);
+        }
+      }
+
+      // nodes changed outside of the physics step; if a step is running
+      // they are updated with the next frame
+      if(iMutex.tryLock() != MUTEX_ERROR_NO_ERROR)
+        return;
       if(update_all_nodes) {
         update_all_nodes = false;
         for(iter = simNodes.begin(); iter != simNodes.end(); iter++) {
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID(),
-                                              iter->second->getVisualPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID(),
-                                              iter->second->getVisualRotation());
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID2(),
-                                              iter->second->getPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID2(),
-                                              iter->second->getRotation());
+          setDrawObjectPoses(iter->second);
         }
       }
       else {
-        for(iter = simNodesDyn.begin(); iter != simNodesDyn.end(); iter++) {
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID(),
-                                              iter->second->getVisualPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID(),
-                                              iter->second->getVisualRotation());
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID2(),
-                                              iter->second->getPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID2(),
-                                              iter->second->getRotation());
-        }
         for(iter = nodesToUpdate.begin(); iter != nodesToUpdate.end(); iter++) {
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID(),
-                                              iter->second->getVisualPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID(),
-                                              iter->second->getVisualRotation());
-          control->graphics->setDrawObjectPos(iter->second->getGraphicsID2(),
-                                              iter->second->getPosition());
-          control->graphics->setDrawObjectRot(iter->second->getGraphicsID2(),
-                                              iter->second->getRotation());
+          setDrawObjectPoses(iter->second);
         }
-        nodesToUpdate.clear();
       }
+      nodesToUpdate.clear();
       iMutex.unlock();
     }
 
@@ -1332,6 +1477,8 @@ namespace mars {
       simNodes.clear();
       vizNodes.clear();
       simNodesDyn.clear();
+      nodeNames.clear();
+      stateLayoutChanged = true;
       if(clear_all) simNodesReload.clear();
       next_node_id = 1;
       iMutex.unlock();
@@ -1558,17 +1705,8 @@ namespace mars {
     }
 
     NodeId NodeManager::getID(const std::string& node_name) const {
-
-      iMutex.lock();
-      NodeMap::const_iterator iter;
-      for(iter = simNodes.begin(); iter != simNodes.end(); iter++) {
-        if (iter->second->getName() == node_name)  {
-          iMutex.unlock();
-          return iter->first;
-        }
-      }
-      iMutex.unlock();
-      return INVALID_ID;
+      MutexLocker locker(&iMutex);
+      return nodeNames.find(node_name);
     }
 
     std::vector<interfaces::NodeId> NodeManager::getNodeIDs(const std::string& str_in_name) const {
@@ -1589,6 +1727,7 @@ namespace mars {
       NodeMap::iterator iter = nodesToUpdate.find(node->getID());
       if (iter == nodesToUpdate.end())
         nodesToUpdate[node->getID()] = node;
+      stateStaticChanged = true;
     }
 
 
@@ -1664,6 +1803,7 @@ namespace mars {
         iter->second->updatePR(pos, rot, visOffsetPos, visOffsetRot);
         if(doLock) MutexLocker locker(&iMutex);
         nodesToUpdate[id] = iter->second;
+        stateStaticChanged = true;
       }
     }
 
@@ -1900,6 +2040,7 @@ namespace mars {
         control->graphics->setDrawObjectScale(editedNode->getGraphicsID2(), nodeS->ext);
       }
       editedNode->changeNode(nodeS);
+      nodeNames.rename(sNode.name, nodeS->name, editedNode->getID());
       if(sNode.groupID != 0 || nodeS->groupID != 0) {
         for(auto it: simNodes) {
           if(it.second->getGroupID() == sNode.groupID ||
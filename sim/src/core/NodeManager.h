@@ -33,6 +33,10 @@
 #endif
 
 #include <mars/utils/Mutex.h>
+#include <mars/utils/ReadWriteLock.h>
+#include <mars/utils/TripleBuffer.h>
+
+#include "NameIndex.h"
 #include <mars/interfaces/graphics/GraphicsUpdateInterface.h>
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/interfaces/sim/NodeManagerInterface.h>
@@ -45,6 +49,16 @@ namespace mars {
 
     typedef std::map<interfaces::NodeId, SimNode*> NodeMap;
 
+    /**
+     * \brief Pose of a dynamic node at the end of a physics step, used to
+     *        update the graphics without the locks of the simulation.
+     */
+    struct NodePose {
+      unsigned long graphicsID, graphicsID2;
+      utils::Vector visualPos, pos;
+      utils::Quaternion visualRot, rot;
+    };
+
     /**
      * The declaration of the NodeManager class.
      *
@@ -83,6 +97,11 @@ namespace mars {
       virtual void removeNode(interfaces::NodeId id, bool clearGraphics=true);
       virtual void setNodeState(interfaces::NodeId id, const interfaces::nodeState &state);
       virtual void getNodeState(interfaces::NodeId id, interfaces::nodeState *state) const;
+      virtual bool getNodeStates(const std::vector<interfaces::NodeId> &ids,
+                                 interfaces::NodeStates *states) const;
+      virtual bool setNodeStates(const std::vector<interfaces::NodeId> &ids,
+                                 const interfaces::NodeStates &states,
+                                 unsigned int fields=interfaces::NODE_STATE_ALL);
       virtual const utils::Vector getCenterOfMass(const std::vector<interfaces::NodeId> &ids) const;
       virtual void setPosition(interfaces::NodeId id, const utils::Vector &pos);
       virtual const utils::Vector getPosition(interfaces::NodeId id) const;
@@ -169,14 +188,29 @@ namespace mars {
       NodeMap simNodesDyn;
       NodeMap nodesToUpdate;
       NodeMap vizNodes;
+      NameIndex nodeNames; // of simNodes
       std::list<interfaces::NodeData> simNodesReload;
       unsigned long maxGroupID;
       lib_manager::LibManager *libManager;
       mutable utils::Mutex iMutex;
+      // written by updateDynamicNodes under iMutex, read by the gui thread
+      utils::TripleBuffer<std::vector<NodePose> > poseSnapshots;
+      // the states of all nodes, written by writeNodeStates; the dynamic
+      // nodes every step, the static ones only after they changed
+      mutable utils::ReadWriteLock stateLock;
+      interfaces::NodeStates stateStore;
+      std::vector<long> stateIndex; // NodeId -> entry in stateStore or -1
+      std::vector<SimNode*> stateNodes; // entry -> node, guarded by iMutex
+      std::vector<size_t> stateDynEntries; // entries of simNodesDyn
+      bool stateLayoutChanged;
+      bool stateStaticChanged; // a node was moved outside of the step
 
       interfaces::ControlCenter *control;
 
       std::list<interfaces::NodeData>::iterator getReloadNode(interfaces::NodeId id);
+      void publishPoses();
+      void writeNodeStates();
+      void setDrawObjectPoses(SimNode *node);
 
       // interfaces::NodeInterface* getNodeInterface(NodeId node_id);
       struct Params; // see below.
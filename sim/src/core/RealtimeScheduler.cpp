@@ -0,0 +1,191 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RealtimeScheduler.h"
+
+#include <mars/utils/misc.h>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __linux__
+#include <time.h>
+#include <errno.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace mars {
+  namespace sim {
+
+    /// \cond HIDDEN_SYMBOLS
+    // lag after which REALTIME_CATCH_UP gives up and restarts the schedule
+    static const int64_t MAX_LAG_NS = 1000000000;
+
+    static void sleepUntil(int64_t deadline) {
+#ifdef __linux__
+      // utils::getTimeNs() is CLOCK_MONOTONIC
+      struct timespec ts;
+      ts.tv_sec = deadline / 1000000000;
+      ts.tv_nsec = deadline % 1000000000;
+      while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR);
+#else
+      int64_t duration = deadline - utils::getTimeNs();
+      if(duration > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(duration));
+      }
+#endif
+    }
+
+    static double percentile(std::vector<int64_t> &values, double p) {
+      if(values.empty()) return 0.;
+      size_t n = (size_t)(p * (values.size() - 1) + 0.5);
+      std::nth_element(values.begin(), values.begin() + n, values.end());
+      return values[n];
+    }
+    /// \endcond
+
+    RealtimeScheduler::RealtimeScheduler()
+      : realTimeFactor(1.), policy(REALTIME_CATCH_UP), needsReset(true),
+        periodNs(0.), anchorNs(0), slot(0), windowStartNs(0),
+        windowSteps(0), windowSimMs(0.), overruns(0), skipped(0) {
+    }
+
+    void RealtimeScheduler::setRealTimeFactor(double factor) {
+      mutex.lock();
+      realTimeFactor = factor;
+      mutex.unlock();
+    }
+
+    double RealtimeScheduler::getRealTimeFactor() const {
+      mutex.lock();
+      double factor = realTimeFactor;
+      mutex.unlock();
+      return factor;
+    }
+
+    void RealtimeScheduler::setOverrunPolicy(RealtimeOverrunPolicy policy) {
+      mutex.lock();
+      this->policy = policy;
+      mutex.unlock();
+    }
+
+    RealtimeOverrunPolicy RealtimeScheduler::getOverrunPolicy() const {
+      mutex.lock();
+      RealtimeOverrunPolicy p = policy;
+      mutex.unlock();
+      return p;
+    }
+
+    void RealtimeScheduler::reset() {
+      mutex.lock();
+      needsReset = true;
+      mutex.unlock();
+    }
+
+    void RealtimeScheduler::restart(int64_t anchor) {
+      anchorNs = anchor;
+      slot = 0;
+    }
+
+    void RealtimeScheduler::waitForNextStep(double stepMs) {
+      mutex.lock();
+      int64_t now = utils::getTimeNs();
+      if(needsReset) {
+        // the time of a pause is neither scheduled nor measured
+        needsReset = false;
+        restart(now);
+        windowStartNs = now;
+        windowSteps = 0;
+        windowSimMs = 0.;
+        jitterNs.clear();
+      }
+
+      double period = realTimeFactor > 0. ? stepMs * 1e6 / realTimeFactor : 0.;
+      if(period != periodNs) {
+        // keep the phase of the last deadline
+        restart(periodNs > 0. ? anchorNs + llround(slot * periodNs) : now);
+        periodNs = period;
+      }
+      windowSteps++;
+      windowSimMs += stepMs;
+      if(periodNs <= 0.) {
+        mutex.unlock();
+        return;
+      }
+
+      int64_t deadline = anchorNs + llround(++slot * periodNs);
+      RealtimeOverrunPolicy p = policy;
+      mutex.unlock();
+
+      int64_t wake = now;
+      if(now < deadline) {
+        sleepUntil(deadline);
+        wake = utils::getTimeNs();
+      }
+
+      mutex.lock();
+      jitterNs.push_back(wake - deadline);
+      if(now > deadline) {
+        int64_t lag = now - deadline;
+        overruns++;
+        if(p == REALTIME_SKIP || lag > MAX_LAG_NS) {
+          skipped += (unsigned long)(lag / periodNs);
+          restart(now);
+        }
+      }
+      mutex.unlock();
+    }
+
+    size_t RealtimeScheduler::getNumSamples() const {
+      mutex.lock();
+      size_t n = windowSteps;
+      mutex.unlock();
+      return n;
+    }
+
+    RealtimeStatistics RealtimeScheduler::takeStatistics() {
+      RealtimeStatistics statistics;
+      std::vector<int64_t> jitter;
+
+      mutex.lock();
+      int64_t now = utils::getTimeNs();
+      double wallMs = (now - windowStartNs) * 1e-6;
+      statistics.realTimeFactor = wallMs > 0. ? windowSimMs / wallMs : 0.;
+      statistics.stepInterval = windowSteps ? wallMs / windowSteps : 0.;
+      statistics.overruns = overruns;
+      statistics.skipped = skipped;
+      jitter.swap(jitterNs);
+      windowStartNs = now;
+      windowSteps = 0;
+      windowSimMs = 0.;
+      overruns = skipped = 0;
+      mutex.unlock();
+
+      statistics.jitterP50 = percentile(jitter, 0.5) * 1e-3;
+      statistics.jitterP99 = percentile(jitter, 0.99) * 1e-3;
+      statistics.jitterMax = jitter.empty() ? 0. :
+        *std::max_element(jitter.begin(), jitter.end()) * 1e-3;
+      return statistics;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file RealtimeScheduler.h
+ * \brief Paces the physics steps against the wall clock.
+ */
+
+#ifndef MARS_SIM_REALTIME_SCHEDULER_H
+#define MARS_SIM_REALTIME_SCHEDULER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RealtimeScheduler.h"
+#endif
+
+#include <mars/utils/Mutex.h>
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace mars {
+  namespace sim {
+
+    enum RealtimeOverrunPolicy {
+      /** late steps run without sleeping until the schedule is met again */
+      REALTIME_CATCH_UP,
+      /** the schedule restarts at the late step, missed slots are dropped */
+      REALTIME_SKIP
+    };
+
+    /**
+     * \brief Statistics of the steps since the last
+     *        RealtimeScheduler::takeStatistics() call
+     */
+    struct RealtimeStatistics {
+      double realTimeFactor;  ///< achieved simulation time per wall time
+      double stepInterval;    ///< average wall time between steps in ms
+      double jitterP50;       ///< median wake-up delay in us
+      double jitterP99;       ///< 99th percentile wake-up delay in us
+      double jitterMax;       ///< maximal wake-up delay in us
+      unsigned long overruns; ///< steps that started after their deadline
+      unsigned long skipped;  ///< schedule slots dropped
+    };
+
+    /**
+     * \brief Schedules the physics steps at absolute deadlines.
+     *
+     * The deadline of step \c n is computed from the start of the schedule
+     * as \c n times the step period in nanoseconds, so sub-millisecond step
+     * sizes are kept exactly and rounding errors do not accumulate. The
+     * step period is the step size divided by the real-time factor. A
+     * factor less than or equal to zero runs the steps as fast as possible.
+     *
+     * Changing the step size or the real-time factor restarts the schedule
+     * at the current deadline. With REALTIME_CATCH_UP a schedule that lags
+     * more than one second behind is restarted as well.
+     *
+     * The setters may be called from any thread, waitForNextStep() and
+     * takeStatistics() are called by the physics thread.
+     */
+    class RealtimeScheduler {
+    public:
+      RealtimeScheduler();
+
+      void setRealTimeFactor(double factor);
+      double getRealTimeFactor() const;
+      void setOverrunPolicy(RealtimeOverrunPolicy policy);
+      RealtimeOverrunPolicy getOverrunPolicy() const;
+
+      /** \brief restarts the schedule, e.g. after a pause */
+      void reset();
+
+      /**
+       * \brief Blocks until the next step of the size \a stepMs is due.
+       */
+      void waitForNextStep(double stepMs);
+
+      /** \brief returns the number of steps since the last takeStatistics() */
+      size_t getNumSamples() const;
+
+      /** \brief returns the statistics of the recent steps and clears them */
+      RealtimeStatistics takeStatistics();
+
+    private:
+      void restart(int64_t anchor);
+
+      mutable utils::Mutex mutex;
+      double realTimeFactor;
+      RealtimeOverrunPolicy policy;
+      bool needsReset;
+
+      // schedule
+      double periodNs;
+      int64_t anchorNs;
+      uint64_t slot;
+
+      // statistics
+      std::vector<int64_t> jitterNs;
+      int64_t windowStartNs;
+      size_t windowSteps;
+      double windowSimMs;
+      unsigned long overruns, skipped;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_REALTIME_SCHEDULER_H
@@ -185,11 +185,9 @@ namespace mars {
 
     unsigned long SensorManager::getSensorID(std::string name) const {
       MutexLocker locker(&iMutex);
-      std::map<unsigned long, BaseSensor*>::const_iterator it;
-      for(it = simSensors.begin(); it != simSensors.end(); it++){
-        if(it->second->name.compare(name) == 0){
-          return it->first;
-        }
+      unsigned long id = sensorNames.find(name);
+      if(id) {
+        return id;
       }
       printf("Cannot find Sensor with name: \"%s\"\n",name.c_str());
       return 0;
@@ -207,8 +205,10 @@ namespace mars {
       if (iter != simSensors.end()) {
         tmpSensor = iter->second;
         simSensors.erase(iter);
-        if (tmpSensor)
+        if (tmpSensor) {
+          sensorNames.remove(tmpSensor->name, index);
           delete tmpSensor;
+        }
       }
       iMutex.unlock();
 
@@ -282,6 +282,7 @@ namespace mars {
         delete sensor;
       }
       simSensors.clear();
+      sensorNames.clear();
       if(clear_all) simSensorsReload.clear();
       next_sensor_id = 1;
     }
@@ -339,6 +340,7 @@ namespace mars {
       BaseSensor *sensor = ((*it).second)(this->control,config);
       iMutex.lock();
       simSensors[id] = sensor;
+      if(sensor) sensorNames.add(sensor->name, id);
       iMutex.unlock();
 
       if(!reload) {
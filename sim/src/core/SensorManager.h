@@ -41,6 +41,8 @@
 #include <mars/interfaces/sim/SensorManagerInterface.h>
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/utils/Mutex.h>
+
+#include "NameIndex.h"
 #include <configmaps/ConfigData.h>
 
 namespace mars {
@@ -224,6 +226,9 @@ namespace mars {
       //! a containter for all sensors currently present in the simulation
       std::map<unsigned long, interfaces::BaseSensor*> simSensors;
 
+      //! the ids of the sensors in simSensors by name
+      NameIndex sensorNames;
+
       //! a containter for all sensors that are loaded after a reset of the simulation
       std::vector<SensorReloadHelper> simSensorsReload;
 
@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <cstdio>
+#include <algorithm>
 
 namespace mars {
   namespace sim {
@@ -41,6 +42,10 @@ namespace mars {
       : control(c) {
 
       physical_joint = 0;
+      dbPushId = 0;
+      feedbackRequests = 0;
+      // the physical joint starts with its feedback attached
+      feedbackEnabled = true;
       setSJoint(sJoint_);
 
       pushToDataBroker = 2;
@@ -51,6 +56,11 @@ namespace mars {
       else if(map.hasKey("reducedDataPackage") && (bool)map["reducedDataPackage"] == true) {
         pushToDataBroker = 1;
       }
+      // see SimNode::SimNode
+      dataPackagePeriod = 0;
+      if(map.hasKey("dataPackagePeriod")) {
+        dataPackagePeriod = std::max(0, (int)map["dataPackagePeriod"]);
+      }
       if(pushToDataBroker > 0) {
         setupDataPackageMapping();
         data_broker::DataPackage dbPackage;
@@ -58,11 +68,12 @@ namespace mars {
         std::string groupName, dataName;
         getDataBrokerNames(&groupName, &dataName);
         if(control->dataBroker) {
-          control->dataBroker->pushData(groupName, dataName,
-                                        dbPackage, NULL,
-                                        data_broker::DATA_PACKAGE_READ_FLAG);
+          dbPushId = control->dataBroker->pushData(groupName, dataName,
+                                                   dbPackage, NULL,
+                                                   data_broker::DATA_PACKAGE_READ_FLAG);
           control->dataBroker->registerTimedProducer(this, groupName, dataName,
-                                                     "mars_sim/simTimer", 0);
+                                                     "mars_sim/simTimer",
+                                                     dataPackagePeriod, 0, true);
         }
       }
     }
@@ -211,6 +222,10 @@ namespace mars {
       return sJoint.index;
     }
 
+    const std::string SimJoint::getName() const {
+      return sJoint.name;
+    }
+
     sReal SimJoint::getPosition(unsigned char axis_index) const {
         return axis_index == 1 ? position1 : position2;
       }
@@ -233,17 +248,20 @@ namespace mars {
         physical_joint->getAnchor(&anchor);
         physical_joint->getAxis(&axis1);
         physical_joint->getAxis2(&axis2);
-        physical_joint->getForce1(&f1);
-        physical_joint->getForce2(&f2);
-        physical_joint->getTorque1(&t1);
-        physical_joint->getTorque2(&t2);
-        physical_joint->update();
-        physical_joint->getAxisTorque(&axis1_torque);
-        physical_joint->getAxis2Torque(&axis2_torque);
-        physical_joint->getJointLoad(&joint_load);
-        axis1_torque *= invert;
-        axis2_torque *= invert;
-        joint_load *= invert;
+        if(feedbackEnabled) {
+          physical_joint->getForce1(&f1);
+          physical_joint->getForce2(&f2);
+          physical_joint->getTorque1(&t1);
+          physical_joint->getTorque2(&t2);
+          physical_joint->update();
+          physical_joint->getAxisTorque(&axis1_torque);
+          physical_joint->getAxis2Torque(&axis2_torque);
+          physical_joint->getJointLoad(&joint_load);
+          axis1_torque *= invert;
+          axis2_torque *= invert;
+          joint_load *= invert;
+          motor_torque = invert*physical_joint->getMotorTorque();
+        }
         velocity1 = invert*physical_joint->getVelocity();
         velocity2 = invert*physical_joint->getVelocity2();
         if(sJoint.type == JOINT_TYPE_SLIDER) {
@@ -261,7 +279,39 @@ namespace mars {
           else error = fmod(position2, M_PI) - fmod(ode_position2-M_PI, M_PI);
           if(fabs(error) < 0.1) position2 -= error;
         }
-        motor_torque = invert*physical_joint->getMotorTorque();
+        updateFeedback();
+      }
+    }
+
+    void SimJoint::requestFeedback(void) {
+      ++feedbackRequests;
+    }
+
+    void SimJoint::releaseFeedback(void) {
+      --feedbackRequests;
+    }
+
+    /**
+     * The feedback costs the solver time for every joint, so it is only
+     * attached while someone reads the results. A change takes effect in
+     * the next step.
+     */
+    void SimJoint::updateFeedback(void) {
+      bool needed = (feedbackRequests.load() > 0 ||
+                     (dbPushId && control->dataBroker &&
+                      control->dataBroker->hasReceivers(dbPushId)));
+      if(needed == feedbackEnabled) return;
+      physical_joint->setFeedbackEnabled(needed);
+      feedbackEnabled = needed;
+      if(!needed) {
+        f1.setZero();
+        f2.setZero();
+        t1.setZero();
+        t2.setZero();
+        axis1_torque.setZero();
+        axis2_torque.setZero();
+        joint_load.setZero();
+        motor_torque = 0;
       }
     }
 
@@ -303,6 +353,42 @@ namespace mars {
       }
     }
 
+    void SimJoint::getCheckpointState(CheckpointJointState *state) const {
+      const utils::Vector *vectors[7] = {&f1, &f2, &t1, &t2, &axis1_torque,
+                                         &axis2_torque, &joint_load};
+      double *targets[7] = {state->force[0], state->force[1],
+                            state->torque[0], state->torque[1],
+                            state->axisTorque[0], state->axisTorque[1],
+                            state->jointLoad};
+      state->id = id;
+      // the hinge positions are integrated over the turns of the joint
+      state->position[0] = position1;
+      state->position[1] = position2;
+      state->velocity[0] = velocity1;
+      state->velocity[1] = velocity2;
+      for(int i = 0; i < 7; ++i) {
+        for(int k = 0; k < 3; ++k) targets[i][k] = (*vectors[i])[k];
+      }
+      state->motorTorque = motor_torque;
+    }
+
+    void SimJoint::setCheckpointState(const CheckpointJointState &state) {
+      utils::Vector *vectors[7] = {&f1, &f2, &t1, &t2, &axis1_torque,
+                                   &axis2_torque, &joint_load};
+      const double *sources[7] = {state.force[0], state.force[1],
+                                  state.torque[0], state.torque[1],
+                                  state.axisTorque[0], state.axisTorque[1],
+                                  state.jointLoad};
+      position1 = state.position[0];
+      position2 = state.position[1];
+      velocity1 = state.velocity[0];
+      velocity2 = state.velocity[1];
+      for(int i = 0; i < 7; ++i) {
+        for(int k = 0; k < 3; ++k) (*vectors[i])[k] = sources[i][k];
+      }
+      motor_torque = state.motorTorque;
+    }
+
     const JointData SimJoint::getSJoint(void) const {
       JointData tmp = sJoint;
 
@@ -25,11 +25,15 @@
 #warning "SimJoint.h"
 #endif
 
+#include "CheckpointFormat.h"
+
 #include <mars/interfaces/sim/JointInterface.h>
 
 #include <mars/data_broker/ProducerInterface.h>
 #include <mars/data_broker/DataPackageMapping.h>
 
+#include <atomic>
+
 namespace mars {
   
   namespace interfaces {
@@ -56,6 +60,8 @@ namespace mars {
      * Each SimJoint object publishes its state on the dataBroker.
      * The name under which the data is published can be obtained from the 
      * jointId via JointManager::getDataBrokerNames.
+     * The package is only updated while it has receivers, a reader that
+     * polls getDataPackage has to register one.
      * The data_broker::DataPackage will contain the following items:
      *  - "id" (int)
      *  - "axis1/x" (double)
@@ -95,6 +101,11 @@ namespace mars {
      *  - "jointLoad/y" (double)
      *  - "jointLoad/z" (double)
      *  - "motorTorque" (double)
+     *
+     * The forces, torques, the joint load and the motor torque are only
+     * calculated by the physics while the DataPackage has receivers or
+     * while the feedback is requested with requestFeedback(). Otherwise
+     * they are zero.
      */
     class SimJoint : public data_broker::ProducerInterface {
     public:
@@ -110,6 +121,10 @@ namespace mars {
       void attachMotor(unsigned char axis_index);
       void detachMotor(unsigned char axis_index);
       void updateStepSize(void);
+      /** \brief keeps the forces and loads of the joint calculated until
+       *         the request is released with releaseFeedback() */
+      void requestFeedback(void);
+      void releaseFeedback(void);
 
       // getters
       const utils::Vector getAnchor(void) const;
@@ -119,6 +134,7 @@ namespace mars {
       interfaces::sReal getPosition(unsigned char axis_index=1) const;
       const utils::Vector getForceVector(unsigned char axis_index=1) const;
       unsigned long getIndex(void) const;
+      const std::string getName(void) const;
       interfaces::JointType getJointType(void) const;
       const utils::Vector getJointLoad(void) const;
       interfaces::sReal getLowerLimit(unsigned char axis_index=1) const;
@@ -147,6 +163,11 @@ namespace mars {
       void setLowerLimit(interfaces::sReal limit, unsigned char axis_index=1);
       void setUpperLimit(interfaces::sReal limit, unsigned char axis_index=1);
       void setInvertAxis(bool v);
+
+      // checkpoints
+      void getCheckpointState(CheckpointJointState *state) const;
+      void setCheckpointState(const CheckpointJointState &state);
+
       // inherited from DataBroker ProducerInterface
       void getDataBrokerNames(std::string *groupName, std::string *dataName) const;
       virtual void produceData(const data_broker::DataInfo &info,
@@ -210,6 +231,12 @@ namespace mars {
       utils::Vector axis1InNode1;
       utils::Vector node1ToAnchor;
       int pushToDataBroker;
+      long dataPackagePeriod; ///< in sim timer steps, 0 for every step
+      unsigned long dbPushId;
+      std::atomic<int> feedbackRequests;
+      bool feedbackEnabled;
+
+      void updateFeedback(void);
 
       // for dataBroker communication
       void setupDataPackageMapping();
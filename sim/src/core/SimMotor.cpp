@@ -24,6 +24,7 @@
 #include <mars/data_broker/DataBrokerInterface.h>
 
 #include <cstdio>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 
@@ -43,6 +44,9 @@ namespace mars {
     SimMotor::SimMotor(ControlCenter *c, const MotorData &sMotor_)
       : control(c) {
 
+      batch = &ownBatch;
+      batchIndex = ownBatch.add(this);
+
       sMotor.index = sMotor_.index;
       sMotor.type = sMotor_.type;
       sMotor.value = sMotor_.value;
@@ -57,11 +61,11 @@ namespace mars {
       position1 = 0;
       position2 = 0;
       position = &position1;
-      lastVelocity = velocity=0;
+      lastVelocity() = velocity()=0;
       joint_velocity = 0;
       time = 10;
       current = 0;
-      effort = 0;
+      effort() = 0;
       tmpmaxeffort = 0;
       tmpmaxspeed = 0;
       myJoint = 0;
@@ -84,9 +88,11 @@ namespace mars {
       p=0;
       i=0;
       d=0;
-      last_error = 0;
-      integ_error = 0;
-      controlValue = 0;
+      filterValue = 0;
+      lastError() = 0;
+      integError() = 0;
+      controlValue() = 0;
+      setBatchParameters();
       updateController();
 
       initTemperatureEstimation();
@@ -100,7 +106,7 @@ namespace mars {
       if(pushToDataBroker > 0) {
         cmdPackage.add("value", 0.0);
         dbPackage.add("id", (long)sMotor.index);
-        dbPackage.add("value", controlValue);
+        dbPackage.add("value", controlValue());
         dbPackage.add("position", getPosition());
         dbPackage.add("current", getCurrent());
         dbPackage.add("torque", getEffort());
@@ -139,10 +145,12 @@ namespace mars {
         }
         control->dataBroker->unregisterSyncReceiver(this, "*", "*");
       }
+      setBatch(NULL);
       // if we have to delete something we can do it here
       if(myJoint) {
         myJoint->setEffortLimit(0, sMotor.axis);
         myJoint->detachMotor(sMotor.axis);
+        myJoint->releaseFeedback();
       }
 
       // delete any coefficient vectors we might have created
@@ -170,6 +178,45 @@ namespace mars {
       mimic_offset = offset;
     }
 
+    void SimMotor::getCheckpointState(CheckpointMotorState *state) const {
+      memset(state, 0, sizeof(*state));
+      state->id = sMotor.index;
+      state->time = time;
+      state->controlValue = controlValue();
+      state->lastVelocity = lastVelocity();
+      state->velocity = velocity();
+      state->effort = effort();
+      state->current = current;
+      state->temperature = temperature;
+      state->filterValue = filterValue;
+      state->lastError = lastError();
+      state->integError = integError();
+      state->error = error();
+      state->jointVelocity = joint_velocity;
+      state->tmpMaxEffort = tmpmaxeffort;
+      state->tmpMaxSpeed = tmpmaxspeed;
+      state->active = active;
+    }
+
+    void SimMotor::setCheckpointState(const CheckpointMotorState &state) {
+      time = state.time;
+      controlValue() = state.controlValue;
+      lastVelocity() = state.lastVelocity;
+      velocity() = state.velocity;
+      effort() = state.effort;
+      current = state.current;
+      temperature = state.temperature;
+      filterValue = state.filterValue;
+      lastError() = state.lastError;
+      integError() = state.integError;
+      error() = state.error;
+      joint_velocity = state.jointVelocity;
+      tmpmaxeffort = state.tmpMaxEffort;
+      tmpmaxspeed = state.tmpMaxSpeed;
+      active = state.active != 0;
+      setBatchParameters();
+    }
+
     void SimMotor::setMaxEffortApproximation(utils::ApproximationFunction type,
       std::vector<double>* coefficients) {
       switch (type) {
@@ -234,35 +281,35 @@ namespace mars {
       switch (sMotor.type) {
         case MOTOR_TYPE_POSITION:
         case MOTOR_TYPE_PID: // deprecated
-          controlParameter = &velocity;
-          controlValue = sMotor.value;
+          controlValue() = sMotor.value;
           controlLimit = &(sMotor.maxSpeed);
           setJointControlParameter = &SimJoint::setVelocity;
           runController = &SimMotor::runPositionController;
+          batchType = MOTOR_BATCH_POSITION;
           break;
         case MOTOR_TYPE_VELOCITY:
         case MOTOR_TYPE_DC: //deprecated
-          controlParameter = &velocity;
-          controlValue = sMotor.value;
+          controlValue() = sMotor.value;
           controlLimit = &(sMotor.maxAcceleration); // this is a stand-in for acceleration
           setJointControlParameter = &SimJoint::setVelocity;
           runController = &SimMotor::runVeloctiyController;
+          batchType = MOTOR_BATCH_VELOCITY;
           break;
         case MOTOR_TYPE_PID_FORCE: // deprecated
         case MOTOR_TYPE_EFFORT:
-          controlParameter = &effort;
-          controlValue = sMotor.value;
+          controlValue() = sMotor.value;
           controlLimit = &(sMotor.maxEffort);
           setJointControlParameter = &SimJoint::setEffort;
           runController = &SimMotor::runEffortController;
+          batchType = MOTOR_BATCH_EFFORT;
           break;
         case MOTOR_TYPE_UNDEFINED:
           // TODO: output error
-          controlParameter = &velocity; // default to position
-          controlValue = sMotor.value;
+          controlValue() = sMotor.value;
           controlLimit = &(sMotor.maxSpeed);
           setJointControlParameter = &SimJoint::setVelocity;
           runController = &SimMotor::runPositionController;
+          batchType = MOTOR_BATCH_POSITION;
           break;
       }
       //TODO: update the remaining parameters
@@ -270,50 +317,50 @@ namespace mars {
 
     void SimMotor::runEffortController(sReal time) {
       // limit to range of motion
-      controlValue = std::max(sMotor.minValue,
-        std::min(controlValue, sMotor.maxValue));
-
-      if(controlValue > 2*M_PI)
-        controlValue = 0;
-      else if(controlValue > M_PI)
-        controlValue = -2*M_PI + controlValue;
-      else if(controlValue < -2*M_PI)
-        controlValue = 0;
-      else if(controlValue < -M_PI)
-        controlValue = 2*M_PI + controlValue;
-
-      error = controlValue - *position;
-      if(error > M_PI) error = -2*M_PI + error;
-      else if(error < -M_PI) error = 2*M_PI + error;
-      integ_error += error * time;
+      controlValue() = std::max(sMotor.minValue,
+        std::min(controlValue(), sMotor.maxValue));
+
+      if(controlValue() > 2*M_PI)
+        controlValue() = 0;
+      else if(controlValue() > M_PI)
+        controlValue() = -2*M_PI + controlValue();
+      else if(controlValue() < -2*M_PI)
+        controlValue() = 0;
+      else if(controlValue() < -M_PI)
+        controlValue() = 2*M_PI + controlValue();
+
+      error() = controlValue() - *position;
+      if(error() > M_PI) error() = -2*M_PI + error();
+      else if(error() < -M_PI) error() = 2*M_PI + error();
+      integError() += error() * time;
       // P part of the motor
-      effort = error * sMotor.p;
+      effort() = error() * sMotor.p;
       // I part of the motor
-      effort += integ_error * sMotor.i;
+      effort() += integError() * sMotor.i;
       // D part of the motor
-      effort += ((error - last_error)/time) * sMotor.d;
-      last_error = error;
-      effort = std::max(-sMotor.maxEffort, std::min(effort, sMotor.maxEffort));
+      effort() += ((error() - lastError())/time) * sMotor.d;
+      lastError() = error();
+      effort() = std::max(-sMotor.maxEffort, std::min(effort(), sMotor.maxEffort));
     }
 
     void SimMotor::runVeloctiyController(sReal time) {
-      *controlParameter = controlValue;
+      controlParameter() = controlValue();
     }
 
     void SimMotor::runPositionController(sReal time) {
       // the following implements a simple PID controller using the value
       // pointed to by controlParameter
 
-      controlValue = mimic_multiplier * controlValue + mimic_offset;
+      controlValue() = mimic_multiplier * controlValue() + mimic_offset;
 
       // limit to range of motion
-      controlValue = std::max(sMotor.minValue,
-        std::min(controlValue, sMotor.maxValue));
+      controlValue() = std::max(sMotor.minValue,
+        std::min(controlValue(), sMotor.maxValue));
 
       // calculate control values
-      error = controlValue - *position;
-      if (std::abs(error) < 0.000001)
-        error = 0.0;
+      error() = controlValue() - *position;
+      if (std::abs(error()) < 0.000001)
+        error() = 0.0;
 
       // FIXME: not sure if this makes sense, because it forbids turning
       //        motors in the same direction for multiple revolutions
@@ -325,37 +372,37 @@ namespace mars {
       //if(er < -M_PI)
       //  er = 2*M_PI+er;
 
-      integ_error += error*time;
+      integError() += error()*time;
 
       //anti wind up, this code limits the integral error
       //part of the pid to the maximum velocity. This makes
       //the pid react way faster. This also eleminates the
       //overshooting errors seen before in the simulation
-      double iPart = integ_error * sMotor.i;
+      double iPart = integError() * sMotor.i;
       if(iPart > sMotor.maxSpeed)
       {
         iPart = sMotor.maxSpeed;
-        integ_error = sMotor.maxSpeed / sMotor.i;
+        integError() = sMotor.maxSpeed / sMotor.i;
       }
 
       if(iPart < -sMotor.maxSpeed)
       {
         iPart = -sMotor.maxSpeed;
-        integ_error = -sMotor.maxSpeed / sMotor.i;
+        integError() = -sMotor.maxSpeed / sMotor.i;
       }
 
       // set desired velocity. @todo add inertia
-      velocity = 0; // by setting a different value we could specify a minimum
+      velocity() = 0; // by setting a different value we could specify a minimum
       // P part of the motor
-      velocity += error * sMotor.p;
+      velocity() += error() * sMotor.p;
       // I part of the motor
-      velocity += iPart;
+      velocity() += iPart;
       // D part of the motor
-      velocity += ((error - last_error)/time) * sMotor.d;
+      velocity() += ((error() - lastError())/time) * sMotor.d;
       // apply filter
-      velocity = lastVelocity*(filterValue) + velocity*(1-filterValue);
-      lastVelocity = velocity;
-      last_error = error;
+      velocity() = lastVelocity()*(filterValue) + velocity()*(1-filterValue);
+      lastVelocity() = velocity();
+      lastError() = error();
     }
 
     void SimMotor::update(sReal time_ms) {
@@ -377,15 +424,15 @@ namespace mars {
 
         // cap speed
         tmpmaxspeed = getMomentaryMaxSpeed();
-        velocity = std::max(-tmpmaxspeed, std::min(velocity, tmpmaxspeed));
+        velocity() = std::max(-tmpmaxspeed, std::min(velocity(), tmpmaxspeed));
         // cap effort
         tmpmaxeffort = getMomentaryMaxEffort();
-        effort = std::max(-tmpmaxeffort, std::min(effort, tmpmaxeffort));
+        effort() = std::max(-tmpmaxeffort, std::min(effort(), tmpmaxeffort));
         myJoint->setEffortLimit(tmpmaxeffort, axis);
 
         for(std::map<std::string, SimMotor*>::iterator it = mimics.begin();
           it != mimics.end(); ++it) {
-            it->second->setControlValue(controlValue);
+            it->second->setControlValue(controlValue());
             //it->second->setControlValue(*position);
           }
 
@@ -396,17 +443,83 @@ namespace mars {
 
         // pass speed (position/speed control) or torque to the attached
         // joint's setSpeed1/2 or setTorque1/2 methods
-        (myJoint->*setJointControlParameter)(*controlParameter, axis);
+        (myJoint->*setJointControlParameter)(controlParameter(), axis);
         //for mimic in myJoint->mimics:
         //  mimic->*setJointControlParameter)(mimic_multiplier*controlParameter, axis);
       }
     }
 
+    MotorBatchType SimMotor::getBatchType() const {
+      // mimics get their control value from the batched update of their
+      // parent motor
+      if(!myJoint || !active || mimic) return MOTOR_BATCH_NONE;
+      return batchType;
+    }
+
+    void SimMotor::setBatch(MotorBatch *target) {
+      if(!target) target = &ownBatch;
+      if(target == batch) return;
+      size_t index = target->add(this);
+      target->copySlot(index, *batch, batchIndex);
+      SimMotor *moved = batch->remove(batchIndex);
+      if(moved) moved->batchIndex = batchIndex;
+      batch = target;
+      batchIndex = index;
+    }
+
+    void SimMotor::setBatchParameters() {
+      batch->minValue[batchIndex] = sMotor.minValue;
+      batch->maxValue[batchIndex] = sMotor.maxValue;
+      batch->p[batchIndex] = sMotor.p;
+      batch->i[batchIndex] = sMotor.i;
+      batch->d[batchIndex] = sMotor.d;
+      batch->filter[batchIndex] = filterValue;
+      batch->speedLimit[batchIndex] = sMotor.maxSpeed;
+      batch->effortLimit[batchIndex] = sMotor.maxEffort;
+    }
+
+    void SimMotor::prepareBatchStep() {
+      sReal play_position = 0.0;
+      if(myPlayJoint) play_position = myPlayJoint->getPosition();
+      refreshPosition();
+      *position += play_position;
+      batch->position[batchIndex] = *position;
+
+      // the maxima only depend on the position, so they can be computed
+      // before the controller runs
+      if(maxSpeedApproximation == &utils::pipe) {
+        batch->maxSpeed[batchIndex] = *maxspeed_x;
+      } else {
+        batch->maxSpeed[batchIndex] = getMomentaryMaxSpeed();
+      }
+      if(maxEffortApproximation == &utils::pipe) {
+        batch->maxEffort[batchIndex] = *maxeffort_x;
+      } else {
+        batch->maxEffort[batchIndex] = getMomentaryMaxEffort();
+      }
+    }
+
+    void SimMotor::finishBatchStep(sReal time_ms) {
+      time = time_ms;
+      tmpmaxspeed = batch->maxSpeed[batchIndex];
+      tmpmaxeffort = batch->maxEffort[batchIndex];
+
+      // the rest of update()
+      myJoint->setEffortLimit(tmpmaxeffort, axis);
+      for(std::map<std::string, SimMotor*>::iterator it = mimics.begin();
+          it != mimics.end(); ++it) {
+        it->second->setControlValue(controlValue());
+      }
+      estimateCurrent();
+      estimateTemperature(time_ms);
+      (myJoint->*setJointControlParameter)(controlParameter(), axis);
+    }
+
     void SimMotor::estimateCurrent() {
       // calculate current
-      effort = myJoint->getMotorTorque();
+      effort() = myJoint->getMotorTorque();
       joint_velocity = myJoint->getVelocity();
-      current = (*currentApproximation)(&effort, &joint_velocity, current_coefficients);
+      current = (*currentApproximation)(&effort(), &joint_velocity, current_coefficients);
     }
 
     void SimMotor::estimateTemperature(sReal time_ms) {
@@ -493,7 +606,10 @@ namespace mars {
 // from here on only getters and setters
 
     void SimMotor::attachJoint(SimJoint *joint){
+      // the effort and the current are estimated from the motor torque
+      if(myJoint) myJoint->releaseFeedback();
       myJoint = joint;
+      if(myJoint) myJoint->requestFeedback();
     }
 
     void SimMotor::attachPlayJoint(SimJoint *joint){
@@ -526,7 +642,7 @@ namespace mars {
         case MOTOR_TYPE_POSITION:
         case MOTOR_TYPE_PID_FORCE:
         case MOTOR_TYPE_EFFORT:
-          controlValue = angle;
+          controlValue() = angle;
           break;
         case MOTOR_TYPE_VELOCITY:
         case MOTOR_TYPE_DC:
@@ -539,7 +655,7 @@ namespace mars {
       switch(sMotor.type) {
         case MOTOR_TYPE_DC:
         case MOTOR_TYPE_VELOCITY:
-          controlValue = velocity;
+          controlValue() = velocity();
           break;
         case MOTOR_TYPE_PID:
         case MOTOR_TYPE_POSITION:
@@ -556,7 +672,7 @@ namespace mars {
         case MOTOR_TYPE_POSITION:
         case MOTOR_TYPE_PID_FORCE:
         case MOTOR_TYPE_EFFORT:
-          return controlValue;
+          return controlValue();
           break;
         case MOTOR_TYPE_DC:
         case MOTOR_TYPE_VELOCITY:
@@ -568,6 +684,7 @@ namespace mars {
 
     void SimMotor::setMaxEffort(sReal force) {
       sMotor.maxEffort = force;
+      setBatchParameters();
       myJoint->setEffortLimit(sMotor.maxEffort, axis);
     }
 
@@ -601,6 +718,7 @@ namespace mars {
 
     void SimMotor::setMaxSpeed(sReal speed) {
       sMotor.maxSpeed = fabs(speed);
+      setBatchParameters();
     }
 
     void SimMotor::setMaximumVelocity(sReal v) { // deprecated
@@ -642,31 +760,36 @@ namespace mars {
     }
 
     sReal SimMotor::getControlParameter(void) const {
-      return *controlParameter;
+      return controlParameter();
     }
 
     sReal SimMotor::getVelocity() const { // deprecated
-      return velocity;
+      return velocity();
     }
 
     void SimMotor::setMinValue(interfaces::sReal d) {
       sMotor.minValue = d;
+      setBatchParameters();
     }
 
     void SimMotor::setMaxValue(interfaces::sReal d) {
       sMotor.maxValue = d;
+      setBatchParameters();
     }
 
     void SimMotor::setP(sReal p) {
       sMotor.p = p;
+      setBatchParameters();
     }
 
     void SimMotor::setI(sReal i) {
       sMotor.i = i;
+      setBatchParameters();
     }
 
     void SimMotor::setD(sReal d) {
       sMotor.d = d;
+      setBatchParameters();
     }
 
     sReal SimMotor::getP() const {
@@ -688,6 +811,7 @@ namespace mars {
       if(this->sMotor.config.hasKey("filterValue")) {
         filterValue = this->sMotor.config["filterValue"];
       }
+      setBatchParameters();
       if(myJoint && (sMotor.type != MOTOR_TYPE_PID_FORCE)) {
           myJoint->attachMotor(axis);
           myJoint->setEffortLimit(sMotor.maxEffort, axis);
@@ -703,7 +827,7 @@ namespace mars {
     }
 
     void SimMotor::setControlValue(interfaces::sReal value) {
-      controlValue = value;
+      controlValue() = value;
       if(!control->sim->isSimRunning()) {
         myJoint->setOfflinePosition(value);
         refreshPositions();
@@ -731,7 +855,7 @@ namespace mars {
     }
 
     sReal SimMotor::getControlValue(void) const {
-      return controlValue;
+      return controlValue();
     }
 
     void SimMotor::setPID(sReal mP, sReal mI, sReal mD) {
@@ -743,6 +867,7 @@ namespace mars {
         sMotor.p = mP;
         sMotor.i = mI;
         sMotor.d = mD;
+        setBatchParameters();
         break;
       case MOTOR_TYPE_DC: // deprecated
       case MOTOR_TYPE_VELOCITY:
@@ -764,7 +889,7 @@ namespace mars {
       obj->index = sMotor.index;
       obj->name = sMotor.name;
       obj->groupID = sMotor.type;
-      obj->value = controlValue;
+      obj->value = controlValue();
     }
 
     sReal SimMotor::getCurrent(void) const {
@@ -772,7 +897,7 @@ namespace mars {
     }
 
     sReal SimMotor::getEffort() const {
-      return effort;
+      return effort();
     }
 
     sReal SimMotor::getTorque(void) const { // deprecated
@@ -801,7 +926,7 @@ namespace mars {
                                  data_broker::DataPackage *dbPackage,
                                  int callbackParam) {
         dbPackage->set(dbIdIndex, (long)sMotor.index);
-        dbPackage->set(dbControlParameterIndex, controlValue);
+        dbPackage->set(dbControlParameterIndex, controlValue());
         dbPackage->set(dbPositionIndex, getPosition());
         dbPackage->set(dbCurrentIndex, getCurrent());
         dbPackage->set(dbEffortIndex, getEffort());
@@ -26,6 +26,8 @@
 #endif
 
 #include "SimJoint.h"
+#include "CheckpointFormat.h"
+#include "MotorBatch.h"
 
 #include <mars/data_broker/ProducerInterface.h>
 #include <mars/data_broker/ReceiverInterface.h>
@@ -84,6 +86,22 @@ namespace mars {
       void runPositionController(interfaces::sReal time_ms);
       void runVeloctiyController(interfaces::sReal time_ms);
       void runEffortController(interfaces::sReal time_ms);
+
+      // batched update, see MotorBatch
+      /** \brief returns MOTOR_BATCH_NONE if the motor has to be updated
+       *         by update() */
+      MotorBatchType getBatchType() const;
+      /**
+       * \brief moves the parameters and the state of the motor into a new
+       *        slot of \a batch, or into its own batch if \a batch is NULL
+       */
+      void setBatch(MotorBatch *batch);
+      inline bool isBatched() const { return batch != &ownBatch; }
+      /** \brief stores the position and the momentary maxima in the batch */
+      void prepareBatchStep();
+      /** \brief hands the results of the batch controller to the joint */
+      void finishBatchStep(interfaces::sReal time_ms);
+
       void addMimic(SimMotor* mimic);
       void removeMimic(std::string mimicname);
       void clearMimics();
@@ -134,6 +152,10 @@ namespace mars {
       void setControlValue(interfaces::sReal value);
       void setMimic(interfaces::sReal multiplier, interfaces::sReal offset);
 
+      // checkpoints
+      void getCheckpointState(CheckpointMotorState *state) const;
+      void setCheckpointState(const CheckpointMotorState &state);
+
       // methods inherited from data broker interfaces
       void getDataBrokerNames(std::string *groupName, std::string *dataName) const;
 
@@ -175,7 +197,7 @@ namespace mars {
       interfaces::ControlCenter *control;
       interfaces::MotorData sMotor;
       interfaces::sReal time;
-      interfaces::sReal lastVelocity, velocity, position1, position2, effort;
+      interfaces::sReal position1, position2;
       interfaces::sReal tmpmaxeffort, tmpmaxspeed;
       interfaces::sReal current, temperature, filterValue;
       interfaces::sReal *position; // we use this pointer to access whatever axis-position is used
@@ -186,16 +208,52 @@ namespace mars {
       interfaces::sReal mimic_offset;
 
       // controller part
-      interfaces::sReal controlValue;
-      interfaces::sReal* controlParameter;
       interfaces::sReal* controlLimit;
       JointControlFunction setJointControlParameter;
       MotorControlFunction runController;
+      MotorBatchType batchType;
       interfaces::sReal p, i, d;
-      interfaces::sReal last_error;
-      interfaces::sReal integ_error;
       interfaces::sReal joint_velocity;
-      interfaces::sReal error;
+
+      // the controller parameters and state are kept in the slot
+      // batchIndex of batch, see MotorBatch
+      MotorBatch ownBatch;
+      MotorBatch *batch;
+      size_t batchIndex;
+      void setBatchParameters();
+      inline interfaces::sReal& controlValue()
+      { return batch->controlValue[batchIndex]; }
+      inline interfaces::sReal controlValue() const
+      { return batch->controlValue[batchIndex]; }
+      inline interfaces::sReal& error()
+      { return batch->error[batchIndex]; }
+      inline interfaces::sReal error() const
+      { return batch->error[batchIndex]; }
+      inline interfaces::sReal& lastError()
+      { return batch->lastError[batchIndex]; }
+      inline interfaces::sReal lastError() const
+      { return batch->lastError[batchIndex]; }
+      inline interfaces::sReal& integError()
+      { return batch->integError[batchIndex]; }
+      inline interfaces::sReal integError() const
+      { return batch->integError[batchIndex]; }
+      inline interfaces::sReal& velocity()
+      { return batch->velocity[batchIndex]; }
+      inline interfaces::sReal velocity() const
+      { return batch->velocity[batchIndex]; }
+      inline interfaces::sReal& lastVelocity()
+      { return batch->lastVelocity[batchIndex]; }
+      inline interfaces::sReal lastVelocity() const
+      { return batch->lastVelocity[batchIndex]; }
+      inline interfaces::sReal& effort()
+      { return batch->effort[batchIndex]; }
+      inline interfaces::sReal effort() const
+      { return batch->effort[batchIndex]; }
+      /// the velocity or the effort, depending on the motor type
+      inline interfaces::sReal& controlParameter()
+      { return batchType == MOTOR_BATCH_EFFORT ? effort() : velocity(); }
+      inline interfaces::sReal controlParameter() const
+      { return batchType == MOTOR_BATCH_EFFORT ? effort() : velocity(); }
 
       // function approximation
       double * maxspeed_x;
@@ -35,6 +35,7 @@
 #include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
 
 namespace mars {
   namespace sim {
@@ -103,6 +104,12 @@ namespace mars {
       else if(map.hasKey("reducedDataPackage") && (bool)map["reducedDataPackage"] == true) {
         pushToDataBroker = 1;
       }
+      // the package is only produced while it has receivers, the period
+      // thins out the updates of entities that are not needed every step
+      dataPackagePeriod = 0;
+      if(map.hasKey("dataPackagePeriod")) {
+        dataPackagePeriod = std::max(0, (int)map["dataPackagePeriod"]);
+      }
       if(pushToDataBroker > 0) {
         dbPackageMapping.add("id", &sNode.index);
         dbPackageMapping.add("position/x", &sNode.pos.x());
@@ -712,6 +719,18 @@ namespace mars {
       }
     }
 
+    void SimNode::getStates(NodeStates *states, size_t index) const {
+      MutexLocker locker(&iMutex);
+      states->position[index] = sNode.pos;
+      states->rotation[index] = sNode.rot;
+      states->linearVelocity[index] = l_vel;
+      states->angularVelocity[index] = a_vel;
+      states->linearAcceleration[index] = l_acc;
+      states->angularAcceleration[index] = a_acc;
+      states->force[index] = f;
+      states->torque[index] = t;
+    }
+
     void SimNode::setLinearVelocity(const Vector &vel) {
       MutexLocker locker(&iMutex);
       if (my_interface) {
@@ -894,7 +913,8 @@ namespace mars {
                                       data_broker::DATA_PACKAGE_READ_FLAG);
         // register as producer
         control->dataBroker->registerTimedProducer(this, groupName, dataName,
-                                                   "mars_sim/simTimer", 0);
+                                                   "mars_sim/simTimer",
+                                                   dataPackagePeriod, 0, true);
       }
     }
 
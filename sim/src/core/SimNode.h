@@ -51,6 +51,8 @@ namespace mars {
      * Each SimNode object publishes its state on the dataBroker.
      * The name under which the data is published can be obtained from the
      * nodeId via NodeManager::getDataBrokerNames.
+     * The package is only updated while it has receivers, a reader that
+     * polls getDataPackage has to register one.
      * The data_broker::DataPackage will contain the following items:
      *  - "id" (int)
      *  - "position/x" (double)
@@ -119,6 +121,8 @@ namespace mars {
       unsigned long getID(void) const; ///< Returns the node ID.
       void getCoreExchange(interfaces::core_objects_exchange *obj) const;
       void getPhysicalState(interfaces::nodeState *state) const;
+      /** \brief copies the state into entry \a index of \a states */
+      void getStates(interfaces::NodeStates *states, size_t index) const;
       bool getGroundContact(void) const;      
       void getMass(interfaces::sReal *mass, interfaces::sReal *inertia) const;
       void getContactPoints(std::vector<utils::Vector> *contact_points) const;
@@ -215,6 +219,7 @@ namespace mars {
       unsigned long graphics_id, graphics_id2;
       bool update_ray;
       int pushToDataBroker;
+      long dataPackagePeriod; ///< in sim timer steps, 0 for every step
       int visual_rep;
       interfaces::NodeId frictionDirNode;
       utils::Vector fDirNode;
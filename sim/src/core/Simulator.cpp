@@ -36,8 +36,13 @@
 #include "ControllerManager.h"
 #include "EntityManager.h"
 #include "Controller.h"
+#include "SimNode.h"
+#include "SimJoint.h"
+#include "SimMotor.h"
 
 #include <mars/utils/misc.h>
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/Trace.h>
 #include <mars/interfaces/SceneParseException.h>
 #include <mars/interfaces/graphics/GraphicsManagerInterface.h>
 #include <mars/interfaces/sim/LoadCenter.h>
@@ -51,6 +56,8 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cctype> // for tolower()
+#include <cmath>
+#include <cstring>
 
 #ifdef __linux__
 #include <time.h>
@@ -72,18 +79,39 @@ namespace mars {
       exit(signal);
     }
 
+    /// \cond HIDDEN_SYMBOLS
+    // updates the plugins of one wave of Simulator::updatePlugins
+    class PluginUpdateJob : public WorkerJob {
+    public:
+      PluginUpdateJob(Simulator *sim, const std::vector<unsigned int> &wave)
+        : sim(sim), wave(wave) {}
+      virtual void runTask(size_t index) {
+        sim->updatePluginTask(wave[index]);
+      }
+    private:
+      Simulator *sim;
+      const std::vector<unsigned int> &wave;
+    };
+    /// \endcond
 
     Simulator *Simulator::activeSimulator = 0;
 
     Simulator::Simulator(lib_manager::LibManager *theManager) :
       lib_manager::LibInterface(theManager),
       exit_sim(false), allow_draw(true),
-      sync_graphics(false), physics_mutex_count(0), physics(0),
-      haveNewPlugin(false) {
+      sync_graphics(false), pluginPool(NULL), pluginThreads(0),
+      physics_mutex_count(0), physics(0), haveNewPlugin(false),
+      simTimer(NULL), prePhysicsTrigger(NULL), postPhysicsTrigger(NULL),
+      finishedDrawTrigger(NULL) {
 
       config_dir = DEFAULT_CONFIG_DIR;
       calc_time = 0;
       avg_step_time = avg_log_time = 0;
+      simTimeNs = 0;
+      checkpointRequested = false;
+      profileResetPending = false;
+      nextCheckpointNs = 0;
+      cfgCheckpointInterval.dValue = 0.;
       count = 0;
       config_dir = ".";
 
@@ -122,6 +150,23 @@ namespace mars {
       dbSimDebugPackage.add("simUpdate", 0.);
       dbSimDebugPackage.add("worldStep", 0.);
       dbSimDebugPackage.add("logStep", 0.);
+      dbRealtimePackage.add("rtf", 0.);
+      dbRealtimePackage.add("targetRtf", 0.);
+      dbRealtimePackage.add("stepInterval", 0.);
+      dbRealtimePackage.add("jitterP50", 0.);
+      dbRealtimePackage.add("jitterP99", 0.);
+      dbRealtimePackage.add("jitterMax", 0.);
+      dbRealtimePackage.add("overruns", 0ul);
+      dbRealtimePackage.add("skipped", 0ul);
+      for(int i = 0; i < NUM_STEP_PHASES; ++i) {
+        string name = StepProfiler::getPhaseName((StepPhase)i);
+        dbProfilePackage.add(name + "/p50", 0.);
+        dbProfilePackage.add(name + "/p90", 0.);
+        dbProfilePackage.add(name + "/p99", 0.);
+        dbProfilePackage.add(name + "/max", 0.);
+      }
+      dbProfilePackage.add("steps", 0ul);
+      profileCount = 0;
 
       // load optional libs
       checkOptionalDependency("data_broker");
@@ -140,6 +185,7 @@ namespace mars {
       //fprintf(stderr, "Delete mars_sim\n");
 
       if (control->controllers) delete control->controllers;
+      delete pluginPool;
 
       if(control->cfg) {
         string saveFile = configPath.sValue;
@@ -184,11 +230,38 @@ namespace mars {
                                                        dbSimDebugPackage,
                                                        NULL,
                                                        data_broker::DATA_PACKAGE_READ_FLAG);
+          dbRealtimeId = control->dataBroker->pushData("mars_sim", "realtime",
+                                                       dbRealtimePackage,
+                                                       NULL,
+                                                       data_broker::DATA_PACKAGE_READ_FLAG);
+          dbProfileId = control->dataBroker->pushData("mars_sim", "profile",
+                                                      dbProfilePackage,
+                                                      NULL,
+                                                      data_broker::DATA_PACKAGE_READ_FLAG);
           getTimeMutex.unlock();
-          control->dataBroker->createTimer("mars_sim/simTimer");
-          control->dataBroker->createTrigger("mars_sim/prePhysicsUpdate");
-          control->dataBroker->createTrigger("mars_sim/postPhysicsUpdate");
-          control->dataBroker->createTrigger("mars_sim/finishedDrawTrigger");
+          // the DataBroker may outlive an earlier simulator instance
+          simTimer = control->dataBroker->getTimer("mars_sim/simTimer");
+          if(!simTimer) {
+            simTimer = control->dataBroker->createTimer("mars_sim/simTimer");
+          }
+          prePhysicsTrigger =
+            control->dataBroker->getTrigger("mars_sim/prePhysicsUpdate");
+          if(!prePhysicsTrigger) {
+            prePhysicsTrigger =
+              control->dataBroker->createTrigger("mars_sim/prePhysicsUpdate");
+          }
+          postPhysicsTrigger =
+            control->dataBroker->getTrigger("mars_sim/postPhysicsUpdate");
+          if(!postPhysicsTrigger) {
+            postPhysicsTrigger =
+              control->dataBroker->createTrigger("mars_sim/postPhysicsUpdate");
+          }
+          finishedDrawTrigger =
+            control->dataBroker->getTrigger("mars_sim/finishedDrawTrigger");
+          if(!finishedDrawTrigger) {
+            finishedDrawTrigger =
+              control->dataBroker->createTrigger("mars_sim/finishedDrawTrigger");
+          }
         } else {
           fprintf(stderr, "ERROR: could not get DataBroker!\n");
         }
@@ -288,6 +361,10 @@ namespace mars {
         loadScene(arg_v_scene_name.back());
         arg_v_scene_name.pop_back();
       }
+      if(!arg_checkpoint.empty()) {
+        loadCheckpoint(arg_checkpoint);
+        arg_checkpoint.clear();
+      }
       if (arg_run) {
         simulationStatus = RUNNING;
         arg_run = 0;
@@ -318,6 +395,7 @@ namespace mars {
        *
        */
     void Simulator::run() {
+      MARS_TRACE_THREAD_NAME("physics");
 
       while (!kill_sim) {
         stepping_mutex.lock();
@@ -326,6 +404,7 @@ namespace mars {
 
         if(!isSimRunning()) {
           stepping_wc.wait(&stepping_mutex);
+          realtimeScheduler.reset();
           if(kill_sim){
             stepping_mutex.unlock();
             break;
@@ -358,8 +437,6 @@ namespace mars {
     }
 
     void Simulator::step(bool setState) {
-      std::vector<pluginStruct>::iterator p_iter;
-      long time;
       Status oldState;
 
       physicsThreadLock();
@@ -369,32 +446,82 @@ namespace mars {
         simulationStatus = STEPPING;
       }
 
-      time = utils::getTime();
+      doStep(true);
+
+      if(setState) {
+        simulationStatus = oldState;
+      }
+
+      physicsThreadUnlock();
+    }
+
+    unsigned long Simulator::stepN(unsigned long n,
+                                   const StepCallback &callback) {
+      Status oldState;
+      unsigned long i;
+
+      physicsThreadLock();
+      oldState = simulationStatus;
+      simulationStatus = STEPPING;
+
+      for(i = 0; i < n; ) {
+        doStep(false);
+        ++i;
+        if(callback && !callback(i)) {
+          break;
+        }
+      }
+
+      simulationStatus = oldState;
+      physicsThreadUnlock();
+      return i;
+    }
+
+    void Simulator::doStep(bool syncGraphics) {
+      MARS_TRACE_SCOPE("Simulator::step");
+      long long time;
+      int64_t stepStart = StepProfiler::now(), t = stepStart;
+      // sub-millisecond steps are kept exactly in the nanosecond time base
+      long long stepNs = llround(calc_ms*1e6);
+
+      time = utils::getTimeNs();
 
       if(control->dataBroker) {
-        control->dataBroker->trigger("mars_sim/prePhysicsUpdate");
+        control->dataBroker->trigger(prePhysicsTrigger);
+        t = profiler.lap(STEP_PHASE_SENSORS, t);
+      }
+      {
+        MARS_TRACE_SCOPE("stepTheWorld");
+        physics->stepTheWorld();
       }
-      physics->stepTheWorld();
+      profiler.add(STEP_PHASE_COLLIDE, (int64_t)(physics->collide_time*1e6));
+      profiler.add(STEP_PHASE_SOLVE, (int64_t)(physics->solve_time*1e6));
+      t = StepProfiler::now();
 
-      avg_step_time += getTimeDiff(time);
+      avg_step_time += utils::getTimeDiffNs(time)*1e-6;
 
       control->nodes->updateDynamicNodes(calc_ms); //Moved update to here, otherwise RaySensor is one step behind the world every time
+      t = profiler.lap(STEP_PHASE_NODES, t);
       control->joints->updateJoints(calc_ms);
+      t = profiler.lap(STEP_PHASE_JOINTS, t);
       control->motors->updateMotors(calc_ms);
+      t = profiler.lap(STEP_PHASE_MOTORS, t);
       control->controllers->updateControllers(calc_ms);
+      t = profiler.lap(STEP_PHASE_CONTROLLERS, t);
 
-      time = utils::getTime();
+      time = utils::getTimeNs();
 
       getTimeMutex.lock();
-      dbSimTimePackage[0].d += calc_ms;
+      simTimeNs += stepNs;
+      dbSimTimePackage[0].d = simTimeNs*1e-6;
       getTimeMutex.unlock();
       if(control->dataBroker) {
         control->dataBroker->pushData(dbSimTimeId,
                                       dbSimTimePackage);
-        control->dataBroker->stepTimer("mars_sim/simTimer", calc_ms);
+        control->dataBroker->stepTimerNs(simTimer, stepNs);
       }
 
-      avg_log_time += getTimeDiff(time);
+      avg_log_time += utils::getTimeDiffNs(time)*1e-6;
       if(++count > avg_count_steps) {
         avg_log_time /= count;
         avg_step_time /= count;
@@ -403,41 +530,18 @@ namespace mars {
         dbSimDebugPackage[2].d = avg_log_time;
         avg_step_time = avg_log_time = 0.0;
       }
-      pluginLocker.lockForRead();
-
-      // It is possible for plugins to call switchPluginUpdateMode during
-      // the update call and get removed from the activePlugins list there.
-      // We use erased_active to notify this loop about an erasure.
-      for(unsigned int i = 0; i < activePlugins.size();) {
-        erased_active = false;
-        time = utils::getTime();
-
-        activePlugins[i].p_interface->update(calc_ms);
-
-        if(!erased_active) {
-          time = getTimeDiff(time);
-          activePlugins[i].timer += time;
-          activePlugins[i].t_count++;
-          if(activePlugins[i].t_count > avg_count_steps) {
-            activePlugins[i].timer /= activePlugins[i].t_count;
-            activePlugins[i].t_count = 0;
-            //fprintf(stderr, "debug_time: %s: %g\n",
-            //        activePlugins[i].name.c_str(),
-            //        activePlugins[i].timer);
-            getTimeMutex.lock();
-            dbSimDebugPackage[i+3].d = activePlugins[i].timer;
-            getTimeMutex.unlock();
-            activePlugins[i].timer = 0.0;
-          }
-          ++i;
-        }
+      t = profiler.lap(STEP_PHASE_DATA_BROKER, t);
+      {
+        MARS_TRACE_SCOPE("plugins");
+        updatePlugins();
       }
-      pluginLocker.unlock();
+      t = profiler.lap(STEP_PHASE_PLUGINS, t);
       if(control->dataBroker) {
         control->dataBroker->pushData(dbSimDebugId,
                                       dbSimDebugPackage);
+        t = profiler.lap(STEP_PHASE_DATA_BROKER, t);
       }
-      if (sync_graphics) {
+      if (syncGraphics && sync_graphics) {
         calc_time += calc_ms;
         if (calc_time >= sync_time) {
           sync_count = 0;
@@ -447,14 +551,127 @@ namespace mars {
         }
       }
       if(control->dataBroker) {
-        control->dataBroker->trigger("mars_sim/postPhysicsUpdate");
+        t = StepProfiler::now();
+        control->dataBroker->trigger(postPhysicsTrigger);
+        t = profiler.lap(STEP_PHASE_SENSORS, t);
+      }
+      profiler.add(STEP_PHASE_TOTAL, StepProfiler::now() - stepStart);
+      profiler.finishStep();
+      // can't be written back in cfgUpdateProperty while the cfg_manager
+      // notifies its clients
+      if(profileResetPending.exchange(false)) {
+        control->cfg->setPropertyValue("Simulator", "profile reset", "value",
+                                       false);
+      }
+      if(++profileCount > avg_count_steps) {
+        profileCount = 0;
+        publishProfile();
+      }
+      if(cfgCheckpointInterval.dValue > 0. && simTimeNs >= nextCheckpointNs) {
+        nextCheckpointNs = simTimeNs + llround(cfgCheckpointInterval.dValue*1e9);
+        checkpointMutex.lock();
+        if(!checkpointRequested && !checkpointWriter.isBusy()) {
+          checkpointFile = cfgCheckpointFile.sValue;
+          checkpointRequested = true;
+        }
+        checkpointMutex.unlock();
+      }
+      if(checkpointRequested) {
+        takeCheckpoint();
       }
+    }
 
-      if(setState) {
-        simulationStatus = oldState;
+    void Simulator::publishProfile(void) {
+      if(!control->dataBroker) return;
+      for(int i = 0; i < NUM_STEP_PHASES; ++i) {
+        const StepHistogram &histogram = profiler.getHistogram((StepPhase)i);
+        dbProfilePackage[i*4].d = histogram.getPercentile(0.5);
+        dbProfilePackage[i*4+1].d = histogram.getPercentile(0.9);
+        dbProfilePackage[i*4+2].d = histogram.getPercentile(0.99);
+        dbProfilePackage[i*4+3].d = histogram.getMax();
+      }
+      dbProfilePackage[NUM_STEP_PHASES*4].ul =
+        profiler.getHistogram(STEP_PHASE_TOTAL).getCount();
+      control->dataBroker->pushData(dbProfileId, dbProfilePackage);
+    }
+
+    void Simulator::updatePlugins(void) {
+      // the pool is only used by this thread and adapted here
+      int threads = pluginThreads;
+      if(threads <= 0) {
+        delete pluginPool;
+        pluginPool = NULL;
+      } else if(!pluginPool || pluginPool->getNumThreads() != threads) {
+        delete pluginPool;
+        pluginPool = new WorkerPool(threads);
       }
 
-      physicsThreadUnlock();
+      pluginLocker.lockForRead();
+
+      // It is possible for plugins to call switchPluginUpdateMode during
+      // the update call and get removed from the activePlugins list there.
+      // We use erased_active to notify this loop about an erasure.
+      // Parallel-safe plugins are not allowed to do so.
+      std::vector<unsigned int> wave;
+      for(unsigned int i = 0; i < activePlugins.size();) {
+        unsigned int access = activePlugins[i].p_interface->getUpdateAccess();
+        wave.clear();
+        if(pluginPool && (access & PLUGIN_ACCESS_PARALLEL_SAFE)) {
+          // collect the following plugins that can run concurrently
+          unsigned int reads = 0, writes = 0;
+          for(unsigned int k = i; k < activePlugins.size(); ++k) {
+            if(k > i) {
+              access = activePlugins[k].p_interface->getUpdateAccess();
+            }
+            unsigned int r = access & 0xff;
+            unsigned int w = (access >> 8) & 0xff;
+            if(!(access & PLUGIN_ACCESS_PARALLEL_SAFE) ||
+               (w & (reads | writes)) || (writes & r)) {
+              break;
+            }
+            reads |= r;
+            writes |= w;
+            wave.push_back(k);
+          }
+        }
+        if(wave.size() > 1) {
+          erased_active = false;
+          PluginUpdateJob job(this, wave);
+          pluginPool->execute(&job, wave.size());
+          i += wave.size();
+        } else {
+          erased_active = false;
+          updatePluginTask(i);
+          if(!erased_active) {
+            ++i;
+          }
+        }
+      }
+      pluginLocker.unlock();
+    }
+
+    void Simulator::updatePluginTask(unsigned int index) {
+      pluginStruct &plugin = activePlugins[index];
+      MARS_TRACE_SCOPE_DYNAMIC(plugin.name);
+      long long time = utils::getTimeNs();
+
+      plugin.p_interface->update(calc_ms);
+
+      // the plugin removed itself from activePlugins
+      if(erased_active) return;
+
+      plugin.timer += utils::getTimeDiffNs(time)*1e-6;
+      plugin.t_count++;
+      if(plugin.t_count > avg_count_steps) {
+        plugin.timer /= plugin.t_count;
+        plugin.t_count = 0;
+        //fprintf(stderr, "debug_time: %s: %g\n",
+        //        plugin.name.c_str(), plugin.timer);
+        getTimeMutex.lock();
+        dbSimDebugPackage[index+3].d = plugin.timer;
+        getTimeMutex.unlock();
+        plugin.timer = 0.0;
+      }
     }
 
     /**
@@ -494,63 +711,38 @@ namespace mars {
 
     //consider the case where the time step is smaller than 1 ms
     void Simulator::myRealTime() {
-      static long myTime = utils::getTime();
-      long timeDiff = getTimeDiff(myTime);
-      static double avgTime = 0;
-      avgTime += timeDiff;
-#ifdef __linux__  //__unix__, wenn Darwin das mitmacht.
-      //used to remember last time this function was called
-      //and as absolute (minimum) wake-up time.
-      static struct timespec ts;
-      static bool tsNeedsInit = true;
-      if (tsNeedsInit)
-        {
-          int retval = clock_gettime(CLOCK_MONOTONIC, &ts);
-          if (retval != 0)
-            {
-              throw std::runtime_error("clock_gettime(CLOCK_MONOTONIC, ...) failed");
-            }
-          tsNeedsInit = false;
-        }
-
-      //schedule minimum sleep time
-      ts.tv_nsec += calc_ms * 1000000;
-
-      //the nsec value may not exceed one second
-      while (ts.tv_nsec > 1000000000)
-        {
-          ts.tv_nsec -= 1000000000;
-          ts.tv_sec += 1;
+      realtimeScheduler.waitForNextStep(calc_ms);
+
+      if(realtimeScheduler.getNumSamples() > (size_t)avg_count_steps) {
+        RealtimeStatistics statistics = realtimeScheduler.takeStatistics();
+        dbSimDebugPackage[0].d = statistics.stepInterval;
+        dbRealtimePackage[0].d = statistics.realTimeFactor;
+        dbRealtimePackage[1].d = realtimeScheduler.getRealTimeFactor();
+        dbRealtimePackage[2].d = statistics.stepInterval;
+        dbRealtimePackage[3].d = statistics.jitterP50;
+        dbRealtimePackage[4].d = statistics.jitterP99;
+        dbRealtimePackage[5].d = statistics.jitterMax;
+        dbRealtimePackage[6].ul = statistics.overruns;
+        dbRealtimePackage[7].ul = statistics.skipped;
+        if(control->dataBroker) {
+          control->dataBroker->pushData(dbRealtimeId, dbRealtimePackage);
         }
+      }
+    }
 
-      //sleep...
-      int retval = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0);
-      if (retval != 0)
-        {
-          std::cerr << "WARNING: Your system is too slow!" << std::endl;
-        }
 
-      //remember time
-      retval = clock_gettime(CLOCK_MONOTONIC, &ts);
-      if (retval != 0)
-        {
-          throw std::runtime_error("clock_gettime(CLOCK_MONOTONIC, ...) failed");
+    void Simulator::setOverrunPolicy(const std::string &policy) {
+      if(policy == "skip") {
+        realtimeScheduler.setOverrunPolicy(REALTIME_SKIP);
+      } else {
+        if(policy != "catch up") {
+          LOG_WARN("Simulator: unknown realtime overrun policy \"%s\", "
+                   "using \"catch up\"", policy.c_str());
         }
-#else
-      if(timeDiff < calc_ms) {
-        long valSleep = calc_ms - timeDiff;
-        msleep(valSleep);
-      }
-#endif
-      if(count+1 > avg_count_steps) {
-        avgTime /= count;
-        dbSimDebugPackage[0].d = avgTime;
-        avgTime = 0;
+        realtimeScheduler.setOverrunPolicy(REALTIME_CATCH_UP);
       }
-      myTime += timeDiff;
     }
 
-
     bool Simulator::isSimRunning() const {
       return (simulationStatus != STOPPED);
     }
@@ -736,13 +928,221 @@ namespace mars {
       }
       pluginLocker.unlock();
 
-      control->dataBroker->trigger("mars_sim/finishedDrawTrigger");
+      control->dataBroker->trigger(finishedDrawTrigger);
+    }
+
+    bool Simulator::saveCheckpoint(const std::string &filename) {
+      checkpointMutex.lock();
+      bool busy = checkpointRequested || checkpointWriter.isBusy();
+      if(!busy) {
+        checkpointFile = filename;
+        checkpointRequested = true;
+      }
+      checkpointMutex.unlock();
+      if(busy) {
+        LOG_WARN("Simulator: a checkpoint is still being written, \"%s\" is skipped",
+                 filename.c_str());
+        return false;
+      }
+      // Between two steps the snapshot is taken right away. Otherwise the
+      // thread that is stepping takes it at the end of the current step.
+      if(!isCurrentThread() && physicsMutex.tryLock() == MUTEX_ERROR_NO_ERROR) {
+        takeCheckpoint();
+        physicsMutex.unlock();
+      }
+      return true;
+    }
+
+    void Simulator::takeCheckpoint(void) {
+      MARS_TRACE_SCOPE("Simulator::takeCheckpoint");
+      std::vector<core_objects_exchange> list;
+      MutexLocker locker(&checkpointMutex);
+      if(!checkpointRequested) return;
+      checkpointRequested = false;
+
+      checkpointData.clear();
+      getTimeMutex.lock();
+      checkpointData.simTimeNs = simTimeNs;
+      getTimeMutex.unlock();
+      checkpointData.calcMs = calc_ms;
+
+      control->nodes->getListNodes(&list);
+      for(size_t i = 0; i < list.size(); ++i) {
+        const SimNode *node = control->nodes->getSimNode(list[i].index);
+        if(!node || !node->isMovable()) continue;
+        CheckpointNodeState state;
+        Vector v = node->getPosition();
+        Quaternion q = node->getRotation();
+        state.id = list[i].index;
+        for(int k = 0; k < 3; ++k) state.position[k] = v[k];
+        state.rotation[0] = q.x();
+        state.rotation[1] = q.y();
+        state.rotation[2] = q.z();
+        state.rotation[3] = q.w();
+        v = node->getLinearVelocity();
+        for(int k = 0; k < 3; ++k) state.linearVelocity[k] = v[k];
+        v = node->getAngularVelocity();
+        for(int k = 0; k < 3; ++k) state.angularVelocity[k] = v[k];
+        checkpointData.nodes.push_back(state);
+      }
+
+      std::vector<SimJoint*> joints = control->joints->getSimJoints();
+      checkpointData.joints.resize(joints.size());
+      for(size_t i = 0; i < joints.size(); ++i) {
+        joints[i]->getCheckpointState(&checkpointData.joints[i]);
+      }
+
+      control->motors->getListMotors(&list);
+      for(size_t i = 0; i < list.size(); ++i) {
+        const SimMotor *motor = control->motors->getSimMotor(list[i].index);
+        if(!motor) continue;
+        checkpointData.motors.push_back(CheckpointMotorState());
+        motor->getCheckpointState(&checkpointData.motors.back());
+      }
+
+      control->sensors->getListSensors(&list);
+      for(size_t i = 0; i < list.size(); ++i) {
+        const BaseSensor *sensor = control->sensors->getSimSensor(list[i].index);
+        if(!sensor) continue;
+        checkpointData.sensors.push_back(CheckpointBlob());
+        checkpointData.sensors.back().id = list[i].index;
+        if(!sensor->saveCheckpoint(&checkpointData.sensors.back().data)) {
+          checkpointData.sensors.pop_back();
+        }
+      }
+
+      if(control->dataBroker) {
+        std::vector<std::string> names = control->dataBroker->getTimerNames();
+        for(size_t i = 0; i < names.size(); ++i) {
+          int64_t t = control->dataBroker->getTimerTimeNs(control->dataBroker->getTimer(names[i]));
+          checkpointData.timers.push_back(CheckpointBlob());
+          checkpointData.timers.back().id = 0;
+          checkpointData.timers.back().name = names[i];
+          checkpointData.timers.back().data.assign((const char*)&t,
+                                                   (const char*)&t + sizeof(t));
+        }
+      }
+
+      pluginLocker.lockForRead();
+      for(size_t i = 0; i < allPlugins.size(); ++i) {
+        checkpointData.plugins.push_back(CheckpointBlob());
+        checkpointData.plugins.back().id = 0;
+        checkpointData.plugins.back().name = allPlugins[i].name;
+        if(!allPlugins[i].p_interface->saveCheckpoint(&checkpointData.plugins.back().data)) {
+          checkpointData.plugins.pop_back();
+        }
+      }
+      pluginLocker.unlock();
+
+      if(!checkpointWriter.write(checkpointFile, &checkpointData)) {
+        LOG_WARN("Simulator: a checkpoint is still being written, \"%s\" is skipped",
+                 checkpointFile.c_str());
+      }
+    }
+
+    bool Simulator::loadCheckpoint(const std::string &filename) {
+      CheckpointReader reader;
+      std::vector<CheckpointEntryView> entries;
+      std::vector<pluginStruct>::iterator p_iter;
+      unsigned int missing = 0;
+      size_t count;
+
+      if(!reader.open(filename)) {
+        return false;
+      }
+      if(reader.getCalcMs() != calc_ms) {
+        LOG_WARN("Simulator: checkpoint \"%s\" was taken with calc_ms %g instead of %g",
+                 filename.c_str(), reader.getCalcMs(), calc_ms);
+      }
+
+      physicsThreadLock();
+      const CheckpointNodeState *nodes = reader.getNodes(&count);
+      for(size_t i = 0; i < count; ++i) {
+        SimNode *node = control->nodes->getSimNode(nodes[i].id);
+        if(!node) {
+          ++missing;
+          continue;
+        }
+        const double *r = nodes[i].rotation;
+        node->setPosition(Vector(nodes[i].position[0], nodes[i].position[1],
+                                 nodes[i].position[2]), false);
+        node->setRotation(Quaternion(r[3], r[0], r[1], r[2]), false);
+        node->setLinearVelocity(Vector(nodes[i].linearVelocity[0],
+                                       nodes[i].linearVelocity[1],
+                                       nodes[i].linearVelocity[2]));
+        node->setAngularVelocity(Vector(nodes[i].angularVelocity[0],
+                                        nodes[i].angularVelocity[1],
+                                        nodes[i].angularVelocity[2]));
+      }
+
+      const CheckpointJointState *joints = reader.getJoints(&count);
+      for(size_t i = 0; i < count; ++i) {
+        SimJoint *joint = control->joints->getSimJoint(joints[i].id);
+        if(joint) joint->setCheckpointState(joints[i]);
+        else ++missing;
+      }
+
+      const CheckpointMotorState *motors = reader.getMotors(&count);
+      for(size_t i = 0; i < count; ++i) {
+        SimMotor *motor = control->motors->getSimMotor(motors[i].id);
+        if(motor) motor->setCheckpointState(motors[i]);
+        else ++missing;
+      }
+
+      reader.getEntries(CHECKPOINT_SENSORS, &entries);
+      for(size_t i = 0; i < entries.size(); ++i) {
+        BaseSensor *sensor = control->sensors->getSimSensor(entries[i].id);
+        if(sensor) sensor->loadCheckpoint(entries[i].data, entries[i].size);
+        else ++missing;
+      }
+
+      reader.getEntries(CHECKPOINT_TIMERS, &entries);
+      for(size_t i = 0; control->dataBroker && i < entries.size(); ++i) {
+        data_broker::TimerHandle timer = control->dataBroker->getTimer(entries[i].name);
+        int64_t t;
+        if(!timer || entries[i].size != sizeof(t)) {
+          ++missing;
+          continue;
+        }
+        memcpy(&t, entries[i].data, sizeof(t));
+        control->dataBroker->setTimerTimeNs(timer, t);
+      }
+
+      reader.getEntries(CHECKPOINT_PLUGINS, &entries);
+      pluginLocker.lockForRead();
+      for(size_t i = 0; i < entries.size(); ++i) {
+        for(p_iter=allPlugins.begin(); p_iter!=allPlugins.end(); p_iter++) {
+          if(p_iter->name == entries[i].name) {
+            p_iter->p_interface->loadCheckpoint(entries[i].data, entries[i].size);
+            break;
+          }
+        }
+        if(p_iter == allPlugins.end()) ++missing;
+      }
+      pluginLocker.unlock();
+
+      getTimeMutex.lock();
+      simTimeNs = reader.getSimTimeNs();
+      dbSimTimePackage[0].d = simTimeNs*1e-6;
+      getTimeMutex.unlock();
+      nextCheckpointNs = simTimeNs + llround(cfgCheckpointInterval.dValue*1e9);
+      realtimeScheduler.reset();
+      physicsThreadUnlock();
+
+      if(missing) {
+        LOG_WARN("Simulator: %u states of checkpoint \"%s\" do not match the scene",
+                 missing, filename.c_str());
+      }
+      LOG_INFO("Simulator: restored checkpoint \"%s\" at %.3f s",
+               filename.c_str(), simTimeNs*1e-9);
+      return true;
     }
 
     void Simulator::newWorld(bool clear_all) {
       physicsThreadLock();
       // reset simTime
       realStartTime = utils::getTime();
+      simTimeNs = 0;
       dbSimTimePackage[0].set(0.);
       control->controllers->clearAllControllers();
       control->sensors->clearAllSensors(clear_all);
@@ -805,6 +1205,7 @@ namespace mars {
         {"scenename", 1, 0, 's'},
         {"config_dir", required_argument, 0, 'C'},
         {"c_port",1,0,'c'},
+        {"checkpoint", required_argument, 0, 'k'},
         {0, 0, 0, 0}
       };
 
@@ -829,7 +1230,7 @@ namespace mars {
       }
 
       while (1) {
-        c = getopt_long(argc, argv, "hrgoGs:C:p:", long_options, &option_index);
+        c = getopt_long(argc, argv, "hrgoGs:C:p:k:", long_options, &option_index);
         if (c == -1)
           break;
         switch (c) {
@@ -855,6 +1256,10 @@ namespace mars {
         case 'r':
           arg_run = 1;
           break;
+        case 'k':
+          if(pathExists(optarg)) arg_checkpoint = optarg;
+          else LOG_ERROR("The given checkpoint does not exist: %s\n", optarg);
+          break;
         case 'c':
           std_port = atoi(optarg);
           break;
@@ -873,6 +1278,7 @@ namespace mars {
           printf("-h             this screen:\n");
           printf("-s <filename>  filename for scene to load\n");
           printf("-r             start directly the simulation\n");
+          printf("-k <filename>  checkpoint to restore after loading the scenes\n");
           printf("-c             set standard controller port\n");
           printf("-C             path to Configuration\n");
           printf("-g             show 3d grid\n");
@@ -1238,6 +1644,16 @@ namespace mars {
         return;
       }
 
+      if(_property.paramId == cfgRealtimeFactor.paramId) {
+        realtimeScheduler.setRealTimeFactor(_property.dValue);
+        return;
+      }
+
+      if(_property.paramId == cfgOverrunPolicy.paramId) {
+        setOverrunPolicy(_property.sValue);
+        return;
+      }
+
       if(_property.paramId == cfgSyncGui.paramId) {
         this->setSyncThreads(_property.bValue);
         return;
@@ -1291,6 +1707,64 @@ namespace mars {
         return;
       }
 
+      if(_property.paramId == cfgAsyncInterval.paramId) {
+        if(control->dataBroker) {
+          control->dataBroker->setAsyncInterval(_property.dValue);
+        }
+        return;
+      }
+
+      if(_property.paramId == cfgProducerThreads.paramId) {
+        if(control->dataBroker) {
+          control->dataBroker->setProducerThreads(_property.iValue);
+        }
+        return;
+      }
+
+      if(_property.paramId == cfgPluginThreads.paramId) {
+        pluginThreads = _property.iValue;
+        return;
+      }
+
+      // the property works like a button: only setting it to true resets
+      // the profile, the step writes it back to false afterwards
+      if(_property.paramId == cfgProfileReset.paramId) {
+        if(_property.bValue) {
+          profiler.requestReset();
+          profileResetPending = true;
+        }
+        return;
+      }
+
+      if(_property.paramId == cfgCheckpointInterval.paramId) {
+        cfgCheckpointInterval.dValue = _property.dValue;
+        nextCheckpointNs = simTimeNs + llround(_property.dValue*1e9);
+        return;
+      }
+
+      if(_property.paramId == cfgCheckpointFile.paramId) {
+        cfgCheckpointFile.sValue = _property.sValue;
+        return;
+      }
+
+      if(_property.paramId == cfgTrace.paramId) {
+        // stopping the trace writes it
+        if(Trace::isEnabled() && !_property.bValue) {
+          Trace::writeChromeTrace(cfgTraceFile.sValue);
+        }
+        Trace::setEnabled(_property.bValue);
+        Trace::setExitFile(_property.bValue ? cfgTraceFile.sValue : "");
+        return;
+      }
+
+      if(_property.paramId == cfgTraceFile.paramId) {
+        cfgTraceFile.sValue = _property.sValue;
+        if(Trace::isEnabled()) {
+          Trace::setExitFile(cfgTraceFile.sValue);
+        }
+        return;
+      }
+
     }
 
     void Simulator::initCfgParams(void) {
@@ -1305,6 +1779,14 @@ namespace mars {
                                                       true, this);
       my_real_time = cfgRealtime.bValue;
 
+      cfgRealtimeFactor = control->cfg->getOrCreateProperty("Simulator", "realtime factor",
+                                                            1.0, this);
+      realtimeScheduler.setRealTimeFactor(cfgRealtimeFactor.dValue);
+
+      cfgOverrunPolicy = control->cfg->getOrCreateProperty("Simulator", "realtime overrun policy",
+                                                           "catch up", this);
+      setOverrunPolicy(cfgOverrunPolicy.sValue);
+
       cfgDebugTime = control->cfg->getOrCreateProperty("Simulator", "debug time",
                                                        false, this);
 
@@ -1341,6 +1823,41 @@ namespace mars {
       cfgAvgCountSteps = control->cfg->getOrCreateProperty("Simulator", "avg count steps",
                                                            avg_count_steps, this);
       avg_count_steps = cfgAvgCountSteps.iValue;
+
+      cfgAsyncInterval = control->cfg->getOrCreateProperty("Simulator", "data broker async interval",
+                                                           10.0, this);
+      if(control->dataBroker) {
+        control->dataBroker->setAsyncInterval(cfgAsyncInterval.dValue);
+      }
+
+      cfgProducerThreads = control->cfg->getOrCreateProperty("Simulator", "data broker producer threads",
+                                                             0, this);
+      if(control->dataBroker) {
+        control->dataBroker->setProducerThreads(cfgProducerThreads.iValue);
+      }
+
+      cfgPluginThreads = control->cfg->getOrCreateProperty("Simulator", "plugin threads",
+                                                           0, this);
+      pluginThreads = cfgPluginThreads.iValue;
+
+      cfgProfileReset = control->cfg->getOrCreateProperty("Simulator", "profile reset",
+                                                          false, this);
+
+      cfgCheckpointFile = control->cfg->getOrCreateProperty("Simulator", "checkpoint file",
+                                                            "mars_checkpoint.mck", this);
+      // in seconds of simulation time, 0 disables the periodic checkpoints
+      cfgCheckpointInterval = control->cfg->getOrCreateProperty("Simulator", "checkpoint interval",
+                                                                0.0, this);
+      nextCheckpointNs = llround(cfgCheckpointInterval.dValue*1e9);
+
+      cfgTraceFile = control->cfg->getOrCreateProperty("Simulator", "trace file",
+                                                       "mars_trace.json", this);
+      cfgTrace = control->cfg->getOrCreateProperty("Simulator", "trace",
+                                                   false, this);
+      if(cfgTrace.bValue) {
+        Trace::setEnabled(true);
+        Trace::setExitFile(cfgTraceFile.sValue);
+      }
       control->cfg->getOrCreateProperty("Simulator", "onPhysicsError",
                                         "abort", this);
 
@@ -32,19 +32,26 @@
   #warning "Simulator.h"
 #endif
 
+#include "Checkpoint.h"
+#include "RealtimeScheduler.h"
+#include "StepProfiler.h"
+
 #include <mars/data_broker/DataPackage.h>
 #include <mars/data_broker/ReceiverInterface.h>
+#include <mars/data_broker/DataBrokerInterface.h>
 #include <mars/cfg_manager/CFGManagerInterface.h>
 #include <mars/utils/Thread.h>
 #include <mars/utils/Mutex.h>
 #include <mars/utils/WaitCondition.h>
 #include <mars/utils/ReadWriteLock.h>
+#include <mars/utils/WorkerPool.h>
 #include <mars/interfaces/sim/SimulatorInterface.h>
 #include <mars/interfaces/sim/PhysicsInterface.h>
 #include <mars/interfaces/sim/PluginInterface.h>
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/interfaces/graphics/GraphicsUpdateInterface.h>
 
+#include <atomic>
 #include <iostream>
 
 
@@ -151,6 +158,10 @@ namespace mars {
       virtual bool sceneChanged() const;
       virtual void sceneHasChanged(bool reset);
 
+      // checkpoints
+      virtual bool saveCheckpoint(const std::string &filename);
+      virtual bool loadCheckpoint(const std::string &filename);
+
       //threads
       virtual bool allConcurrencysHandled(); ///< Checks if external requests are open.
       void setSyncThreads(bool value); ///< Syncs the threads of GUI and simulation.
@@ -207,6 +218,8 @@ namespace mars {
       virtual const utils::Vector& getGravity(void);
 
       virtual void step(bool setState = false);
+      virtual unsigned long stepN(unsigned long n,
+                                  const interfaces::StepCallback &callback=interfaces::StepCallback());
 
       /*
        * returns the real startTimestamp plus the calculated simulation time
@@ -214,6 +227,7 @@ namespace mars {
       virtual unsigned long getTime();
 
     private:
+      friend class PluginUpdateJob;
 
       struct LoadOptions {
         std::string filename;
@@ -223,6 +237,13 @@ namespace mars {
 
       // simulation control
       void processRequests();
+      // one step of the physics and the managers, the caller holds the
+      // physics lock
+      void doStep(bool syncGraphics);
+      // updates the active plugins, independent parallel-safe plugins
+      // run concurrently on the plugin pool
+      void updatePlugins(void);
+      void updatePluginTask(unsigned int index);
       void reloadWorld(void);      
 
       int arg_no_gui, arg_run, arg_grid, arg_ortho;
@@ -237,6 +258,7 @@ namespace mars {
       Status simulationStatus;
       interfaces::sReal sync_time;
       bool my_real_time;
+      RealtimeScheduler realtimeScheduler;
       bool fast_step;      
 
       // graphics
@@ -247,6 +269,8 @@ namespace mars {
       // threads
       bool erased_active;
       utils::ReadWriteLock pluginLocker;
+      utils::WorkerPool *pluginPool;
+      int pluginThreads;
       int sync_count;
       utils::Mutex externalMutex;
       utils::Mutex coreMutex;
@@ -263,11 +287,16 @@ namespace mars {
       // physics
       interfaces::PhysicsInterface *physics;
       double calc_ms;
+      long long simTimeNs; ///< simulation time in ns, exact for sub-ms steps
       int load_option;
       int std_port; ///< Controller port (default value: 1600)
       utils::Vector gravity;
       unsigned long dbPhysicsUpdateId;
-      unsigned long dbSimTimeId, dbSimDebugId;
+      unsigned long dbSimTimeId, dbSimDebugId, dbRealtimeId, dbProfileId;
+      StepProfiler profiler;
+      int profileCount;
+      std::atomic<bool> profileResetPending;
+      void publishProfile(void);
       unsigned long realStartTime;
 
       // plugins
@@ -281,13 +310,26 @@ namespace mars {
       std::string scenename;
       std::list<std::string> arg_v_scene_name;
       bool b_SceneChanged;
+
+      // checkpoints
+      void takeCheckpoint(void);
+      CheckpointWriter checkpointWriter;
+      CheckpointData checkpointData;
+      utils::Mutex checkpointMutex;
+      std::string checkpointFile;
+      std::atomic<bool> checkpointRequested;
+      long long nextCheckpointNs; ///< simulation time of the next periodic checkpoint
+      std::string arg_checkpoint;
       bool haveNewPlugin;
 
       // configuration
       void initCfgParams(void);
+      // "catch up" or "skip"
+      void setOverrunPolicy(const std::string &policy);
       std::string config_dir;
       cfg_manager::cfgPropertyStruct cfgCalcMs, cfgFaststep;
       cfg_manager::cfgPropertyStruct cfgRealtime, cfgDebugTime;
+      cfg_manager::cfgPropertyStruct cfgRealtimeFactor, cfgOverrunPolicy;
       cfg_manager::cfgPropertyStruct cfgSyncGui, cfgDrawContact;
       cfg_manager::cfgPropertyStruct cfgGX, cfgGY, cfgGZ;
       cfg_manager::cfgPropertyStruct cfgWorldErp, cfgWorldCfm;
@@ -296,11 +338,22 @@ namespace mars {
       cfg_manager::cfgPropertyStruct configPath;
       cfg_manager::cfgPropertyStruct cfgUseNow;
       cfg_manager::cfgPropertyStruct cfgAvgCountSteps;
+      cfg_manager::cfgPropertyStruct cfgAsyncInterval;
+      cfg_manager::cfgPropertyStruct cfgProducerThreads;
+      cfg_manager::cfgPropertyStruct cfgPluginThreads;
+      cfg_manager::cfgPropertyStruct cfgTrace, cfgTraceFile;
+      cfg_manager::cfgPropertyStruct cfgProfileReset;
+      cfg_manager::cfgPropertyStruct cfgCheckpointInterval, cfgCheckpointFile;
       
       // data
       data_broker::DataPackage dbPhysicsUpdatePackage;
       data_broker::DataPackage dbSimTimePackage;
       data_broker::DataPackage dbSimDebugPackage;
+      data_broker::DataPackage dbRealtimePackage;
+      data_broker::DataPackage dbProfilePackage;
+      data_broker::TimerHandle simTimer;
+      data_broker::TriggerHandle prePhysicsTrigger, postPhysicsTrigger;
+      data_broker::TriggerHandle finishedDrawTrigger;
 
       // IceServer comServer;
 
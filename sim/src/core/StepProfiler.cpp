@@ -0,0 +1,121 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "StepProfiler.h"
+
+#include <mars/utils/misc.h>
+
+#include <cstring>
+
+namespace mars {
+  namespace sim {
+
+    /// \cond HIDDEN_SYMBOLS
+    static const char* phaseNames[NUM_STEP_PHASES] = {
+      "collide", "solve", "nodes", "joints", "motors", "controllers",
+      "sensors", "dataBroker", "plugins", "step"
+    };
+
+    static int highestBit(uint64_t v) {
+      int bit = 0;
+      while(v >>= 1) ++bit;
+      return bit;
+    }
+    /// \endcond
+
+    StepHistogram::StepHistogram() {
+      reset();
+    }
+
+    void StepHistogram::reset() {
+      memset(buckets, 0, sizeof(buckets));
+      count = 0;
+      maxValue = 0;
+    }
+
+    void StepHistogram::add(int64_t ns) {
+      uint64_t v = ns > 0 ? (uint64_t)ns : 0;
+      if(v >= (1ULL << MAX_BITS)) v = (1ULL << MAX_BITS) - 1;
+      size_t index = v;
+      if(v >= SUB_BUCKETS) {
+        int shift = highestBit(v) - SUB_BUCKET_BITS;
+        index = (shift + 1) * SUB_BUCKETS + ((v >> shift) - SUB_BUCKETS);
+      }
+      buckets[index]++;
+      count++;
+      if(ns > maxValue) maxValue = ns;
+    }
+
+    double StepHistogram::getPercentile(double fraction) const {
+      if(!count) return 0.;
+      uint64_t rank = (uint64_t)(fraction * count + 0.5);
+      if(rank < 1) rank = 1;
+      uint64_t sum = 0;
+      for(int i = 0; i < NUM_BUCKETS; ++i) {
+        sum += buckets[i];
+        if(sum >= rank) {
+          // the middle of the bucket
+          double low, width;
+          if(i < SUB_BUCKETS) {
+            low = i;
+            width = 1.;
+          } else {
+            int shift = i / SUB_BUCKETS - 1;
+            low = (double)((uint64_t)(SUB_BUCKETS + i % SUB_BUCKETS) << shift);
+            width = (double)(1ULL << shift);
+          }
+          double value = low + width * 0.5;
+          if(value > maxValue) value = maxValue;
+          return value * 1e-6;
+        }
+      }
+      return getMax();
+    }
+
+    StepProfiler::StepProfiler() : resetRequested(false) {
+      memset(stepTimes, 0, sizeof(stepTimes));
+    }
+
+    int64_t StepProfiler::now() {
+      return utils::getTimeNs();
+    }
+
+    void StepProfiler::finishStep() {
+      if(resetRequested.exchange(false)) {
+        for(int i = 0; i < NUM_STEP_PHASES; ++i) {
+          histograms[i].reset();
+        }
+      }
+      for(int i = 0; i < NUM_STEP_PHASES; ++i) {
+        histograms[i].add(stepTimes[i]);
+        stepTimes[i] = 0;
+      }
+    }
+
+    void StepProfiler::requestReset() {
+      resetRequested.store(true);
+    }
+
+    const char* StepProfiler::getPhaseName(StepPhase phase) {
+      return phaseNames[phase];
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file StepProfiler.h
+ * \brief Histograms of the durations of the phases of a simulation step.
+ */
+
+#ifndef MARS_SIM_STEP_PROFILER_H
+#define MARS_SIM_STEP_PROFILER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "StepProfiler.h"
+#endif
+
+#include <atomic>
+#include <stdint.h>
+
+namespace mars {
+  namespace sim {
+
+    enum StepPhase {
+      STEP_PHASE_COLLIDE,
+      STEP_PHASE_SOLVE,
+      STEP_PHASE_NODES,
+      STEP_PHASE_JOINTS,
+      STEP_PHASE_MOTORS,
+      STEP_PHASE_CONTROLLERS,
+      STEP_PHASE_SENSORS,     ///< pre and post physics triggers
+      STEP_PHASE_DATA_BROKER, ///< simulation time, timer and debug pushes
+      STEP_PHASE_PLUGINS,
+      STEP_PHASE_TOTAL,       ///< the whole step
+      NUM_STEP_PHASES
+    };
+
+    /**
+     * \brief Histogram of durations in nanoseconds with a fixed relative
+     *        precision.
+     *
+     * Every power of two range is split into 2^SUB_BUCKET_BITS linear
+     * buckets, as in an HDR histogram, so a percentile is off by at most
+     * about 3%. Durations above 2^41 ns (about 36 minutes) are clamped.
+     */
+    class StepHistogram {
+    public:
+      enum { SUB_BUCKET_BITS = 5,
+             SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+             MAX_BITS = 41,
+             NUM_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS };
+
+      StepHistogram();
+      void reset();
+      void add(int64_t ns);
+      /** \brief returns the duration below which \a fraction of the samples
+       *         lie in ms */
+      double getPercentile(double fraction) const;
+      inline double getMax() const { return maxValue * 1e-6; }
+      inline uint64_t getCount() const { return count; }
+
+    private:
+      uint32_t buckets[NUM_BUCKETS];
+      uint64_t count;
+      int64_t maxValue;
+    };
+
+    /**
+     * \brief Collects the phase durations of every step in a StepHistogram
+     *        per phase.
+     *
+     * Durations of a phase that occurs several times in a step are summed.
+     * All methods except requestReset() are called by the physics thread.
+     */
+    class StepProfiler {
+    public:
+      StepProfiler();
+
+      static int64_t now();
+
+      /** \brief adds the time since \a since to \a phase
+       *  \return the current time */
+      inline int64_t lap(StepPhase phase, int64_t since) {
+        int64_t t = now();
+        stepTimes[phase] += t - since;
+        return t;
+      }
+      /** \brief adds \a ns to \a phase */
+      inline void add(StepPhase phase, int64_t ns) {
+        stepTimes[phase] += ns;
+      }
+
+      /** \brief moves the durations of the current step into the
+       *         histograms */
+      void finishStep();
+
+      /** \brief clears the histograms before the next step */
+      void requestReset();
+
+      inline const StepHistogram& getHistogram(StepPhase phase) const {
+        return histograms[phase];
+      }
+
+      static const char* getPhaseName(StepPhase phase);
+
+    private:
+      int64_t stepTimes[NUM_STEP_PHASES];
+      StepHistogram histograms[NUM_STEP_PHASES];
+      std::atomic<bool> resetRequested;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif // MARS_SIM_STEP_PROFILER_H
@@ -34,6 +34,7 @@
 #include "NodePhysics.h"
 
 #include <cstdio>
+#include <cstring>
 
 namespace mars {
   namespace sim {
@@ -55,6 +56,9 @@ namespace mars {
       spring = 0;
       body1 = 0;
       body2 = 0;
+      feedbackEnabled = true;
+      memset(&feedback, 0, sizeof(feedback));
+      motor_torque = 0;
     }
 
     /**
@@ -165,7 +169,7 @@ namespace mars {
         // we have created a joint. To get the information
         // of the forces the joint attached to the bodies
         // we need to set a feedback pointer for the joint (ode stuff)
-        dJointSetFeedback(jointId, &feedback);
+        if(feedbackEnabled) dJointSetFeedback(jointId, &feedback);
         return 1;
       }
       return 0;
@@ -864,7 +868,7 @@ namespace mars {
         jointId = dJointCreateFixed(theWorld->getWorld(), 0);
         dJointAttach(jointId, body1, body2);
         dJointSetFixed(jointId);
-        dJointSetFeedback(jointId, &feedback);
+        if(feedbackEnabled) dJointSetFeedback(jointId, &feedback);
         // used for the integration study of the SpaceClimber
         //dJointSetFixedParam(jointId, dParamCFM, cfm1);//0.0002);
         break;
@@ -918,6 +922,9 @@ namespace mars {
       dReal v1[3], normal[3], load[3], tmp1[3], axis_force[3];
       MutexLocker locker(&(theWorld->iMutex));
 
+      // everything below is derived from the feedback
+      if(!feedbackEnabled) return;
+
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         dJointGetHingeAnchor(jointId, anchor);
@@ -1295,6 +1302,23 @@ namespace mars {
       }
     }
 
+    /**
+     * \brief Attaches or detaches the feedback of the joint. Without the
+     * feedback ode does not calculate the forces the joint applies to the
+     * bodies and the getters return zero.
+     */
+    void JointPhysics::setFeedbackEnabled(bool enabled) {
+      MutexLocker locker(&(theWorld->iMutex));
+      if(enabled == feedbackEnabled) return;
+      feedbackEnabled = enabled;
+      memset(&feedback, 0, sizeof(feedback));
+      axis1_torque.setZero();
+      axis2_torque.setZero();
+      joint_load.setZero();
+      motor_torque = 0;
+      if(jointId) dJointSetFeedback(jointId, enabled ? &feedback : 0);
+    }
+
     sReal JointPhysics::getMotorTorque(void) const {
       return motor_torque;
     }
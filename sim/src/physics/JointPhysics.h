@@ -86,11 +86,13 @@ namespace mars {
       virtual void setHighStop(interfaces::sReal highStop);
       virtual void setLowStop2(interfaces::sReal lowStop2);
       virtual void setHighStop2(interfaces::sReal highStop2);
+      virtual void setFeedbackEnabled(bool enabled);
 
     private:
       WorldPhysics* theWorld;
       dJointID jointId, ball_motor;
       dJointFeedback feedback;
+      bool feedbackEnabled;
       dBodyID body1, body2;
       int joint_type;
       dReal cfm, cfm1, cfm2, erp1, erp2;
@@ -41,6 +41,8 @@
 
 
 #include <mars/utils/MutexLocker.h>
+#include <mars/utils/Trace.h>
+#include <mars/utils/misc.h>
 #include <mars/interfaces/graphics/draw_structs.h>
 #include <mars/interfaces/graphics/GraphicsManagerInterface.h>
 #include <mars/interfaces/sim/SimulatorInterface.h>
@@ -101,6 +103,8 @@ namespace mars {
       create_contacts = 1;
       log_contacts = 0;
 
+      collide_time = solve_time = 0;
+
       // the step size in seconds
       step_size = 0.01;
       // dInitODE is relevant for using trimesh objects as correct as
@@ -229,6 +233,7 @@ namespace mars {
       geom_data* data;
       int i;
 
+      collide_time = solve_time = 0;
       // if world_init = false or step_size <= 0 debug something
       if(world_init && step_size > 0) {
         if(old_gravity != world_gravity) {
@@ -266,19 +271,27 @@ namespace mars {
         /// first check for collisions
         num_contacts = log_contacts = 0;
         create_contacts = 1;
-        dSpaceCollide(space,this, &WorldPhysics::callbackForward);
+        long long start = getTimeNs(), end;
+        {
+          MARS_TRACE_SCOPE("collide");
+          dSpaceCollide(space,this, &WorldPhysics::callbackForward);
+        }
         
         drawLock.lock();
         draw_extern.swap(draw_intern);
         drawLock.unlock();
+        end = getTimeNs();
+        collide_time = (end - start)*1e-6;
 
         /// then calculate the next state for a time of step_size seconds
         try {
+          MARS_TRACE_SCOPE("solve");
           if(fast_step) dWorldQuickStep(world, step_size);
           else dWorldStep(world, step_size);
         } catch (...) {
           control->sim->handleError(PHYSICS_UNKNOWN);
         }
+        solve_time = getTimeDiffNs(end)*1e-6;
 	if(WorldPhysics::error) {
           control->sim->handleError(WorldPhysics::error);
           WorldPhysics::error = PHYSICS_NO_ERROR;
@@ -35,6 +35,7 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 
 namespace mars {
   namespace sim {
@@ -121,5 +122,18 @@ namespace mars {
       return i;
     }
 
+    bool JointArraySensor::saveCheckpoint(std::vector<char> *data) const {
+      const char *values = (const char*)doubleArray.data();
+      data->insert(data->end(), values,
+                   values + doubleArray.size()*sizeof(double));
+      return true;
+    }
+
+    void JointArraySensor::loadCheckpoint(const char *data, size_t size) {
+      // the sensor was created with another configuration
+      if(size != doubleArray.size()*sizeof(double)) return;
+      memcpy(doubleArray.data(), data, size);
+    }
+
   } // end of namespace sim
 } // end of namespace mars
@@ -35,6 +35,7 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 
 namespace mars {
   namespace sim {
@@ -134,5 +135,18 @@ namespace mars {
       return i;
     }
 
+    bool NodeArraySensor::saveCheckpoint(std::vector<char> *data) const {
+      const char *values = (const char*)doubleArray.data();
+      data->insert(data->end(), values,
+                   values + doubleArray.size()*sizeof(double));
+      return true;
+    }
+
+    void NodeArraySensor::loadCheckpoint(const char *data, size_t size) {
+      // the sensor was created with another configuration
+      if(size != doubleArray.size()*sizeof(double)) return;
+      memcpy(doubleArray.data(), data, size);
+    }
+
   } // end of namespace sim
 } // end of namespace mars
@@ -61,6 +61,8 @@ namespace mars {
       static interfaces::BaseConfig* parseConfig(interfaces::ControlCenter *control,
                                      configmaps::ConfigMap *config);
       virtual configmaps::ConfigMap createConfig() const;
+      virtual bool saveCheckpoint(std::vector<char> *data) const;
+      virtual void loadCheckpoint(const char *data, size_t size);
 
     protected:
       std::string typeName;